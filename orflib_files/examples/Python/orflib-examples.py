@@ -4,6 +4,7 @@
 import orflib as orf
 import numpy as np
 import os
+import time
 
 ver = orf.version()
 print(f'orflib version: {ver}')
@@ -154,6 +155,18 @@ euromc1 = orf.euroBSMC(payofftype = 1, strike = 100, timetoexp = 1.0, spot = 100
 print(f'URNGTYPE={mcpars1["URNGTYPE"]} PATHGENTYPE={mcpars1["PATHGENTYPE"]} NPATHS={npaths0}')
 print(f'Price={euromc1['Mean']:0.4f}  StdErr={euromc1['StdErr']:0.4f}')
 
+#eurobsmc with stratified and Latin hypercube sampling
+npaths4 = 100000
+for samptype in ['PLAIN', 'STRATIFIED', 'LATINHYPERCUBE']:
+    mcpars3 = {'URNGTYPE': 'MT19937', 'PATHGENTYPE': 'EULER', 'SAMPLINGTYPE': samptype, 'NSTRATA': 1000}
+    tstart = time.perf_counter()
+    euromc3 = orf.euroBSMC(payofftype = 1, strike = 100, timetoexp = 1.0, spot = 100,
+                           discountcrv =  yc, divyield = 0.02, volatility = 0.4,
+                           mcparams = mcpars3, npaths = npaths4)
+    tsecs = time.perf_counter() - tstart
+    print(f'SAMPLINGTYPE={samptype:14} NSTRATA={mcpars3["NSTRATA"]} NPATHS={npaths4}')
+    print(f'Price={euromc3['Mean']:0.4f}  StdErr={euromc3['StdErr']:0.4f}  Secs={tsecs:0.2f}')
+
 print('=================')
 print('Asian basket option using Black-Scholes Monte Carlo')
 
@@ -180,6 +193,69 @@ asianmc = orf.asianBasketBSMC(payofftype = 1, strike = 100, fixtimes = fixtimes,
 print(f'URNGTYPE={mcpars1["URNGTYPE"]} PATHGENTYPE={mcpars1["PATHGENTYPE"]} NPATHS={npaths1}')
 print(f'Price={asianmc['Mean']:0.4f}  StdErr={asianmc['StdErr']:0.4f}')
 
+mcpars4 = {'URNGTYPE': 'MT19937', 'PATHGENTYPE': 'EULER', 'SAMPLINGTYPE': 'LATINHYPERCUBE', 'NSTRATA': 1000}
+asianmc1 = orf.asianBasketBSMC(payofftype = 1, strike = 100, fixtimes = fixtimes, 
+                              assetquantities = assqts, spots = spots,
+                              discountcrv =  yc, divyields = divylds, 
+                              volatilities= vols, correlmat = correls,
+                              mcparams = mcpars4, npaths = npaths1)
+print(f'URNGTYPE={mcpars4["URNGTYPE"]} SAMPLINGTYPE={mcpars4["SAMPLINGTYPE"]} NSTRATA={mcpars4["NSTRATA"]} NPATHS={npaths1}')
+print(f'Price={asianmc1['Mean']:0.4f}  StdErr={asianmc1['StdErr']:0.4f}')
+
+# streaming quantiles of the path PVs
+asianqs = [0.5, 0.9, 0.95, 0.99]
+asianmc2 = orf.asianBasketBSMC(payofftype = 1, strike = 100, fixtimes = fixtimes, 
+                              assetquantities = assqts, spots = spots,
+                              discountcrv =  yc, divyields = divylds, 
+                              volatilities= vols, correlmat = correls,
+                              mcparams = mcpars1, npaths = npaths1, quantiles = asianqs)
+print(f'Price={asianmc2['Mean']:0.4f}  StdErr={asianmc2['StdErr']:0.4f}')
+for q, pv in zip(asianqs, asianmc2['Quantiles']):
+    print(f'Quantile({q:0.2f})={pv:0.4f}')
+
+print('=================')
+print('Down-and-out call using Black-Scholes Monte Carlo, discrete vs. Brownian bridge monitoring')
+
+barspot, barstrike, barlevel, bartexp, barvol, bardiv = 100.0, 100.0, 90.0, 1.0, 0.25, 0.02
+# the closed form below assumes a constant rate, so the simulation runs off a flat curve
+barrate = 0.05
+ycflat = orf.ycCreate(ycname = 'FLAT', tmats = [1, 10], vals = [barrate, barrate], valtype = 0)
+# continuous monitoring closed form, by reflection of the vanilla call (barrier below strike)
+barexp = 2 * (barrate - bardiv) / barvol**2 - 1
+barref = (orf.euroBS(1, barspot, barstrike, bartexp, barrate, bardiv, barvol)[0]
+          - (barlevel / barspot)**barexp
+          * orf.euroBS(1, barlevel**2 / barspot, barstrike, bartexp, barrate, bardiv, barvol)[0])
+print(f'Continuous barrier closed form Price={barref:0.4f}')
+npaths2 = 100000
+for nfix in [4, 16, 64, 256]:
+    for bridge in [False, True]:
+        tstart = time.perf_counter()
+        barmc = orf.barrierBSMC(payofftype = 1, strike = barstrike, timetoexp = bartexp, 
+                                barriertype = 'DOWNOUT', barrier = barlevel, nfixings = nfix,
+                                bridgecorrection = bridge, spot = barspot, discountcrv = ycflat,
+                                divyield = bardiv, volatility = barvol, mcparams = mcpars0, npaths = npaths2)
+        tsecs = time.perf_counter() - tstart
+        print(f'NFIXINGS={nfix:4d} BRIDGE={bridge!s:5} Price={barmc['Mean']:0.4f}  StdErr={barmc['StdErr']:0.4f}  Secs={tsecs:0.2f}')
+
+print('=================')
+print('Deep out-of-the-money digital call using Black-Scholes Monte Carlo, with and without importance sampling')
+
+digistrike, digiexp, digivol, digidiv = 200.0, 1.0, 0.2, 0.02
+digiref = orf.digiBS(payofftype = 1, spot = 100, timetoexp = digiexp, strike = digistrike,
+                     intrate = orf.spotRate(yc, digiexp), divyield = digidiv, volatility = digivol)[0]
+print(f'Analytic Price={digiref:0.6f}')
+npaths3 = 100000
+for impsamp in [False, True]:
+    mcpars2 = {'URNGTYPE': 'MT19937', 'PATHGENTYPE': 'EULER', 'IMPSAMPLING': impsamp, 'NPILOTPATHS': 1000}
+    tstart = time.perf_counter()
+    digimc = orf.digiBSMC(payofftype = 1, strike = digistrike, timetoexp = digiexp, spot = 100,
+                          discountcrv = yc, divyield = digidiv, volatility = digivol,
+                          mcparams = mcpars2, npaths = npaths3)
+    tsecs = time.perf_counter() - tstart
+    print(f'IMPSAMPLING={impsamp!s:5} Price={digimc['Mean']:0.6f}  StdErr={digimc['StdErr']:0.6f}  Secs={tsecs:0.2f}')
+    if impsamp:
+        print(f'MeanShift={digimc['MeanShift']:0.2f}  VarRedFactor={digimc['VarRedFactor']:0.1f}')
+
 #%%
 # function group 4
 print('=================')
@@ -215,24 +291,205 @@ eurobs = orf.euroBS(payofftype = 1, strike = 100, timetoexp = 1.0, spot = 100,
 
 print(f'BSPrice={eurobs:0.4f}')
 
+# nodes concentrated around the strike, against equally spaced nodes:
+# the max error of European puts over strikes 90..120, and the nodes needed for an error below 1e-3
+print('Max errors over strikes 90..120 of uniform and concentrated grids for European puts')
+concks = np.linspace(90, 120, 7)
+concref = [orf.euroBS(payofftype = -1, strike = k, timetoexp = 1.0, spot = 100, intrate = orf.spotRate(yc, 1.0),
+                      divyield = 0.02, volatility = 0.3)[0] for k in concks]
+conctarget = 1e-3
+concneeded = {'Uniform': None, 'Concentrated': None}
+for nspots in [100, 150, 200, 300, 400, 600, 800]:
+    maxerrs = {}
+    for grid in ['Uniform', 'Concentrated']:
+        errs = []
+        for k, ref in zip(concks, concref):
+            pdepars4 = {'NTIMESTEPS': 1000, 'NSPOTNODES': nspots, 'NSTDDEVS': 4, 'THETA': 0.5}
+            if grid == 'Concentrated':
+                pdepars4['CONCENTRATIONSPOTS'] = [k]
+            pde = orf.euroBSPDE(payofftype = -1, strike = k, timetoexp = 1.0, spot = 100, discountcrv = yc,
+                                divyield = 0.02, volatility = 0.3, pdeparams = pdepars4)['Price']
+            errs.append(abs(pde - ref))
+        maxerrs[grid] = max(errs)
+        if concneeded[grid] is None and maxerrs[grid] < conctarget:
+            concneeded[grid] = nspots
+    print(f'NSPOTNODES={nspots} UniformMaxErr={maxerrs["Uniform"]:0.2e} ConcentratedMaxErr={maxerrs["Concentrated"]:0.2e}')
+print(f'NSPOTNODES for MaxErr<{conctarget:0.0e}: Uniform={concneeded["Uniform"]} Concentrated={concneeded["Concentrated"]}')
+
+# the exact price of the put with strike 110 used below
+eurobs3 = orf.euroBS(payofftype = -1, strike = 110, timetoexp = 1.0, spot = 100,
+                     intrate = orf.spotRate(yc, 1.0), divyield = 0.02, volatility = 0.4)[0]
+
+# Rannacher smoothing of a coarse time grid, and Richardson extrapolation over refined grids
+pdepars5 = {'NTIMESTEPS': 10, 'NSPOTNODES': 400, 'NSTDDEVS': 4, 'THETA': 0.5}
+cn = orf.euroBSPDE(payofftype = -1, strike = 110, timetoexp = 1.0, spot = 100, discountcrv = yc,
+                   divyield = 0.02, volatility = 0.4, pdeparams = pdepars5)['Price']
+pdepars5['RANNACHERSTEPS'] = 1
+rann = orf.euroBSPDE(payofftype = -1, strike = 110, timetoexp = 1.0, spot = 100, discountcrv = yc,
+                     divyield = 0.02, volatility = 0.4, pdeparams = pdepars5)['Price']
+print(f'NTIMESTEPS=10 CrankNicolsonErr={abs(cn - eurobs3):0.2e} RannacherErr={abs(rann - eurobs3):0.2e}')
+
+pdepars6 = {'NTIMESTEPS': 50, 'NSPOTNODES': 49, 'NSTDDEVS': 4, 'THETA': 0.5,
+            'CONCENTRATIONSPOTS': [110], 'RANNACHERSTEPS': 2}
+richd = orf.bsPDERichardson(payofftype = -1, strike = 110, timetoexp = 1.0, american = False, spot = 100,
+                            discountcrv = yc, divyield = 0.02, volatility = 0.4, pdeparams = pdepars6, nlevels = 3)
+print(f'LevelErrs={np.abs(richd["LevelPrices"] - eurobs3)}')
+print(f'RichardsonErr={abs(richd["Price"] - eurobs3):0.2e} ErrorEstimate={richd["ErrorEstimate"]:0.2e}')
+
+# a strike x maturity surface of calls from one forward PDE solve
+fwdstrikes = [80, 90, 100, 110, 120]
+fwdmats = [0.25, 0.5, 1.0]
+pdepars7 = {'NTIMESTEPS': 200, 'NSPOTNODES': 200, 'NSTDDEVS': 5, 'THETA': 0.5, 'CONCENTRATIONSPOTS': [100]}
+surf = orf.bsPDEForward(spot = 100, discountcrv = yc, divyield = 0.02, volatility = 0.4,
+                        strikes = fwdstrikes, maturities = fwdmats, pdeparams = pdepars7)
+surferr = max(abs(surf['CallPrices'][k, j]
+                  - orf.euroBS(1, 100, fwdstrikes[k], fwdmats[j], orf.spotRate(yc, fwdmats[j]), 0.02, 0.4)[0])
+              for k in range(len(fwdstrikes)) for j in range(len(fwdmats)))
+print(f'Forward PDE surface MaxErr={surferr:0.2e}')
+
 print('=================')
 print('American option using Black-Scholes PDE')
 pdeparams = {'NTIMESTEPS': 800, 'NSPOTNODES': 800, 'NSTDDEVS': 4, 'THETA': 0.5}
 paytype = 1
 opttype = 'call' if paytype == 1 else 'put'
 
+tstart = time.perf_counter()
 amerpde = orf.amerBSPDE(payofftype = paytype, strike = 100, timetoexp = 1.0, spot = 100,
                         discountcrv =  yc, divyield = 0.02, volatility = 0.4, pdeparams = pdeparams)
+tsecs = time.perf_counter() - tstart
 
 print(f'NTIMESTEPS={pdeparams["NTIMESTEPS"]} NSPOTNODES={pdeparams["NSPOTNODES"]} NSTDDEVS={pdeparams["NSTDDEVS"]} THETA={pdeparams["THETA"]}\n')
 print(f'American {opttype} option:')
-print(f'Price={amerpde["Price"]:0.4f}')
+print(f'Price={amerpde["Price"]:0.4f}  Secs={tsecs:0.2f}')
 
 # compare with corresponding European
 europde = orf.euroBSPDE(payofftype = paytype, strike = 100, timetoexp = 1.0, spot = 100,
                         discountcrv =  yc, divyield = 0.02, volatility = 0.4, pdeparams = pdeparams)
 print(f'European {opttype} option:')
 print(f'Price={europde["Price"]:0.4f}')
+# the Greeks come from the same solve
+for opt, res in [('American', amerpde), ('European', europde)]:
+    print(f'{opt} Delta={res["Delta"]:0.4f} Gamma={res["Gamma"]:0.5f} Theta={res["Theta"]:0.4f}')
+# vega and rho from the tangent layers of the same solve
+amertan = orf.amerBSPDE(payofftype = paytype, strike = 100, timetoexp = 1.0, spot = 100,
+                        discountcrv =  yc, divyield = 0.02, volatility = 0.4, pdeparams = pdeparams, tangents = True)
+print(f'American Vega={amertan["Vega"]:0.4f} Rho={amertan["Rho"]:0.4f}')
+
+# prices and deltas at a spot ladder from one solve
+ladderspots = [80, 90, 100, 110, 120]
+ladder = orf.bsPDESpots(payofftype = paytype, strike = 100, timetoexp = 1.0, american = True, spot = 100,
+                        spots = ladderspots, discountcrv = yc, divyield = 0.02, volatility = 0.4,
+                        pdeparams = pdeparams, greeks = True)
+for s, p, d in zip(ladderspots, ladder['Prices'], ladder['Deltas']):
+    print(f'Spot={s} Price={p:0.4f} Delta={d:0.4f}')
+
+# a skewed local volatility surface, the vols of the second row holding from 0.5 to 1 year
+lvname = orf.lvCreate('SKEW', [0.5, 1.0], [50, 80, 100, 120, 200],
+                      [[0.55, 0.45, 0.40, 0.37, 0.35], [0.50, 0.42, 0.38, 0.36, 0.35]])
+amerlv = orf.lvPDE(payofftype = paytype, strike = 100, timetoexp = 1.0, american = True, spot = 100,
+                   discountcrv = yc, divyield = 0.02, localvol = lvname, pdeparams = pdeparams)
+print(f'Local vol at 100 in 0.75y={orf.localVol(lvname, 0.75, 100):0.4f} American Price={amerlv["Price"]:0.4f}')
+
+# keep the values of every 20th step, for spots between 50 and 200
+amergrid = orf.amerBSPDE(payofftype = paytype, strike = 100, timetoexp = 1.0, spot = 100,
+                         discountcrv =  yc, divyield = 0.02, volatility = 0.4, pdeparams = pdeparams,
+                         allresults = True, storeevery = 20, spotwindow = [50, 200])
+print(f'Stored values: {amergrid["Values"].shape[0]} times x {amergrid["Values"].shape[1]} spots')
+
+# early exercise imposed after each step vs. inside the implicit solve, on a daily time grid
+for method in ['EXPLICIT', 'BRENNANSCHWARTZ', 'PENALTY']:
+    pdepars8 = {'NTIMESTEPS': 365, 'NSPOTNODES': 400, 'NSTDDEVS': 4, 'THETA': 0.5, 'RANNACHERSTEPS': 2,
+                'CONCENTRATIONSPOTS': [100], 'EXERCISEMETHOD': method}
+    tstart = time.perf_counter()
+    amerput = orf.amerBSPDE(payofftype = -1, strike = 100, timetoexp = 1.0, spot = 100,
+                            discountcrv =  yc, divyield = 0.02, volatility = 0.4, pdeparams = pdepars8)['Price']
+    tsecs = time.perf_counter() - tstart
+    print(f'EXERCISEMETHOD={method} American put Price={amerput:0.4f} Secs={tsecs:0.3f}')
+
+# about 50 adaptive steps instead of one per exercise day
+pdepars8['EXERCISEMETHOD'] = 'BRENNANSCHWARTZ'
+pdepars8['NTIMESTEPS'] = 50
+pdepars8['ADAPTIVETIMESTEPS'] = True
+tstart = time.perf_counter()
+amerput = orf.amerBSPDE(payofftype = -1, strike = 100, timetoexp = 1.0, spot = 100,
+                        discountcrv =  yc, divyield = 0.02, volatility = 0.4, pdeparams = pdepars8)['Price']
+tsecs = time.perf_counter() - tstart
+print(f'ADAPTIVETIMESTEPS NTIMESTEPS=50 American put Price={amerput:0.4f} Secs={tsecs:0.3f}')
+
+# narrower spot ranges, with the edge values extrapolated or set from the asymptotic values:
+# the max errors of American puts at spots 80..125, against a wide and fine grid with the same time steps
+print('Max errors at spots 80..125 of American puts for each boundary condition')
+bcargs = dict(payofftype = -1, strike = 100, timetoexp = 1.0, american = True, spot = 100,
+              spots = np.linspace(80, 125, 10), discountcrv = yc, divyield = 0.02, volatility = 0.3)
+pdepars9 = {'NTIMESTEPS': 200, 'NSPOTNODES': 4000, 'NSTDDEVS': 6, 'THETA': 0.5, 'RANNACHERSTEPS': 2}
+bcref = orf.bsPDESpots(**bcargs, pdeparams = pdepars9)['Prices']
+bcconds = ['LINEAR', 'DIRICHLET', 'NEUMANN']
+bcerrs = {}
+for nspots in [100, 200, 400]:
+    for nsd in [1.5, 2, 2.5, 3, 4, 5]:
+        for bc in bcconds:
+            pdepars9 = {'NTIMESTEPS': 200, 'NSPOTNODES': nspots, 'NSTDDEVS': nsd, 'THETA': 0.5, 'RANNACHERSTEPS': 2,
+                        'BOUNDARYCONDITION': bc}
+            bcprices = orf.bsPDESpots(**bcargs, pdeparams = pdepars9)['Prices']
+            bcerrs[bc, nspots, nsd] = np.max(np.abs(bcprices - bcref))
+        print(f'NSPOTNODES={nspots} NSTDDEVS={nsd} '
+              + ' '.join(f'{bc}={bcerrs[bc, nspots, nsd]:0.2e}' for bc in bcconds))
+# the fewest nodes for a fixed max error at NSTDDEVS=4, and at the best NSTDDEVS
+bctarget = 2e-3
+for bc in bcconds:
+    fits = [(nspots, nsd) for (c, nspots, nsd), err in bcerrs.items() if c == bc and err < bctarget]
+    nodes4 = min(nspots for nspots, nsd in fits if nsd == 4)
+    nodesmin, nsdmin = min(fits)
+    print(f'BOUNDARYCONDITION={bc} MaxErr<{bctarget:0.0e}: NSTDDEVS=4 needs NSPOTNODES={nodes4}, '
+          f'NSTDDEVS={nsdmin} needs NSPOTNODES={nodesmin}')
+
+print('=================')
+print('Strike ladder of American puts using Black-Scholes PDE, serial vs. batch')
+ladderks = np.linspace(70, 130, 25)
+pdepars3 = {'NTIMESTEPS': 400, 'NSPOTNODES': 400, 'NSTDDEVS': 4, 'THETA': 0.5}
+tstart = time.perf_counter()
+ladderser = [orf.amerBSPDE(payofftype = -1, strike = k, timetoexp = 1.0, spot = 100, discountcrv = yc,
+                           divyield = 0.02, volatility = 0.4, pdeparams = pdepars3)['Price'] for k in ladderks]
+tser = time.perf_counter() - tstart
+tstart = time.perf_counter()
+ladderbat = orf.bsPDEBatch(payofftypes = -1, strikes = ladderks, timestoexp = 1.0, americans = True, spots = 100,
+                           discountcrv = yc, divyields = 0.02, volatilities = 0.4, pdeparams = pdepars3)['Prices']
+tbat = time.perf_counter() - tstart
+print(f'NOPTIONS={len(ladderks)} SerialSecs={tser:0.2f} BatchSecs={tbat:0.2f} MaxAbsDiff={np.max(np.abs(ladderbat - ladderser)):0.2e}')
+
+tstart = time.perf_counter()
+ladderlay = orf.bsPDELadder(payofftypes = -1, strikes = ladderks, timetoexp = 1.0, american = True, spot = 100,
+                            discountcrv = yc, divyield = 0.02, volatility = 0.4, pdeparams = pdepars3)['Prices']
+tlay = time.perf_counter() - tstart
+print(f'NOPTIONS={len(ladderks)} LayersSecs={tlay:0.2f} MaxAbsDiff={np.max(np.abs(ladderlay - ladderser)):0.2e}')
+
+print('=================')
+print('Spread options using the 2D Black-Scholes PDE')
+sprspots = [100, 95]
+sprdivs = [0.02, 0.03]
+sprvols = [0.3, 0.2]
+sprcorr = 0.5
+# the exchange option (zero strike) against the Margrabe formula
+sprsig = np.sqrt(sprvols[0]**2 + sprvols[1]**2 - 2 * sprcorr * sprvols[0] * sprvols[1])
+sprf1 = sprspots[0] * np.exp(-sprdivs[0])
+sprf2 = sprspots[1] * np.exp(-sprdivs[1])
+sprd1 = (np.log(sprf1 / sprf2) + 0.5 * sprsig**2) / sprsig
+margrabe = sprf1 * orf.normalCdf(sprd1) - sprf2 * orf.normalCdf(sprd1 - sprsig)
+for scheme in ['DOUGLAS', 'CRAIGSNEYD']:
+    pdepars7 = {'NTIMESTEPS': 200, 'NSPOTNODES': 200, 'NSTDDEVS': 4, 'THETA': 0.5, 'ADISCHEME': scheme}
+    tstart = time.perf_counter()
+    exch = orf.spreadBSPDE(payofftype = 1, strike = 0, timetoexp = 1.0, american = False, spots = sprspots,
+                           discountcrv = yc, divyields = sprdivs, volatilities = sprvols, correlation = sprcorr,
+                           pdeparams = pdepars7)['Price']
+    tspr = time.perf_counter() - tstart
+    print(f'ADISCHEME={scheme} Price={exch:0.4f} Margrabe={margrabe:0.4f} Secs={tspr:0.2f}')
+
+pdepars7 = {'NTIMESTEPS': 100, 'NSPOTNODES': 100, 'NSTDDEVS': 4, 'THETA': 0.5, 'RANNACHERSTEPS': 2}
+for amer in [False, True]:
+    sprput = orf.spreadBSPDE(payofftype = -1, strike = 5, timetoexp = 1.0, american = amer, spots = sprspots,
+                             discountcrv = yc, divyields = sprdivs, volatilities = sprvols, correlation = sprcorr,
+                             pdeparams = pdepars7)['Price']
+    print(f'Spread put K=5 American={amer} Price={sprput:0.4f}')
 
 #%%
 # function group 5
@@ -267,3 +524,52 @@ with np.printoptions(precision=4, suppress=True):
 print(f'Market Return = {mktrsk['Mean']:0.4f}')
 print(f'Market Risk = {mktrsk['StdDev']:0.4f}')
 print(f'Market Lambda = {mktrsk['Lambda']:0.4f}')
+
+print('=================')
+print('10 year convertible bond with daily conversion, serial vs. parallel in time PDE')
+pdepars10 = {'NTIMESTEPS': 100, 'NSPOTNODES': 400, 'NSTDDEVS': 4, 'THETA': 0.5, 'RANNACHERSTEPS': 2,
+             'EXERCISEMETHOD': 'BRENNANSCHWARTZ'}
+cbargs = dict(facevalue = 100, maturity = 10, convratio = 1, convstart = 0, convend = 10,
+              callstrike = 130, callstart = 3, callend = 10, spot = 100, discountcrv = yc,
+              divyield = 0.02, volatility = 0.3, pdeparams = pdepars10)
+tstart = time.perf_counter()
+cbser = orf.cbBSPDE(**cbargs)['Price']
+tser = time.perf_counter() - tstart
+tstart = time.perf_counter()
+cbpar = orf.cbBSPDEParareal(**cbargs, ncoarsesteps = 200, nslices = 8)
+tpar = time.perf_counter() - tstart
+print(f'Serial Price={cbser:0.6f} Secs={tser:0.3f}')
+print(f'Parareal Price={cbpar["Price"]:0.6f} Slices={cbpar["Slices"]} Iterations={cbpar["Iterations"]} Secs={tpar:0.3f}')
+
+# the same bond with a credit spread on its cash part, the two layers solved together
+pdepars10['EXERCISEMETHOD'] = 'EXPLICIT'
+for spread in [0.0, 0.02, 0.05]:
+    cbcr = orf.cbBSPDE(**cbargs, creditspread = spread)
+    print(f'Credit spread={spread} Price={cbcr["Price"]:0.4f} CashPart={cbcr["CashPart"]:0.4f} Delta={cbcr["Delta"]:0.4f}')
+
+print('=================')
+print('Basket call on 3 assets, full grid vs. sparse grid combination')
+bskspots = [100, 100, 100]
+bskdivs = [0.02, 0.02, 0.02]
+bskvols = [0.30, 0.25, 0.20]
+bskcorr = np.array([
+    [1.0, 0.4, 0.4],
+    [0.4, 1.0, 0.4],
+    [0.4, 0.4, 1.0]])
+bskqtys = [1/3, 1/3, 1/3]
+pdepars11 = {'NTIMESTEPS': 40, 'NSPOTNODES': 63, 'NSTDDEVS': 4, 'THETA': 0.5, 'RANNACHERSTEPS': 2}
+bskargs = dict(payofftype = 1, strike = 100, timetoexp = 1.0, american = False, spots = bskspots,
+               discountcrv = yc, divyields = bskdivs, volatilities = bskvols, correlations = bskcorr,
+               quantities = bskqtys)
+tstart = time.perf_counter()
+bskfull = orf.basketBSPDE(**bskargs, pdeparams = pdepars11)['Price']
+tfull = time.perf_counter() - tstart
+print(f'Full grid Price={bskfull:0.4f} Nodes={65**3} Secs={tfull:0.3f}')
+# the sparse grids of level 2 from 15 nodes have up to 63 nodes per axis, as the full grid above
+pdepars11['NSPOTNODES'] = 15
+for level in [2, 3, 4]:
+    tstart = time.perf_counter()
+    bsksg = orf.basketBSPDE(**bskargs, pdeparams = pdepars11, sparselevel = level)
+    tsg = time.perf_counter() - tstart
+    print(f'Sparse level={level} Price={bsksg["Price"]:0.4f} Nodes={bsksg["Nodes"]} '
+          f'FullGridNodes={bsksg["FullGridNodes"]} Secs={tsg:0.3f}')
@@ -0,0 +1,80 @@
+/**
+@file  localvolsurface.cpp
+@brief Implementation of the local volatility surface class.
+*/
+
+#include <orflib/market/localvolsurface.hpp>
+#include <algorithm>
+#include <cmath>
+
+BEGIN_NAMESPACE(orf)
+
+LocalVolSurface::LocalVolSurface(Vector const& times, Vector const& spots, Matrix const& vols)
+  : times_(times), logSpots_(spots.size()), vols_(vols)
+{
+  ORF_ASSERT(times.size() > 0 && spots.size() > 0, "LocalVolSurface: need at least one time and one spot");
+  ORF_ASSERT(vols.n_rows == times.size(), "LocalVolSurface: need one row of vols per time");
+  ORF_ASSERT(vols.n_cols == spots.size(), "LocalVolSurface: need one column of vols per spot");
+  for (size_t i = 0; i < times.size(); ++i)
+    ORF_ASSERT(times[i] > 0.0 && (i == 0 || times[i] > times[i - 1]),
+      "LocalVolSurface: times must be positive and increasing");
+  for (size_t j = 0; j < spots.size(); ++j) {
+    ORF_ASSERT(spots[j] > 0.0 && (j == 0 || spots[j] > spots[j - 1]),
+      "LocalVolSurface: spots must be positive and increasing");
+    logSpots_[j] = std::log(spots[j]);
+  }
+  ORF_ASSERT(vols.min() >= 0.0, "LocalVolSurface: negative local volatility");
+}
+
+LocalVolSurface::LocalVolSurface(double flatVol)
+  : times_(1), logSpots_(1), vols_(1, 1)
+{
+  ORF_ASSERT(flatVol >= 0.0, "LocalVolSurface: negative local volatility");
+  times_[0] = 1.0;
+  logSpots_[0] = 0.0;
+  vols_(0, 0) = flatVol;
+}
+
+size_t LocalVolSurface::timeIndex(double t) const
+{
+  // the first time not before t, the last one beyond them
+  size_t i = std::lower_bound(times_.begin(), times_.end(), t) - times_.begin();
+  return std::min(i, size_t(times_.size() - 1));
+}
+
+double LocalVolSurface::localVol(double t, double S) const
+{
+  ORF_ASSERT(S > 0.0, "LocalVolSurface: spots must be positive");
+  size_t i = timeIndex(t);
+  size_t n = logSpots_.size();
+  double x = std::log(S);
+  if (x <= logSpots_[0])
+    return vols_(i, 0);
+  if (x >= logSpots_[n - 1])
+    return vols_(i, n - 1);
+  size_t j = std::upper_bound(logSpots_.begin(), logSpots_.end(), x) - logSpots_.begin();
+  double w = (x - logSpots_[j - 1]) / (logSpots_[j] - logSpots_[j - 1]);
+  return (1.0 - w) * vols_(i, j - 1) + w * vols_(i, j);
+}
+
+void LocalVolSurface::localVols(double t, Vector const& logSpots, Vector& vols) const
+{
+  size_t i = timeIndex(t);
+  size_t n = logSpots_.size();
+  size_t j = 0;   // the first spot node above the current spot, advanced as the spots increase
+  for (size_t k = 0; k < logSpots.size(); ++k) {
+    double x = logSpots[k];
+    while (j < n && logSpots_[j] <= x)
+      ++j;
+    if (j == 0)
+      vols[k] = vols_(i, 0);
+    else if (j == n)
+      vols[k] = vols_(i, n - 1);
+    else {
+      double w = (x - logSpots_[j - 1]) / (logSpots_[j] - logSpots_[j - 1]);
+      vols[k] = (1.0 - w) * vols_(i, j - 1) + w * vols_(i, j);
+    }
+  }
+}
+
+END_NAMESPACE(orf)
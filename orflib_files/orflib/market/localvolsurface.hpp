@@ -0,0 +1,53 @@
+/**
+@file  localvolsurface.hpp
+@brief Class representing a local volatility surface
+*/
+
+#ifndef ORF_LOCALVOLSURFACE_HPP
+#define ORF_LOCALVOLSURFACE_HPP
+
+#include <orflib/defines.hpp>
+#include <orflib/exception.hpp>
+#include <orflib/math/matrix.hpp>
+#include <memory>
+
+BEGIN_NAMESPACE(orf)
+
+/** The local volatility surface, the volatility of the asset returns as a function of time and spot.
+    It is given on a grid of times and spots. In time it is piecewise constant: the vols of the time
+    with index i hold from the time with index i-1 to the time with index i, as the forward vols of
+    VolatilityTermStructure, and the vols of the last time hold beyond it.
+    In spot it is interpolated linearly in the log of the spot, and extrapolated flat.
+*/
+class LocalVolSurface
+{
+public:
+  /** Ctor from the local vols with one row per time and one column per spot;
+      the times and the spots must be positive and increasing */
+  LocalVolSurface(Vector const& times, Vector const& spots, Matrix const& vols);
+
+  /** Ctor for a flat surface, i.e. constant volatility */
+  explicit LocalVolSurface(double flatVol);
+
+  /** Returns the local volatility at time t and spot S */
+  double localVol(double t, double S) const;
+
+  /** Sets vols to the local volatilities at time t at increasing spots, in one pass over the spots;
+      the spots are passed in by their logs, e.g. computed once for all the times of a PDE grid.
+      vols must have the size of logSpots */
+  void localVols(double t, Vector const& logSpots, Vector& vols) const;
+
+private:
+  /** Returns the index of the row of vols holding at time t */
+  size_t timeIndex(double t) const;
+
+  Vector times_;
+  Vector logSpots_;
+  Matrix vols_;
+};
+
+using SPtrLocalVolSurface = std::shared_ptr<LocalVolSurface>;
+
+END_NAMESPACE(orf)
+
+#endif // ORF_LOCALVOLSURFACE_HPP
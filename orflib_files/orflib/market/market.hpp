@@ -11,6 +11,7 @@
 #include <orflib/sptrmap.hpp>
 #include <orflib/market/yieldcurve.hpp>
 #include <orflib/market/volatilitytermstructure.hpp>
+#include <orflib/market/localvolsurface.hpp>
 
 BEGIN_NAMESPACE(orf)
 
@@ -30,6 +31,9 @@ public:
   /** Returns the volatility termstructure map */
   SPtrMap<VolatilityTermStructure>& volatilities() { return volmap_; }
 
+  /** Returns the local volatility surface map */
+  SPtrMap<LocalVolSurface>& localVolatilities() { return lvmap_; }
+
 private:
 
   /** allow private default ctor */
@@ -44,6 +48,7 @@ private:
   // state
   SPtrMap<YieldCurve> ycmap_;
   SPtrMap<VolatilityTermStructure> volmap_;
+  SPtrMap<LocalVolSurface> lvmap_;
 };
 
 /** Free function returning the market singleton */
@@ -9,6 +9,13 @@ BEGIN_NAMESPACE(orf)
 
 using namespace std;
 
+VolatilityTermStructure::VolatilityTermStructure(double flatVol)
+{
+  // one breakpoint is enough, the curve is extrapolated flat on either side
+  double tMat = 1.0;
+  fwdvars_ = PiecewisePolynomial(&tMat, &tMat + 1, &flatVol, 0);
+  initFromFwdVols();
+}
 
 void VolatilityTermStructure::initFromSpotVols()
 {
@@ -27,6 +27,9 @@ public:
                           YITER volEnd,
                           VolType vtype = VolType::SPOTVOL);
 
+  /** Ctor for a flat term structure, i.e. constant volatility for all maturities */
+  explicit VolatilityTermStructure(double flatVol);
+
   /** Returns the spot rate at time tMat */
   double spotVol(double tMat) const;
 
@@ -29,16 +29,13 @@ void findIndices(ARRAY const& v, double y, size_t& i1, size_t& i2)
     return;
   }
 
-  for (size_t i = 1; i < v.size(); ++i) {
-    if (y == v[i]) {
-      i1 = i2 = i;
-      return;
-    }
-    if (y < v[i]) {
-      i1 = i - 1;
-      i2 = i;
-      return;
-    }
+  // binary search for the first value not below y, between v[2] and v[size - 2]
+  size_t i = std::lower_bound(&v[0] + 2, &v[0] + v.size() - 2, y) - &v[0];
+  if (y == v[i])
+    i1 = i2 = i;
+  else {
+    i1 = i - 1;
+    i2 = i;
   }
 }
 
@@ -97,6 +94,171 @@ protected:
 
 };
 
+/** The cubic interpolator class.
+    The interpolant is the natural cubic spline through the values, or with monotone = true
+    the monotone (Fritsch-Carlson) cubic, which does not overshoot the values but is less accurate
+    for smooth functions. Also returns the first and second derivatives of the interpolant.
+    If the x values are equally spaced, the interval of a point is found in constant time,
+    else by binary search.
+    Outside the range of the x values the end polynomials are extrapolated.
+*/
+template <typename ARRAY>
+class CubicInterpolation1D
+{
+public:
+  /** Initializing ctor; needs at least two values */
+  CubicInterpolation1D(Vector const& xvals, ARRAY const& yvals, bool monotone = false);
+
+  int size() const
+  {
+    return yvals_.size();
+  }
+
+  Vector const& xValues() const
+  {
+    return xvals_;
+  }
+
+  ARRAY const& yValues() const
+  {
+    return yvals_;
+  }
+
+  /** Returns the interpolated value at x */
+  double getValue(double x) const
+  {
+    size_t i = interval(x);
+    double s = x - xvals_[i];
+    return yvals_[i] + s * (slopes_[i] + s * (c2_[i] + s * c3_[i]));
+  }
+
+  /** Returns the first derivative of the interpolant at x */
+  double getDerivative(double x) const
+  {
+    size_t i = interval(x);
+    double s = x - xvals_[i];
+    return slopes_[i] + s * (2.0 * c2_[i] + 3.0 * s * c3_[i]);
+  }
+
+  /** Returns the second derivative of the interpolant at x */
+  double getSecondDerivative(double x) const
+  {
+    size_t i = interval(x);
+    double s = x - xvals_[i];
+    return 2.0 * c2_[i] + 6.0 * s * c3_[i];
+  }
+
+  /** Returns the index i of the interval [x_i, x_i+1] holding x, clamped to the first and last intervals */
+  size_t interval(double x) const;
+
+protected:
+
+  Vector const& xvals_;
+  ARRAY  const& yvals_;
+  Vector slopes_;           // the slopes at the nodes
+  Vector c2_, c3_;          // the quadratic and cubic coefficients on each interval
+  bool uniform_;
+  double dx_;               // the node spacing if uniform
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+template <typename ARRAY>
+inline
+CubicInterpolation1D<ARRAY>::CubicInterpolation1D(Vector const& xvals, ARRAY const& yvals, bool monotone)
+  : xvals_(xvals), yvals_(yvals), uniform_(false), dx_(0.0)
+{
+  ORF_ASSERT(xvals.size() == yvals.size(), "CubicInterpolation1D: unequal vector sizes!");
+  size_t n = xvals.size();
+  ORF_ASSERT(n >= 2, "CubicInterpolation1D: need at least two values!");
+
+  // the interval lengths and the secant slopes
+  Vector h(n - 1), d(n - 1);
+  for (size_t i = 0; i < n - 1; ++i) {
+    h[i] = xvals[i + 1] - xvals[i];
+    ORF_ASSERT(h[i] > 0.0, "CubicInterpolation1D: the x values must be strictly increasing!");
+    d[i] = (yvals[i + 1] - yvals[i]) / h[i];
+  }
+
+  slopes_.resize(n);
+  if (n == 2)
+    slopes_[0] = slopes_[1] = d[0];
+  else if (monotone) {
+    // Fritsch-Carlson: harmonic mean of the secants, zero at the local extrema
+    slopes_[0] = d[0];
+    slopes_[n - 1] = d[n - 2];
+    for (size_t i = 1; i < n - 1; ++i) {
+      if (d[i - 1] * d[i] <= 0.0)
+        slopes_[i] = 0.0;
+      else {
+        double w1 = 2.0 * h[i] + h[i - 1], w2 = h[i] + 2.0 * h[i - 1];
+        slopes_[i] = (w1 + w2) / (w1 / d[i - 1] + w2 / d[i]);
+      }
+    }
+  }
+  else {
+    // the natural spline: continuity of the second derivative at the interior nodes,
+    // zero second derivative at the ends; a tridiagonal system for the slopes
+    Vector lower(n), diag(n), upper(n), rhs(n);
+    diag[0] = 2.0; upper[0] = 1.0; rhs[0] = 3.0 * d[0];
+    for (size_t i = 1; i < n - 1; ++i) {
+      lower[i] = h[i];
+      diag[i] = 2.0 * (h[i - 1] + h[i]);
+      upper[i] = h[i - 1];
+      rhs[i] = 3.0 * (h[i] * d[i - 1] + h[i - 1] * d[i]);
+    }
+    lower[n - 1] = 1.0; diag[n - 1] = 2.0; rhs[n - 1] = 3.0 * d[n - 2];
+    // forward elimination and back-substitution
+    for (size_t i = 1; i < n; ++i) {
+      double m = lower[i] / diag[i - 1];
+      diag[i] -= m * upper[i - 1];
+      rhs[i] -= m * rhs[i - 1];
+    }
+    slopes_[n - 1] = rhs[n - 1] / diag[n - 1];
+    for (size_t i = n - 1; i-- > 0; )
+      slopes_[i] = (rhs[i] - upper[i] * slopes_[i + 1]) / diag[i];
+  }
+
+  // the polynomial coefficients of the Hermite cubic on each interval
+  c2_.resize(n - 1);
+  c3_.resize(n - 1);
+  for (size_t i = 0; i < n - 1; ++i) {
+    c2_[i] = (3.0 * d[i] - 2.0 * slopes_[i] - slopes_[i + 1]) / h[i];
+    c3_[i] = (slopes_[i] + slopes_[i + 1] - 2.0 * d[i]) / (h[i] * h[i]);
+  }
+
+  // check for equally spaced values, for the constant time interval lookup
+  dx_ = (xvals[n - 1] - xvals[0]) / (n - 1);
+  uniform_ = true;
+  for (size_t i = 1; uniform_ && i < n - 1; ++i)
+    uniform_ = std::abs(xvals[i] - (xvals[0] + i * dx_)) <= 1.0e-12 * (xvals[n - 1] - xvals[0]);
+}
+
+template <typename ARRAY>
+inline
+size_t CubicInterpolation1D<ARRAY>::interval(double x) const
+{
+  size_t last = xvals_.size() - 2;   // the index of the last interval
+  if (x <= xvals_[1])
+    return 0;
+  if (x >= xvals_[last])
+    return last;
+  size_t i;
+  if (uniform_) {
+    i = static_cast<size_t>((x - xvals_[0]) / dx_);
+    // correct for the round-off in the division
+    if (i > last)
+      i = last;
+    else if (x < xvals_[i])
+      --i;
+    else if (i < last && x >= xvals_[i + 1])
+      ++i;
+  }
+  else
+    i = std::upper_bound(xvals_.begin(), xvals_.end(), x) - xvals_.begin() - 1;
+  return i;
+}
 
 END_NAMESPACE(orf)
 
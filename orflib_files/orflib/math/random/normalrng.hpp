@@ -10,6 +10,10 @@
 #include <orflib/defines.hpp>
 #include <orflib/exception.hpp>
 #include <random>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
 #include <orflib/math/random/sobolurng.hpp>
 #include <orflib/math/stats/normaldistribution.hpp>
 
@@ -36,13 +40,34 @@ public:
   /** Returns the underlying uniform rng. */
   URNG & urng();
 
+  /** Turns on stratified sampling over blocks of nStrata consecutive points,
+      a point being dim() deviates, possibly drawn in several batches by next().
+      Within a block, each of the nStrata equiprobable strata of a stratified coordinate
+      is sampled exactly once, in random order. Only the first deviate of each batch is
+      stratified, unless latinHypercube is true, in which case all coordinates are stratified,
+      each with an independent permutation (Latin hypercube sampling).
+      nStrata <= 1 turns stratification off. It always starts a new block.
+  */
+  void setStratification(size_t nStrata, bool latinHypercube = false);
+
 private:
 
+  // Returns a deviate from the current stratum of coordinate k of the point
+  double nextStratified(size_t k);
+
   // state
   size_t dim_;      // the dimension of the generator
   URNG urng_;       // the uniform random number generator
   std::normal_distribution<double> normcdf_;  // the normal distribution
 
+  size_t nStrata_;                             // number of strata, 0 or 1 if no stratification
+  bool latinHypercube_;                        // true if all coordinates are stratified
+  size_t pointPos_;                            // the coordinate of the next deviate in the current point
+  size_t blockPos_;                            // the index of the current point in the current block
+  size_t blockId_;                             // the index of the current block
+  std::vector<std::vector<size_t>> strata_;    // the stratum permutations, one per coordinate
+  std::vector<size_t> strataBlockId_;          // the block for which each permutation was drawn
+  std::uniform_real_distribution<double> unifcdf_;  // uniform deviates within a stratum
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -50,7 +75,7 @@ private:
 
 template<typename URNG>
 NormalRng<URNG>::NormalRng(size_t dimension, double mean, double stdev, URNG const & urng)
-  : dim_(dimension), urng_(urng)
+  : dim_(dimension), urng_(urng), nStrata_(0), latinHypercube_(false), pointPos_(0), blockPos_(0), blockId_(0)
 {
   ORF_ASSERT(stdev > 0.0, "the standard deviation must be positive!");
   normcdf_ = std::normal_distribution<double>(mean, stdev);
@@ -66,8 +91,26 @@ template<typename URNG>
 template <typename ITER>
 void NormalRng<URNG>::next(ITER begin, ITER end)
 {
-  for (ITER it = begin; it != end; ++it)
-    *it = normcdf_(urng_);
+  if (nStrata_ <= 1) {
+    for (ITER it = begin; it != end; ++it)
+      *it = normcdf_(urng_);
+    return;
+  }
+
+  for (ITER it = begin; it != end; ++it) {
+    if (latinHypercube_ || it == begin)
+      *it = nextStratified(pointPos_);
+    else
+      *it = normcdf_(urng_);
+    // move to the next coordinate, point and block
+    if (++pointPos_ == dim_) {
+      pointPos_ = 0;
+      if (++blockPos_ == nStrata_) {
+        blockPos_ = 0;
+        ++blockId_;
+      }
+    }
+  }
 }
 
 template<typename URNG>
@@ -76,10 +119,43 @@ URNG & NormalRng<URNG>::urng()
   return urng_;
 }
 
+template<typename URNG>
+void NormalRng<URNG>::setStratification(size_t nStrata, bool latinHypercube)
+{
+  nStrata_ = nStrata;
+  latinHypercube_ = latinHypercube;
+  pointPos_ = 0;
+  blockPos_ = 0;
+  blockId_ = 0;
+  strata_.assign(nStrata > 1 ? dim_ : 0, std::vector<size_t>());
+  strataBlockId_.assign(strata_.size(), size_t(-1));
+}
+
+template<typename URNG>
+double NormalRng<URNG>::nextStratified(size_t k)
+{
+  // draw the permutation of the strata for this coordinate at its first use in the block
+  std::vector<size_t>& perm = strata_[k];
+  if (strataBlockId_[k] != blockId_) {
+    perm.resize(nStrata_);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::shuffle(perm.begin(), perm.end(), urng_);
+    strataBlockId_[k] = blockId_;
+  }
+
+  double u;
+  do {
+    u = unifcdf_(urng_);
+  } while (u <= 0.0);
+  u = std::min((perm[blockPos_] + u) / nStrata_, std::nextafter(1.0, 0.0));
+  orf::NormalDistribution stdnorm;
+  return normcdf_.mean() + normcdf_.stddev() * stdnorm.invcdf(u);
+}
+
 template<>
 inline
 NormalRng<SobolURng>::NormalRng(size_t dimension, double mean, double stdev, SobolURng const& urng)
-: dim_(dimension), urng_(dimension)
+: dim_(dimension), urng_(dimension), nStrata_(0), latinHypercube_(false), pointPos_(0), blockPos_(0), blockId_(0)
 {
   ORF_ASSERT(stdev > 0.0, "the standard deviation must be positive!");
   normcdf_ = std::normal_distribution<double>(mean, stdev);
@@ -95,6 +171,14 @@ void NormalRng<SobolURng>::next(ITER begin, ITER end)
     *it = stdnorm.invcdf(*it);
 }
 
+// Sobol sequences are already stratified
+template<>
+inline
+void NormalRng<SobolURng>::setStratification(size_t nStrata, bool /*latinHypercube*/)
+{
+  ORF_ASSERT(nStrata <= 1, "NormalRng: stratified sampling is not available with Sobol sequences!");
+}
+
 END_NAMESPACE(orf)
 
 #endif // ORF_NORMALRNG_HPP
@@ -0,0 +1,117 @@
+/**
+@file  compositecalculator.hpp
+@brief Forwards the samples to several statistics calculators
+*/
+
+#ifndef ORF_COMPOSITECALCULATOR_HPP
+#define ORF_COMPOSITECALCULATOR_HPP
+
+#include <orflib/math/stats/statisticscalculator.hpp>
+#include <orflib/exception.hpp>
+#include <vector>
+
+BEGIN_NAMESPACE(orf)
+
+/** Statistics calculator that forwards each sample to several calculators,
+    so that a single simulation collects e.g. mean, variance and quantiles.
+    The results are the results of the component calculators, stacked by rows.
+    The component calculators are not owned and must outlive this one.
+*/
+template <typename ITER>
+class CompositeCalculator : public StatisticsCalculator < ITER >
+{
+  using StatisticsCalculator<ITER>::nVariables;
+  using StatisticsCalculator<ITER>::nsamples_;
+  using StatisticsCalculator<ITER>::results_;
+
+public:
+
+  explicit CompositeCalculator(std::vector<StatisticsCalculator<ITER>*> const& calculators);
+
+  virtual ~CompositeCalculator() {}
+
+  virtual void addSample(ITER begin, ITER end) override;
+
+  virtual void reset() override;
+
+  virtual void merge(StatisticsCalculator<ITER> const& other) override;
+
+  virtual Matrix const & results() override;
+
+protected:
+
+  /** Returns the total number of result rows of the calculators */
+  static size_t sumResults(std::vector<StatisticsCalculator<ITER>*> const& calculators);
+
+  // state
+  std::vector<StatisticsCalculator<ITER>*> calcs_;
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+template <typename ITER>
+CompositeCalculator<ITER>::CompositeCalculator(std::vector<StatisticsCalculator<ITER>*> const& calculators)
+  : StatisticsCalculator<ITER>(calculators.empty() ? 0 : calculators[0]->nVariables(), sumResults(calculators)),
+  calcs_(calculators)
+{
+  ORF_ASSERT(!calcs_.empty(), "CompositeCalculator: need at least one calculator!");
+  for (auto calc : calcs_)
+    ORF_ASSERT(calc->nVariables() == nVariables(), "CompositeCalculator: mismatch in the number of variables!");
+}
+
+template <typename ITER>
+size_t CompositeCalculator<ITER>::sumResults(std::vector<StatisticsCalculator<ITER>*> const& calculators)
+{
+  size_t nres = 0;
+  for (auto calc : calculators)
+    nres += calc->nResults();
+  return nres;
+}
+
+template <typename ITER>
+void CompositeCalculator<ITER>::addSample(ITER begin, ITER end)
+{
+  for (auto calc : calcs_)
+    calc->addSample(begin, end);
+
+  ++nsamples_;
+}
+
+template <typename ITER>
+Matrix const & CompositeCalculator<ITER>::results()
+{
+  size_t row = 0;
+  for (auto calc : calcs_) {
+    Matrix const& res = calc->results();
+    results_.rows(row, row + res.n_rows - 1) = res;
+    row += res.n_rows;
+  }
+
+  return results_;
+}
+
+template <typename ITER>
+void CompositeCalculator<ITER>::reset()
+{
+  StatisticsCalculator<ITER>::reset();
+  for (auto calc : calcs_)
+    calc->reset();
+}
+
+template <typename ITER>
+void CompositeCalculator<ITER>::merge(StatisticsCalculator<ITER> const& other)
+{
+  CompositeCalculator<ITER> const* that = dynamic_cast<CompositeCalculator<ITER> const*>(&other);
+  ORF_ASSERT(that != nullptr, "CompositeCalculator: can only merge with another CompositeCalculator!");
+  ORF_ASSERT(that->calcs_.size() == calcs_.size(), "CompositeCalculator: mismatch in the number of calculators!");
+
+  for (size_t i = 0; i < calcs_.size(); ++i)
+    calcs_[i]->merge(*that->calcs_[i]);
+  nsamples_ += that->nsamples_;
+}
+
+END_NAMESPACE(orf)
+
+#endif // ORF_COMPOSITECALCULATOR_HPP
@@ -0,0 +1,127 @@
+/**
+@file  histogramcalculator.hpp
+@brief Calculates the histogram of a set of samples on fixed bins
+*/
+
+#ifndef ORF_HISTOGRAMCALCULATOR_HPP
+#define ORF_HISTOGRAMCALCULATOR_HPP
+
+#include <orflib/math/stats/statisticscalculator.hpp>
+#include <orflib/exception.hpp>
+#include <algorithm>
+
+BEGIN_NAMESPACE(orf)
+
+/** Statistics calculator for the histogram on nbins equal bins in [lower, upper).
+    The results have nbins + 2 rows: the frequency below lower, the frequencies
+    of the bins, and the frequency at or above upper.
+*/
+template <typename ITER>
+class HistogramCalculator : public StatisticsCalculator < ITER >
+{
+  using StatisticsCalculator<ITER>::nVariables;
+  using StatisticsCalculator<ITER>::nsamples_;
+  using StatisticsCalculator<ITER>::results_;
+
+public:
+
+  HistogramCalculator(size_t nvars, double lower, double upper, size_t nbins);
+
+  virtual ~HistogramCalculator() {}
+
+  virtual void addSample(ITER begin, ITER end) override;
+
+  virtual void reset() override;
+
+  virtual void merge(StatisticsCalculator<ITER> const& other) override;
+
+  virtual Matrix const & results() override;
+
+  /** Returns the nbins + 1 bin edges */
+  Vector binEdges() const;
+
+protected:
+
+  // state
+  double lower_;
+  double upper_;
+  size_t nbins_;
+  double binWidth_;
+  Matrix counts_;   // nbins + 2 rows, one column per variable
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+template <typename ITER>
+HistogramCalculator<ITER>::HistogramCalculator(size_t nvars, double lower, double upper, size_t nbins)
+  : StatisticsCalculator<ITER>(nvars, nbins + 2), lower_(lower), upper_(upper), nbins_(nbins),
+  counts_(nbins + 2, nvars, arma::fill::zeros)
+{
+  ORF_ASSERT(upper > lower, "HistogramCalculator: the upper bound must be greater than the lower bound!");
+  ORF_ASSERT(nbins > 0, "HistogramCalculator: need at least one bin!");
+  binWidth_ = (upper - lower) / nbins;
+}
+
+template <typename ITER>
+void HistogramCalculator<ITER>::addSample(ITER begin, ITER end)
+{
+  ORF_ASSERT(end - begin == nVariables(), "missing variable values!");
+
+  ITER it = begin;
+  for (size_t j = 0; j < nVariables(); ++j, ++it) {
+    double x = *it;
+    size_t row;
+    if (x < lower_)
+      row = 0;
+    else if (x >= upper_)
+      row = nbins_ + 1;
+    else
+      row = std::min((size_t) ((x - lower_) / binWidth_), nbins_ - 1) + 1;
+    counts_(row, j) += 1.0;
+  }
+
+  ++nsamples_;
+}
+
+template <typename ITER>
+Matrix const & HistogramCalculator<ITER>::results()
+{
+  ORF_ASSERT(nsamples_ > 0, "HistogramCalculator: no samples!");
+  results_ = counts_ / (double) nsamples_;
+  return results_;
+}
+
+template <typename ITER>
+void HistogramCalculator<ITER>::reset()
+{
+  StatisticsCalculator<ITER>::reset();
+  counts_.zeros();
+}
+
+template <typename ITER>
+void HistogramCalculator<ITER>::merge(StatisticsCalculator<ITER> const& other)
+{
+  HistogramCalculator<ITER> const* that = dynamic_cast<HistogramCalculator<ITER> const*>(&other);
+  ORF_ASSERT(that != nullptr, "HistogramCalculator: can only merge with another HistogramCalculator!");
+  ORF_ASSERT(that->nVariables() == nVariables(), "HistogramCalculator: mismatch in the number of variables!");
+  ORF_ASSERT(that->lower_ == lower_ && that->upper_ == upper_ && that->nbins_ == nbins_,
+    "HistogramCalculator: can only merge histograms with the same bins!");
+
+  counts_ += that->counts_;
+  nsamples_ += that->nsamples_;
+}
+
+template <typename ITER>
+Vector HistogramCalculator<ITER>::binEdges() const
+{
+  Vector edges(nbins_ + 1);
+  for (size_t i = 0; i <= nbins_; ++i)
+    edges(i) = lower_ + i * binWidth_;
+  return edges;
+}
+
+END_NAMESPACE(orf)
+
+#endif // ORF_HISTOGRAMCALCULATOR_HPP
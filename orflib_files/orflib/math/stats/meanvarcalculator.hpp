@@ -29,6 +29,8 @@ public:
 
   virtual void reset() override;
 
+  virtual void merge(StatisticsCalculator<ITER> const& other) override;
+
   virtual Matrix const & results() override;
 
 protected:
@@ -89,6 +91,18 @@ void MeanVarCalculator<ITER>::reset()
   }
 }
 
+template <typename ITER>
+void MeanVarCalculator<ITER>::merge(StatisticsCalculator<ITER> const& other)
+{
+  MeanVarCalculator<ITER> const* that = dynamic_cast<MeanVarCalculator<ITER> const*>(&other);
+  ORF_ASSERT(that != nullptr, "MeanVarCalculator: can only merge with another MeanVarCalculator!");
+  ORF_ASSERT(that->nVariables() == nVariables(), "MeanVarCalculator: mismatch in the number of variables!");
+
+  runningSum_ += that->runningSum_;
+  runningSum2_ += that->runningSum2_;
+  nsamples_ += that->nsamples_;
+}
+
 END_NAMESPACE(orf)
 
 #endif // ORF_MEANVARCALCULATOR_HPP
@@ -0,0 +1,118 @@
+/**
+@file  quantilecalculator.hpp
+@brief Calculates streaming quantiles of a set of samples
+*/
+
+#ifndef ORF_QUANTILECALCULATOR_HPP
+#define ORF_QUANTILECALCULATOR_HPP
+
+#include <orflib/math/stats/statisticscalculator.hpp>
+#include <orflib/math/stats/tdigest.hpp>
+#include <orflib/exception.hpp>
+#include <vector>
+
+BEGIN_NAMESPACE(orf)
+
+/** Statistics calculator for quantiles, e.g. for VaR or PFE.
+    It keeps one t-digest per variable, so that memory does not grow with the number of samples.
+    The results have one row per probability level.
+*/
+template <typename ITER>
+class QuantileCalculator : public StatisticsCalculator < ITER >
+{
+  using StatisticsCalculator<ITER>::nVariables;
+  using StatisticsCalculator<ITER>::nsamples_;
+  using StatisticsCalculator<ITER>::results_;
+
+public:
+
+  /** Ctor from the number of variables and the probability levels of the quantiles */
+  QuantileCalculator(size_t nvars, Vector const& probabilities, double compression = 200.0);
+
+  virtual ~QuantileCalculator() {}
+
+  virtual void addSample(ITER begin, ITER end) override;
+
+  virtual void reset() override;
+
+  virtual void merge(StatisticsCalculator<ITER> const& other) override;
+
+  virtual Matrix const & results() override;
+
+  /** Returns the probability levels */
+  Vector const& probabilities() const;
+
+protected:
+
+  // state
+  Vector probs_;
+  std::vector<TDigest> digests_;
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+template <typename ITER>
+QuantileCalculator<ITER>::QuantileCalculator(size_t nvars, Vector const& probabilities, double compression)
+  : StatisticsCalculator<ITER>(nvars, probabilities.n_elem), probs_(probabilities),
+  digests_(nvars, TDigest(compression))
+{
+  ORF_ASSERT(probabilities.n_elem > 0, "QuantileCalculator: need at least one probability level!");
+  for (size_t i = 0; i < probs_.n_elem; ++i)
+    ORF_ASSERT(probs_(i) >= 0.0 && probs_(i) <= 1.0, "QuantileCalculator: the probabilities must be in [0, 1]!");
+}
+
+template <typename ITER>
+void QuantileCalculator<ITER>::addSample(ITER begin, ITER end)
+{
+  ORF_ASSERT(end - begin == nVariables(), "missing variable values!");
+
+  ITER it = begin;
+  for (size_t j = 0; j < nVariables(); ++j, ++it)
+    digests_[j].add(*it);
+
+  ++nsamples_;
+}
+
+template <typename ITER>
+Matrix const & QuantileCalculator<ITER>::results()
+{
+  ORF_ASSERT(nsamples_ > 0, "QuantileCalculator: no samples!");
+  for (size_t j = 0; j < nVariables(); ++j) {
+    for (size_t i = 0; i < probs_.n_elem; ++i)
+      results_(i, j) = digests_[j].quantile(probs_(i));
+  }
+
+  return results_;
+}
+
+template <typename ITER>
+void QuantileCalculator<ITER>::reset()
+{
+  StatisticsCalculator<ITER>::reset();
+  for (size_t j = 0; j < nVariables(); ++j)
+    digests_[j].reset();
+}
+
+template <typename ITER>
+void QuantileCalculator<ITER>::merge(StatisticsCalculator<ITER> const& other)
+{
+  QuantileCalculator<ITER> const* that = dynamic_cast<QuantileCalculator<ITER> const*>(&other);
+  ORF_ASSERT(that != nullptr, "QuantileCalculator: can only merge with another QuantileCalculator!");
+  ORF_ASSERT(that->nVariables() == nVariables(), "QuantileCalculator: mismatch in the number of variables!");
+
+  for (size_t j = 0; j < nVariables(); ++j)
+    digests_[j].merge(that->digests_[j]);
+  nsamples_ += that->nsamples_;
+}
+
+template <typename ITER>
+Vector const& QuantileCalculator<ITER>::probabilities() const
+{
+  return probs_;
+}
+
+END_NAMESPACE(orf)
+
+#endif // ORF_QUANTILECALCULATOR_HPP
@@ -28,12 +28,19 @@ public:
   /** Clears samples and results */
   virtual void reset();
 
+  /** Merges the samples of another calculator of the same type and size into this one,
+      e.g. to reduce the statistics of independent simulation shards */
+  virtual void merge(StatisticsCalculator<ITER> const& other) = 0;
+
   /** Returns the number of samples addes so far */
   size_t nSamples() const;
 
   /** Returns the number of variables */
   virtual size_t nVariables() const;
 
+  /** Returns the number of results per variable, i.e. the number of rows of the results */
+  size_t nResults() const;
+
   /** Returns the results, one column per variable */
   virtual Matrix const & results() = 0;
 
@@ -71,9 +78,16 @@ size_t StatisticsCalculator<ITER>::nVariables() const
   return results_.n_cols;
 }
 
+template <typename ITER>
+size_t StatisticsCalculator<ITER>::nResults() const
+{
+  return results_.n_rows;
+}
+
 template <typename ITER>
 void StatisticsCalculator<ITER>::reset()
 {
+  nsamples_ = 0;
   for (size_t i = 0; i < results_.n_rows; ++i) {
     for (size_t j = 0; j < results_.n_cols; ++j) {
       results_(i, j) = 0.0;
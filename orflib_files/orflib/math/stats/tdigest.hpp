@@ -0,0 +1,190 @@
+/**
+@file  tdigest.hpp
+@brief Streaming quantile estimator based on the merging t-digest of T. Dunning
+*/
+
+#ifndef ORF_TDIGEST_HPP
+#define ORF_TDIGEST_HPP
+
+#include <orflib/defines.hpp>
+#include <orflib/exception.hpp>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+BEGIN_NAMESPACE(orf)
+
+/** The t-digest summarizes a stream of samples by a small set of weighted centroids.
+    The centroids are small near the tails, so that extreme quantiles are accurate,
+    and their number is bounded by about the compression parameter.
+    Two digests can be merged, which gives the digest of the union of the samples.
+*/
+class TDigest
+{
+public:
+  /** Ctor with the compression parameter; higher values are more accurate but use more memory */
+  explicit TDigest(double compression = 200.0);
+
+  /** Adds one sample */
+  void add(double x);
+
+  /** Merges the samples of another digest into this one */
+  void merge(TDigest const& other);
+
+  /** Returns the estimated quantile at probability p in [0, 1] */
+  double quantile(double p);
+
+  /** Returns the number of samples */
+  size_t count() const;
+
+  /** Clears all samples */
+  void reset();
+
+private:
+  /** A centroid, i.e. the mean and weight of a cluster of samples */
+  struct Centroid
+  {
+    double mean;
+    double weight;
+    bool operator<(Centroid const& other) const { return mean < other.mean; }
+  };
+
+  /** Merges the buffered samples into the centroids */
+  void compress();
+
+  /** The scale function k2, mapping cumulative probability to the centroid index space;
+      it is unbounded at 0 and 1, so that the extreme samples stay in singleton centroids */
+  double scale(double q, double total) const;
+
+  double compression_;
+  std::vector<Centroid> centroids_;   // sorted by mean
+  std::vector<Centroid> buffer_;      // samples not yet merged
+  double totalWeight_;                // total weight of the centroids
+  double min_;
+  double max_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+inline
+TDigest::TDigest(double compression)
+: compression_(compression), totalWeight_(0.0)
+{
+  ORF_ASSERT(compression >= 10.0, "TDigest: the compression must be at least 10!");
+  reset();
+}
+
+inline
+void TDigest::add(double x)
+{
+  if (x < min_) min_ = x;
+  if (x > max_) max_ = x;
+  buffer_.push_back(Centroid{ x, 1.0 });
+  if (buffer_.size() >= 10 * (size_t) compression_)
+    compress();
+}
+
+inline
+void TDigest::merge(TDigest const& other)
+{
+  if (other.count() == 0)
+    return;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+  buffer_.insert(buffer_.end(), other.centroids_.begin(), other.centroids_.end());
+  buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+  compress();
+}
+
+inline
+size_t TDigest::count() const
+{
+  return (size_t) totalWeight_ + buffer_.size();
+}
+
+inline
+void TDigest::reset()
+{
+  centroids_.clear();
+  buffer_.clear();
+  totalWeight_ = 0.0;
+  min_ = std::numeric_limits<double>::max();
+  max_ = -std::numeric_limits<double>::max();
+}
+
+inline
+double TDigest::scale(double q, double total) const
+{
+  double norm = 4.0 * std::log(std::max(total / compression_, 1.0)) + 24.0;
+  return compression_ / norm * std::log(q / (1.0 - q));
+}
+
+inline
+void TDigest::compress()
+{
+  if (buffer_.empty())
+    return;
+
+  buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+  std::sort(buffer_.begin(), buffer_.end());
+  double total = 0.0;
+  for (auto const& c : buffer_)
+    total += c.weight;
+
+  // sweep left to right, absorbing centroids while the merged one spans at most one unit of k
+  centroids_.clear();
+  Centroid curr = buffer_[0];
+  double wleft = 0.0;                 // weight to the left of the current centroid
+  double kleft = scale(0.0, total);
+  for (size_t i = 1; i < buffer_.size(); ++i) {
+    Centroid const& c = buffer_[i];
+    double q = (wleft + curr.weight + c.weight) / total;
+    if (scale(q, total) - kleft <= 1.0) {
+      curr.mean += (c.mean - curr.mean) * c.weight / (curr.weight + c.weight);
+      curr.weight += c.weight;
+    }
+    else {
+      centroids_.push_back(curr);
+      wleft += curr.weight;
+      kleft = scale(wleft / total, total);
+      curr = c;
+    }
+  }
+  centroids_.push_back(curr);
+  totalWeight_ = total;
+  buffer_.clear();
+}
+
+inline
+double TDigest::quantile(double p)
+{
+  ORF_ASSERT(p >= 0.0 && p <= 1.0, "TDigest: the probability must be in [0, 1]!");
+  compress();
+  ORF_ASSERT(!centroids_.empty(), "TDigest: no samples!");
+  if (centroids_.size() == 1)
+    return centroids_[0].mean;
+
+  // each centroid is centered on its cumulative weight midpoint;
+  // interpolate linearly between midpoints, and to min and max at the ends
+  double target = p * totalWeight_;
+  double wcum = 0.0;
+  double xprev = min_, wprev = 0.0;
+  for (size_t i = 0; i < centroids_.size(); ++i) {
+    double wmid = wcum + 0.5 * centroids_[i].weight;
+    if (target < wmid) {
+      double lambda = (target - wprev) / (wmid - wprev);
+      return xprev + lambda * (centroids_[i].mean - xprev);
+    }
+    xprev = centroids_[i].mean;
+    wprev = wmid;
+    wcum += centroids_[i].weight;
+  }
+  double lambda = totalWeight_ > wprev ? (target - wprev) / (totalWeight_ - wprev) : 1.0;
+  return xprev + lambda * (max_ - xprev);
+}
+
+END_NAMESPACE(orf)
+
+#endif // ORF_TDIGEST_HPP
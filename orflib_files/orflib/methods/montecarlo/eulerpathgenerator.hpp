@@ -32,6 +32,9 @@ public:
   /** Returns the next price path */
   virtual void next(Matrix& pricePath) override;
 
+  /** Turns on stratified sampling of the normal deviates */
+  virtual void setStratification(size_t nStrata, bool latinHypercube) override;
+
 protected:
   NRNG nrng_;
   Vector sqrtDeltaT_;              // sqrt(T1), sqrt(T2-T1), ...
@@ -80,6 +83,18 @@ inline void EulerPathGenerator<NRNG>::next(Matrix& pricePath)
     for (size_t i = 0; i < ntimesteps_; ++i)
       pricePath(i, j) = normalDevs_(i);
   }
+  // shift the means if importance sampling, and keep track of the likelihood ratio
+  if (meanShift_.n_rows != 0) {
+    double logratio = 0.0;
+    for (size_t j = 0; j < nfactors_; ++j) {
+      for (size_t i = 0; i < ntimesteps_; ++i) {
+        double mu = meanShift_(i, j);
+        pricePath(i, j) += mu;
+        logratio += mu * (0.5 * mu - pricePath(i, j));
+      }
+    }
+    likelihoodRatio_ = exp(logratio);
+  }
   // finally apply the Cholesky factor if not empty
   if (sqrtCorrel_.n_rows != 0) {
     for (size_t i = 0; i < ntimesteps_; ++i) {
@@ -94,6 +109,13 @@ inline void EulerPathGenerator<NRNG>::next(Matrix& pricePath)
   }
 }
 
+// Each path is one point of the normal generator, drawn in one batch per factor
+template <typename NRNG>
+inline void EulerPathGenerator<NRNG>::setStratification(size_t nStrata, bool latinHypercube)
+{
+  nrng_.setStratification(nStrata, latinHypercube);
+}
+
 END_NAMESPACE(orf)
 
 #endif // ORF_EULERPATHGENERATOR_HPP
@@ -32,6 +32,14 @@ struct McParams
     EULER
   };
 
+  /** The known sampling types */
+  enum class SamplingType
+  {
+    PLAIN,           // independent deviates
+    STRATIFIED,      // the first normal deviate of each factor is stratified
+    LATINHYPERCUBE   // all normal deviates are stratified, with independent permutations
+  };
+
 
   /** Default ctor */
   McParams(UrngType u = UrngType::MT19937, PathGenType p = PathGenType::EULER);
@@ -39,6 +47,10 @@ struct McParams
   // state
   UrngType urngType;
   PathGenType pathGenType;
+  bool impSampling;              // if true, importance sampling with a mean shift found on pilot runs
+  unsigned long nPilotPaths;     // number of pilot paths per candidate mean shift
+  SamplingType samplingType;     // stratification of the normal deviates
+  unsigned long nStrata;         // number of strata, i.e. the number of paths per block of strata
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -46,7 +58,8 @@ struct McParams
 
 inline
 McParams::McParams(UrngType u, PathGenType p)
-: urngType(u), pathGenType(p)
+: urngType(u), pathGenType(p), impSampling(false), nPilotPaths(1000),
+  samplingType(SamplingType::PLAIN), nStrata(100)
 {}
 
 END_NAMESPACE(orf)
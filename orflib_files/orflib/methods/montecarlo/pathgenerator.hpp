@@ -34,8 +34,26 @@ public:
   */
   virtual void next(Matrix& pricePath) = 0;
 
+  /** Sets the shift of the means of the normal deviates, used for importance sampling.
+      The matrix must be of size ntimesteps * nfactors; an empty matrix removes the shift.
+      The shift is applied to the independent deviates, before correlating them.
+  */
+  void setMeanShift(Matrix const& meanShift);
+
+  /** Returns the likelihood ratio of the last generated path,
+      i.e. the density ratio of the unshifted to the shifted normal deviates.
+      It is equal to 1 if there is no mean shift.
+  */
+  double likelihoodRatio() const;
+
+  /** Turns on stratified sampling of the normal deviates over blocks of nStrata paths.
+      If latinHypercube is false, only the first deviate of each factor is stratified.
+      nStrata <= 1 turns it off.
+  */
+  virtual void setStratification(size_t nStrata, bool latinHypercube) = 0;
+
 protected:
-  PathGenerator() {};     // default ctor
+  PathGenerator() : likelihoodRatio_(1.0) {};     // default ctor
   PathGenerator(size_t ntimesteps, size_t nfactors, Matrix const& correlation);
 
   // Does spectral truncation and Cholesky decomposition on the correlation matrix
@@ -44,6 +62,8 @@ protected:
   size_t ntimesteps_;    // the number of time steps
   size_t nfactors_;      // the number of factors
   Matrix sqrtCorrel_;    // the Cholesky factor of the correlation matrix
+  Matrix meanShift_;     // the mean shift of the normal deviates, empty if none
+  double likelihoodRatio_;  // the likelihood ratio of the last path
 };
 
 using SPtrPathGenerator = std::shared_ptr<PathGenerator>;
@@ -52,7 +72,7 @@ using SPtrPathGenerator = std::shared_ptr<PathGenerator>;
 // Inline definitions
 inline
 PathGenerator::PathGenerator(size_t ntimesteps, size_t nfactors, Matrix const& correlMatrix)
-: ntimesteps_(ntimesteps), nfactors_(nfactors)
+: ntimesteps_(ntimesteps), nfactors_(nfactors), likelihoodRatio_(1.0)
 {
   ORF_ASSERT(correlMatrix.is_square(), "the correlation matrix is not square!");
   if (!correlMatrix.is_empty())
@@ -71,6 +91,20 @@ inline size_t PathGenerator::nFactors() const
   return nfactors_;
 }
 
+inline void PathGenerator::setMeanShift(Matrix const& meanShift)
+{
+  if (!meanShift.is_empty())
+    ORF_ASSERT(meanShift.n_rows == ntimesteps_ && meanShift.n_cols == nfactors_,
+      "the mean shift matrix must be of size ntimesteps x nfactors!");
+  meanShift_ = meanShift;
+  likelihoodRatio_ = 1.0;
+}
+
+inline double PathGenerator::likelihoodRatio() const
+{
+  return likelihoodRatio_;
+}
+
 END_NAMESPACE(orf)
 
 #endif // ORF_PATHGENERATOR_HPP
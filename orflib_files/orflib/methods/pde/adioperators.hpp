@@ -0,0 +1,93 @@
+/**
+@file  adioperators.hpp
+@brief Definition of the operators along one axis of the ADI PDE solvers
+*/
+
+#ifndef ORF_ADIOPERATORS_HPP
+#define ORF_ADIOPERATORS_HPP
+
+#include <orflib/methods/pde/tridiagonalops1d.hpp>
+#include <orflib/methods/pde/pdegrid.hpp>
+#include <algorithm>
+#include <cmath>
+
+BEGIN_NAMESPACE(orf)
+
+/** The operators along one axis of an ADI scheme, DT times the drift and diffusion terms of that direction.
+    They are shared by the 2-d and N-d solvers, which build and factorize them once per axis and step.
+*/
+struct AdiAxisOperators
+{
+  DeltaOp1D<Vector> deltaOp;
+  GammaOp1D<Vector> gammaOp;
+  TridiagonalOp1D<Vector> opExplicit;   // DT * A
+  TridiagonalOp1D<Vector> opImplicit;   // I - theta * DT * A, factorized
+  // the coefficients for which the operators were built
+  double cachedDT = 0.0, cachedTheta = 0.0;
+  Vector cachedDrifts, cachedVariances;
+
+  /** Forces the next update() to rebuild the operators, e.g. when the grid changed */
+  void reset() { cachedDT = 0.0; }
+
+  /** Rebuilds the operators for the axis grax if the time step, theta, the drifts or the variances changed */
+  void update(GridAxis const& grax, double DT, double theta);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+inline
+void AdiAxisOperators::update(GridAxis const& grax, double DT, double theta)
+{
+  // relative tolerance, to absorb the round-off in time steps computed as differences of times
+  const double tol = 1.0e-12;
+  auto close = [tol](double a, double b) {
+    return std::abs(a - b) <= tol * std::max(std::abs(a), std::abs(b));
+  };
+  bool reuse = cachedDT != 0.0 && close(DT, cachedDT) && theta == cachedTheta;
+  for (size_t i = 0; reuse && i < grax.drifts.size(); ++i)
+    reuse = close(grax.drifts[i], cachedDrifts[i]) && close(grax.variances[i], cachedVariances[i]);
+  if (reuse)
+    return;
+
+  // the implicit operator I - theta * DT * A
+  if (grax.uniform) {
+    deltaOp.init(grax.drifts, DT, grax.DX, theta);
+    gammaOp.init(grax.variances, DT, grax.DX, theta);
+  }
+  else {
+    deltaOp.init(grax.drifts, DT, grax.Xlevels, theta);
+    gammaOp.init(grax.variances, DT, grax.Xlevels, theta);
+  }
+  opImplicit.init(grax.NX, 0.0, 1.0, 0.0);
+  opImplicit -= deltaOp;
+  opImplicit -= gammaOp;
+
+  // the explicit operator DT * A
+  if (grax.uniform) {
+    deltaOp.init(grax.drifts, DT, grax.DX, 1.0);
+    gammaOp.init(grax.variances, DT, grax.DX, 1.0);
+  }
+  else {
+    deltaOp.init(grax.drifts, DT, grax.Xlevels, 1.0);
+    gammaOp.init(grax.variances, DT, grax.Xlevels, 1.0);
+  }
+  opExplicit.init(grax.NX, 0.0, 0.0, 0.0);
+  opExplicit += deltaOp;
+  opExplicit += gammaOp;
+
+  if (grax.uniform)
+    adjustOpsForBoundaryConditions(opExplicit, opImplicit, grax.DX);
+  else
+    adjustOpsForBoundaryConditions(opExplicit, opImplicit, grax.Xlevels);
+  opImplicit.factorize();
+
+  cachedDT = DT;
+  cachedTheta = theta;
+  cachedDrifts = grax.drifts;
+  cachedVariances = grax.variances;
+}
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_ADIOPERATORS_HPP
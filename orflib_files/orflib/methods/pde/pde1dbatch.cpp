@@ -0,0 +1,58 @@
+/**
+@file  pde1dbatch.cpp
+@brief Implementation of the batch 1-dim PDE solver
+*/
+
+#include <orflib/methods/pde/pde1dbatch.hpp>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <set>
+
+BEGIN_NAMESPACE(orf)
+
+std::vector<Pde1DResults> solvePde1DBatch(std::vector<Pde1DJob> const& jobs, size_t nThreads)
+{
+  std::set<Product const*> prods;
+  for (auto const& job : jobs) {
+    ORF_ASSERT(job.product && job.discountYieldCurve, "solvePde1DBatch: missing product or yield curve!");
+    ORF_ASSERT(prods.insert(job.product.get()).second, "solvePde1DBatch: jobs must not share product instances!");
+  }
+
+  std::vector<Pde1DResults> results(jobs.size());
+  std::vector<std::exception_ptr> errors(jobs.size());
+
+  // each worker pulls the next job index; every job writes only to its own results slot
+  std::atomic<size_t> nextJob(0);
+  auto worker = [&]() {
+    for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+      try {
+        Pde1DJob const& job = jobs[i];
+        Pde1DSolver solver(job.product, job.discountYieldCurve, job.spot, job.divYield, job.vol,
+                           results[i], job.storeAllResults);
+        solver.solve(job.params);
+      }
+      catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+
+  if (nThreads == 0)
+    nThreads = std::max(1u, std::thread::hardware_concurrency());
+  nThreads = std::min(nThreads, jobs.size());
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < nThreads; ++t)
+    pool.emplace_back(worker);
+  worker();   // the calling thread works too
+  for (auto& th : pool)
+    th.join();
+
+  for (auto const& err : errors)
+    if (err)
+      std::rethrow_exception(err);
+
+  return results;
+}
+
+END_NAMESPACE(orf)
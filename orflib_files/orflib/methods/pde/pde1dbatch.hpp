@@ -0,0 +1,45 @@
+/**
+@file  pde1dbatch.hpp
+@brief Solving a batch of 1-dim PDE pricing jobs concurrently
+*/
+
+#ifndef ORF_PDE1DBATCH_HPP
+#define ORF_PDE1DBATCH_HPP
+
+#include <orflib/methods/pde/pde1dsolver.hpp>
+#include <vector>
+
+BEGIN_NAMESPACE(orf)
+
+/** One pricing job for the 1-d pde solver: the product, its market inputs and the solver parameters.
+    CAUTION: products are evaluated in place, so jobs must not share product instances.
+*/
+struct Pde1DJob
+{
+  SPtrProduct product;
+  SPtrYieldCurve discountYieldCurve;
+  double spot;
+  double divYield;
+  double vol;
+  PdeParams params;
+  bool storeAllResults;
+
+  /** Default ctor */
+  Pde1DJob() : spot(0.0), divYield(0.0), vol(0.0), storeAllResults(false) {}
+
+  /** Initializing ctor */
+  Pde1DJob(SPtrProduct prod, SPtrYieldCurve discountYieldCurve, double spot, double divYield,
+           double vol, PdeParams const& params, bool storeAllResults = false)
+  : product(prod), discountYieldCurve(discountYieldCurve), spot(spot), divYield(divYield),
+    vol(vol), params(params), storeAllResults(storeAllResults) {}
+};
+
+/** Solves the jobs on a pool of nThreads threads and returns the results in the order of the jobs.
+    If nThreads is 0, it uses the number of hardware threads.
+    If any job throws, the remaining jobs are completed and the first exception, in job order, is rethrown.
+*/
+std::vector<Pde1DResults> solvePde1DBatch(std::vector<Pde1DJob> const& jobs, size_t nThreads = 0);
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_PDE1DBATCH_HPP
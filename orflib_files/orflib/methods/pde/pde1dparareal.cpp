@@ -0,0 +1,141 @@
+/**
+@file  pde1dparareal.cpp
+@brief Implementation of the Parareal solution of the 1-dim PDE
+*/
+
+#include <orflib/methods/pde/pde1dparareal.hpp>
+#include <orflib/methods/pde/workerpool.hpp>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+BEGIN_NAMESPACE(orf)
+
+Pde1DPararealResults solvePde1DParareal(std::function<SPtrProduct()> const& productFactory,
+                                        SPtrYieldCurve discountYieldCurve,
+                                        double spot,
+                                        double divYield,
+                                        double vol,
+                                        PdeParams const& params,
+                                        size_t nCoarseSteps,
+                                        size_t nSlices,
+                                        size_t nThreads,
+                                        double tolerance,
+                                        size_t maxIterations)
+{
+  WorkerPool pool(nThreads);
+  if (nSlices == 0)
+    nSlices = pool.nThreads();
+
+  // one fine solver per slice, each with its own product and results, all on the same time steps;
+  // the products are created serially, since the factory need not be thread safe
+  std::vector<Pde1DResults> fineResults(nSlices);
+  std::vector<std::unique_ptr<Pde1DSolver>> fine(nSlices);
+  for (size_t k = 0; k < nSlices; ++k)
+    fine[k].reset(new Pde1DSolver(productFactory(), discountYieldCurve, spot, divYield, vol, fineResults[k]));
+  pool.run(nSlices, [&](size_t begin, size_t end, size_t) {
+    for (size_t k = begin; k < end; ++k)
+      fine[k]->initSolve(params);
+  });
+  std::vector<double> const& times = fine[0]->timeSteps();
+  size_t nSteps = times.size();
+  ORF_ASSERT(nSteps > nSlices, "solvePde1DParareal: fewer time steps than slices!");
+
+  // the fine step indices of the slice boundaries, from the last step back to the first
+  std::vector<size_t> bounds(nSlices + 1);
+  for (size_t k = 0; k <= nSlices; ++k)
+    bounds[k] = size_t(std::round(double(nSteps - 1) * double(nSlices - k) / double(nSlices)));
+
+  // the coarse steps, about nCoarseSteps evenly spread over the fine steps, with all the slice boundaries,
+  // and the product events of the fine steps they fall on
+  std::vector<ptrdiff_t> const& events = fine[0]->stepIndices();
+  std::vector<double> coarseTimes;
+  std::vector<ptrdiff_t> coarseEvents;
+  std::vector<size_t> coarseBounds(nSlices + 1);
+  size_t stepsPerSlice = std::max(nCoarseSteps / nSlices, size_t(1));
+  for (ptrdiff_t k = nSlices - 1; k >= 0; --k) {
+    size_t begin = bounds[k + 1], end = bounds[k];
+    coarseBounds[k + 1] = coarseTimes.size();
+    for (size_t c = 0; c < stepsPerSlice; ++c) {
+      size_t i = begin + size_t(std::round(double(end - begin) * double(c) / double(stepsPerSlice)));
+      if (!coarseTimes.empty() && times[i] <= coarseTimes.back())
+        continue;   // fewer fine steps than coarse steps in this slice
+      coarseTimes.push_back(times[i]);
+      coarseEvents.push_back(events[i]);
+    }
+  }
+  coarseBounds[0] = coarseTimes.size();
+  coarseTimes.push_back(times[nSteps - 1]);
+  coarseEvents.push_back(events[nSteps - 1]);
+  Pde1DResults coarseResults;
+  Pde1DSolver coarse(productFactory(), discountYieldCurve, spot, divYield, vol, coarseResults);
+  // the coarse steps are fully implicit, since Crank-Nicolson is not damped enough on steps much longer
+  // than the fine ones, and its oscillations would grow through the iterations
+  PdeParams coarseParams = params;
+  coarseParams.theta = 1.0;
+  coarse.setTimeSteps(coarseTimes, coarseEvents);
+  coarse.initSolve(coarseParams);
+
+  // the values at the slice boundaries, starting from the payoff, and the first coarse sweep
+  std::vector<Matrix> values(nSlices + 1), coarseProps(nSlices), fineProps(nSlices);
+  coarse.evalProduct(coarseTimes.size() - 1);
+  values[0] = coarse.values();
+  for (size_t k = 0; k < nSlices; ++k) {
+    coarse.setValues(values[k]);
+    coarse.propagate(coarseBounds[k], coarseBounds[k + 1], coarseParams);
+    coarseProps[k] = coarse.values();
+    values[k + 1] = coarseProps[k];
+  }
+
+  // the Parareal iterations; the fine solves are repeated only for the slices whose start values changed
+  if (maxIterations == 0)
+    maxIterations = nSlices;
+  std::vector<bool> changed(nSlices, true);
+  std::vector<double> corrections;
+  size_t it = 0;
+  while (it < maxIterations) {
+    ++it;
+    std::vector<size_t> active;
+    for (size_t k = 0; k < nSlices; ++k)
+      if (changed[k])
+        active.push_back(k);
+    pool.run(active.size(), [&](size_t begin, size_t end, size_t) {
+      for (size_t a = begin; a < end; ++a) {
+        size_t k = active[a];
+        fine[k]->setValues(values[k]);
+        fine[k]->propagate(bounds[k], bounds[k + 1], params);
+        fineProps[k] = fine[k]->values();
+      }
+    });
+
+    // the serial coarse sweep with the corrections of the fine solves
+    double correction = 0.0;
+    std::fill(changed.begin(), changed.end(), false);
+    for (size_t k = 0; k < nSlices; ++k) {
+      coarse.setValues(values[k]);
+      coarse.propagate(coarseBounds[k], coarseBounds[k + 1], coarseParams);
+      Matrix next = coarse.values() + fineProps[k] - coarseProps[k];
+      coarseProps[k] = coarse.values();
+      double change = arma::abs(next - values[k + 1]).max();
+      correction = std::max(correction, change);
+      if (k + 1 < nSlices)
+        changed[k + 1] = change > 0.0;
+      values[k + 1] = next;
+    }
+    corrections.push_back(correction);
+    if (correction <= tolerance)
+      break;
+  }
+
+  // the results from the values at time 0, with the fine solver of the last slice
+  fine[nSlices - 1]->setValues(values[nSlices]);
+  fine[nSlices - 1]->storeResults();
+  Pde1DPararealResults res;
+  res.results = fineResults[nSlices - 1];
+  res.nSlices = nSlices;
+  res.nIterations = it;
+  res.corrections = Vector(corrections);
+  return res;
+}
+
+END_NAMESPACE(orf)
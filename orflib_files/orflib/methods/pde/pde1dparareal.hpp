@@ -0,0 +1,50 @@
+/**
+@file  pde1dparareal.hpp
+@brief Parallel in time (Parareal) solution of the 1-dim PDE
+*/
+
+#ifndef ORF_PDE1DPARAREAL_HPP
+#define ORF_PDE1DPARAREAL_HPP
+
+#include <orflib/methods/pde/pde1dsolver.hpp>
+#include <functional>
+
+BEGIN_NAMESPACE(orf)
+
+/** The results of the Parareal solve */
+struct Pde1DPararealResults
+{
+  Pde1DResults results;  // the prices and Greeks at the spot, as from the fine solver
+  size_t nSlices;        // the number of time slices
+  size_t nIterations;    // the number of Parareal iterations
+  Vector corrections;    // for each iteration, the largest change of the values at the slice boundaries
+};
+
+/** Solves the 1-d PDE with the Parareal method, for long dated products with dense fixings,
+    e.g. convertible bonds with daily conversion, whose backward time loop is otherwise serial.
+    The fine time steps, those of params, are split in nSlices slices of about equal number of steps.
+    A coarse solver with about nCoarseSteps steps, picked among the fine steps, propagates the values
+    across the slices serially, the fine solvers propagate them within the slices in parallel on nThreads
+    threads, and the Parareal corrections combine both, iterating until the values at the slice boundaries
+    change by less than tolerance, or for maxIterations iterations. After k iterations the first k slices
+    are exact, so that nSlices iterations reproduce the serial fine solve; 0 for maxIterations means nSlices.
+    Both solvers share the spot grid of params; the coarse steps are fully implicit. The product events
+    between the coarse steps are skipped by the coarse solver, which only slows down the convergence.
+    If nSlices is 0 it uses the number of threads; if nThreads is 0, the number of hardware threads.
+    The products are evaluated in place, so the factory must return a new product on each call.
+*/
+Pde1DPararealResults solvePde1DParareal(std::function<SPtrProduct()> const& productFactory,
+                                        SPtrYieldCurve discountYieldCurve,
+                                        double spot,
+                                        double divYield,
+                                        double vol,
+                                        PdeParams const& params,
+                                        size_t nCoarseSteps,
+                                        size_t nSlices = 0,
+                                        size_t nThreads = 0,
+                                        double tolerance = 1.0e-6,
+                                        size_t maxIterations = 0);
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_PDE1DPARAREAL_HPP
@@ -0,0 +1,56 @@
+/**
+@file  pde1drichardson.cpp
+@brief Implementation of the Richardson extrapolation of 1-dim PDE prices
+*/
+
+#include <orflib/methods/pde/pde1drichardson.hpp>
+#include <cmath>
+
+BEGIN_NAMESPACE(orf)
+
+Pde1DRichardsonResults solvePde1DRichardson(std::function<SPtrProduct()> const& productFactory,
+                                            SPtrYieldCurve discountYieldCurve,
+                                            double spot,
+                                            double divYield,
+                                            double vol,
+                                            PdeParams const& params,
+                                            size_t nLevels,
+                                            size_t nThreads)
+{
+  ORF_ASSERT(nLevels >= 2 && nLevels <= 3, "solvePde1DRichardson: the number of levels must be 2 or 3!");
+
+  // one job per level, each with twice as many time steps and spot intervals as the previous
+  std::vector<Pde1DJob> jobs(nLevels);
+  PdeParams levelParams = params;
+  for (size_t l = 0; l < nLevels; ++l) {
+    jobs[l] = Pde1DJob(productFactory(), discountYieldCurve, spot, divYield, vol, levelParams);
+    levelParams.nTimeSteps *= 2;
+    for (size_t& nx : levelParams.nSpotNodes)
+      nx = 2 * (nx + 1) - 1;
+  }
+  std::vector<Pde1DResults> results = solvePde1DBatch(jobs, nThreads);
+
+  Pde1DRichardsonResults res;
+  res.levelPrices.resize(nLevels);
+  for (size_t l = 0; l < nLevels; ++l)
+    res.levelPrices[l] = results[l].prices[0];
+
+  // the Richardson tableau, removing the errors of order 2 and then 4 in the grid spacing
+  Vector extrap = res.levelPrices;
+  double lastCorrection = 0.0;
+  double factor = 4.0;
+  for (size_t k = 1; k < nLevels; ++k) {
+    for (size_t l = nLevels - 1; l >= k; --l) {
+      double correction = (extrap[l] - extrap[l - 1]) / (factor - 1.0);
+      if (l == nLevels - 1)
+        lastCorrection = correction;
+      extrap[l] += correction;
+    }
+    factor *= 4.0;
+  }
+  res.price = extrap[nLevels - 1];
+  res.errorEstimate = std::abs(lastCorrection);
+  return res;
+}
+
+END_NAMESPACE(orf)
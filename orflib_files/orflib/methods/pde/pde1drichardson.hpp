@@ -0,0 +1,43 @@
+/**
+@file  pde1drichardson.hpp
+@brief Richardson extrapolation of 1-dim PDE prices over successively refined grids
+*/
+
+#ifndef ORF_PDE1DRICHARDSON_HPP
+#define ORF_PDE1DRICHARDSON_HPP
+
+#include <orflib/methods/pde/pde1dbatch.hpp>
+#include <functional>
+
+BEGIN_NAMESPACE(orf)
+
+/** The results of the Richardson extrapolation */
+struct Pde1DRichardsonResults
+{
+  double price;          // the extrapolated price
+  double errorEstimate;  // the size of the last extrapolation correction
+  Vector levelPrices;    // the prices on each grid, from the coarsest to the finest
+};
+
+/** Solves the 1-d PDE on nLevels grids and extrapolates the price to zero grid spacing.
+    Each level doubles the number of time steps and of spot intervals of the previous one,
+    starting from params; the levels are solved concurrently on nThreads threads (0 for the hardware threads).
+    The extrapolation assumes errors in even powers of the grid spacing, as for Crank-Nicolson;
+    it works best with Rannacher smoothing and with the nodes concentrated around the payoff kinks,
+    which keeps the kinks half way between nodes on all levels.
+    The products are evaluated in place, so the factory must return a new product on each call.
+    CAUTION: time steps are not refined below the spacing of the product fixings,
+    e.g. daily for American options, so the time error is not extrapolated for such products.
+*/
+Pde1DRichardsonResults solvePde1DRichardson(std::function<SPtrProduct()> const& productFactory,
+                                            SPtrYieldCurve discountYieldCurve,
+                                            double spot,
+                                            double divYield,
+                                            double vol,
+                                            PdeParams const& params,
+                                            size_t nLevels = 2,
+                                            size_t nThreads = 0);
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_PDE1DRICHARDSON_HPP
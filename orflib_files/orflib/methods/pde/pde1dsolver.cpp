@@ -5,19 +5,349 @@
 
 #include <orflib/methods/pde/pde1dsolver.hpp>
 #include <orflib/math/interpol/interpolation1d.hpp>
+#include <cmath>
+#include <algorithm>
 
 BEGIN_NAMESPACE(orf)
 
+/** Ctor for several products solved as layers on a shared grid */
+Pde1DSolver::Pde1DSolver(std::vector<SPtrProduct> const& products,
+                         SPtrYieldCurve discountYieldCurve,
+                         double spot,
+                         double divyield,
+                         double vol,
+                         Pde1DResults& results,
+                         bool storeAllResults)
+: PdeBase(products.empty() ? SPtrProduct() : products.front()),
+  results_(results), storeAllResults_(storeAllResults), spprods_(products), cachedDT_(0.0), cachedTheta_(0.0),
+  exerciseMethod_(PdeParams::ExerciseMethod::EXPLICIT), tangentVega_(false), tangentRho_(false),
+  stepLength_(0.0), outputGreeks_(false), boundaryCondition_(PdeParams::BoundaryCondition::LINEAR),
+  boundaryWeight_(0.0), boundaryStep_(-1), boundaryTime_(0.0), cashLayer_(false), creditSpread_(0.0)
+{
+  ORF_ASSERT(!spprods_.empty(), "Pde1DSolver: need at least one product!");
+  // the time steps are set up from the first product, so all must share its fixing times
+  Vector const& fixTimes = spprod_->fixTimes();
+  for (size_t j = 0; j < spprods_.size(); ++j) {
+    ORF_ASSERT(spprods_[j], "Pde1DSolver: null product!");
+    ORF_ASSERT(spprods_[j]->nAssets() == 1, "Pde1DSolver: all products must depend on one asset!");
+    Vector const& fixTms = spprods_[j]->fixTimes();
+    bool sameFixings = fixTms.size() == fixTimes.size();
+    for (size_t i = 0; sameFixings && i < fixTms.size(); ++i)
+      sameFixings = fixTms[i] == fixTimes[i];
+    ORF_ASSERT(sameFixings, "Pde1DSolver: all products must have the same fixing times!");
+  }
+  nAssets_ = 1;
+  nLayers_ = spprods_.size();  // one variable per product
+  spdiscyc_ = discountYieldCurve;
+  spots_.push_back(spot),
+  spaccrycs_.push_back(discountYieldCurve);
+  divyields_.push_back(divyield);
+  vols_.push_back(vol);
+}
+
+/** Sets the spots for the prices and Greeks of storeResults */
+void Pde1DSolver::setOutputSpots(std::vector<double> const& spots, bool greeks)
+{
+  outputSpots_ = Vector(spots);
+  outputGreeks_ = greeks;
+}
+
+/** Adds the vega and rho layers */
+void Pde1DSolver::setTangentSensitivities(bool vega, bool rho)
+{
+  tangentVega_ = vega;
+  tangentRho_ = rho;
+  nLayers_ = spprods_.size() * (1 + nTangents());
+}
+
+/** Adds the layer with the cash part of the value, discounted with the credit spread */
+void Pde1DSolver::setCreditSpread(double spread)
+{
+  ORF_ASSERT(spprods_.size() == 1, "Pde1DSolver: the credit spread needs a single product!");
+  cashLayer_ = true;
+  creditSpread_ = spread;
+  nLayers_ = 2;
+}
+
+/** Initializes the grid axes and keeps the exercise method and the boundary conditions of params */
+void Pde1DSolver::initGrid(double T, PdeParams const& params)
+{
+  exerciseMethod_ = params.exerciseMethod;
+  ORF_ASSERT(nTangents() == 0 || exerciseMethod_ == PdeParams::ExerciseMethod::EXPLICIT,
+             "Pde1DSolver: the tangent sensitivities need the explicit exercise method!");
+  boundaryCondition_ = params.boundaryCondition;
+  boundaryWeight_ = boundaryCondition_ == PdeParams::BoundaryCondition::NEUMANN ? 1.0 : 0.0;
+  ORF_ASSERT(nTangents() == 0 || boundaryCondition_ == PdeParams::BoundaryCondition::LINEAR,
+             "Pde1DSolver: the tangent sensitivities need the linear boundary conditions!");
+  ORF_ASSERT(!tangentVega_ || splocalvols_.empty() || !splocalvols_[0],
+             "Pde1DSolver: the vega tangent needs a constant volatility!");
+  ORF_ASSERT(!cashLayer_ || (nTangents() == 0 && exerciseMethod_ == PdeParams::ExerciseMethod::EXPLICIT
+                             && boundaryCondition_ == PdeParams::BoundaryCondition::LINEAR),
+             "Pde1DSolver: the credit spread needs no tangents, the explicit exercise method and linear boundaries!");
+  PdeBase::initGrid(T, params);
+}
+
 /** Solves backwards from one time step to the previous */
 void Pde1DSolver::solveFromStepToStep(ptrdiff_t step, double DT)
 {
-  // initialise operators
+  // rebuild and factorize the operators only if the coefficients changed,
+  // which with constant vol, flat rates and uniform steps happens only once
   GridAxis& grax = gridAxes_[0];
-  deltaOpExplicit_.init(grax.drifts, DT, grax.DX, 1.0 - theta_);
-  deltaOpImplicit_.init(grax.drifts, DT, grax.DX, theta_);
+  if (!canReuseOperators(grax, DT)) {
+    buildOperators(grax, DT);
+    if (nTangents() > 0)
+      buildTangentOperators(grax, step, DT);
+  }
+  stepLength_ = timesteps_[step + 1] - timesteps_[step];
+  bool asymptotic = boundaryCondition_ != PdeParams::BoundaryCondition::LINEAR;
+  if (asymptotic)
+    updateBoundaryValues(step, DT);
+
+  ptrdiff_t eventIdx = exerciseMethod_ != PdeParams::ExerciseMethod::EXPLICIT ? exerciseIndex_[step] : -1;
+  if (eventIdx >= 0) {
+    // impose the exercise bounds in the implicit solve, layer by layer;
+    // the solution is discounted after the step, so the bounds are scaled by the inverse discount factor.
+    // With Rannacher smoothing both half steps are constrained.
+    double df = spdiscyc_->fwdDiscount(timesteps_[step], timesteps_[step + 1]);
+    for (size_t j = 0; j < nLayers_; ++j) {
+      auto v1 = prevValues->col(j);
+      auto v2 = currValues->col(j);
+      opExplicit_.apply(v1, v2);
+      if (asymptotic)
+        addBoundaryTerms(j);
+      if (!spprods_[j]->exerciseBounds(eventIdx, grax.Slevels, lowerBound_, upperBound_))
+        opImplicit_.applyFactorizedInverse(v2, v1);
+      else {
+        lowerBound_ /= df;
+        upperBound_ /= df;
+        if (exerciseMethod_ == PdeParams::ExerciseMethod::BRENNAN_SCHWARTZ)
+          opImplicit_.applyProjectedInverse(v2, v1, lowerBound_, upperBound_);
+        else
+          opImplicit_.applyPenalizedInverse(v2, v1, lowerBound_, upperBound_);
+      }
+    }
+  }
+  else if (nTangents() > 0)
+    solveWithTangents();
+  else if (nLayers_ == 1) {
+    // NOTE: v1 and v2 are read-write views into the columns
+    // They are not independent copies, so we are modifying in place prevValues and currValues
+    auto v1 = prevValues->col(0);
+    auto v2 = currValues->col(0);
+    opExplicit_.apply(v1, v2);
+    if (asymptotic)
+      addBoundaryTerms(0);
+    opImplicit_.applyFactorizedInverse(v2, v1);
+  }
+  else {
+    // the explicit step runs layer by layer on contiguous columns,
+    // the implicit step runs across all layers in one sweep
+    for (size_t j = 0; j < nLayers_; ++j) {
+      auto v1 = prevValues->col(j);
+      auto v2 = currValues->col(j);
+      opExplicit_.apply(v1, v2);
+      if (asymptotic)
+        addBoundaryTerms(j);
+    }
+    opImplicit_.applyFactorizedInverseToLayers(*currValues, *prevValues);
+  }
 
-  gammaOpExplicit_.init(grax.variances, DT, grax.DX, 1.0 - theta_);
-  gammaOpImplicit_.init(grax.variances, DT, grax.DX, theta_);
+  // apply boundary coditions to solution
+  if (asymptotic)
+    setBoundaryValues();
+  else if (grax.uniform)
+    applyBoundaryConditions(*prevValues);
+  else
+    applyBoundaryConditions(*prevValues, grax.Xlevels);
+}
+
+/** Computes the boundary values of the layers at the end of the (possibly fractional) step */
+void Pde1DSolver::updateBoundaryValues(ptrdiff_t step, double DT)
+{
+  // the Rannacher half steps solve the same step twice, the first ending half way
+  double t0 = timesteps_[step], t1 = timesteps_[step + 1];
+  if (step != boundaryStep_) {
+    boundaryStep_ = step;
+    boundaryTime_ = t1;
+  }
+  boundaryTime_ -= DT;
+  if (boundaryTime_ < t0 + 1.0e-12 * (t1 - t0))
+    boundaryTime_ = t0;
+  double t = boundaryTime_;
+
+  // the values solved for are discounted to t1 after the step, so the asymptotic values are scaled
+  // by the inverse of the discount factor from t to t1
+  GridAxis const& grax = gridAxes_[0];
+  size_t n = grax.NX;
+  double dfStep = spdiscyc_->fwdDiscount(t, t1);
+  double S[4] = { grax.Slevels[0], grax.Slevels[1], grax.Slevels[n], grax.Slevels[n + 1] };
+  for (size_t j = 0; j < spprods_.size(); ++j) {
+    Vector const& payTimes = spprods_[j]->payTimes();
+    double T = payTimes[payTimes.size() - 1];
+    double df = spdiscyc_->fwdDiscount(t, T);
+    double fwdFactor = std::exp(-divyields_[0] * (T - t)) / spaccrycs_[0]->fwdDiscount(t, T);
+    double g[4];
+    for (size_t k = 0; k < 4; ++k) {
+      bool provided = spprods_[j]->asymptoticValue(t, S[k], df, S[k] * fwdFactor, g[k]);
+      ORF_ASSERT(provided, "Pde1DSolver: the Dirichlet and Neumann boundary conditions need asymptotic values!");
+    }
+    if (boundaryCondition_ == PdeParams::BoundaryCondition::NEUMANN) {
+      // the slopes of the asymptotic values between the edge nodes and their neighbours
+      lowBoundary_[j] = (g[0] - g[1]) / dfStep;
+      highBoundary_[j] = (g[3] - g[2]) / dfStep;
+    }
+    else {
+      lowBoundary_[j] = g[0] / dfStep;
+      highBoundary_[j] = g[3] / dfStep;
+    }
+  }
+}
+
+/** Adds to the explicit step of layer j the terms of the boundary values */
+void Pde1DSolver::addBoundaryTerms(size_t j)
+{
+  // the explicit operator takes the edge values of the previous step as they are, the implicit operator has
+  // the weights folded in its first and last rows, and the terms of the new boundary values go to the right side
+  size_t n = gridAxes_[0].NX;
+  (*currValues)(1, j) += opExplicit_.lowerBoundaryCoeff() * (*prevValues)(0, j)
+                       - opImplicit_.lowerBoundaryCoeff() * lowBoundary_[j];
+  (*currValues)(n, j) += opExplicit_.upperBoundaryCoeff() * (*prevValues)(n + 1, j)
+                       - opImplicit_.upperBoundaryCoeff() * highBoundary_[j];
+}
+
+/** Sets the values on the edge nodes after the implicit step */
+void Pde1DSolver::setBoundaryValues()
+{
+  size_t n = gridAxes_[0].NX;
+  for (size_t j = 0; j < nLayers_; ++j) {
+    (*prevValues)(0, j) = boundaryWeight_ * (*prevValues)(1, j) + lowBoundary_[j];
+    (*prevValues)(n + 1, j) = boundaryWeight_ * (*prevValues)(n, j) + highBoundary_[j];
+  }
+}
+
+/** Solves the price layers, then the tangent layers with the source terms from the price layers */
+void Pde1DSolver::solveWithTangents()
+{
+  size_t nprods = spprods_.size();
+  // the explicit parts of the tangents, from the prices before they are overwritten
+  for (size_t k = 0; k < nTangents(); ++k) {
+    for (size_t j = 0; j < nprods; ++j) {
+      size_t col = (k + 1) * nprods + j;
+      auto w2 = currValues->col(col);
+      opExplicit_.apply(prevValues->col(col), w2);
+      tangentOpsExplicit_[k].applyPlus(prevValues->col(j), w2);
+    }
+  }
+  for (size_t j = 0; j < nprods; ++j) {
+    auto v1 = prevValues->col(j);
+    auto v2 = currValues->col(j);
+    opExplicit_.apply(v1, v2);
+    opImplicit_.applyFactorizedInverse(v2, v1);
+  }
+  // the implicit parts, from the new prices, and one more back-substitution per tangent layer
+  for (size_t k = 0; k < nTangents(); ++k) {
+    for (size_t j = 0; j < nprods; ++j) {
+      size_t col = (k + 1) * nprods + j;
+      auto w2 = currValues->col(col);
+      auto w1 = prevValues->col(col);
+      tangentOpsImplicit_[k].applyPlus(prevValues->col(j), w2);
+      opImplicit_.applyFactorizedInverse(w2, w1);
+    }
+  }
+}
+
+/** Builds the derivatives of the operators in the volatility and in the rate */
+void Pde1DSolver::buildTangentOperators(GridAxis const& grax, ptrdiff_t step, double DT)
+{
+  // the drifts are driftFactor * driftCoeffs - 0.5 * vol^2 * convexityCoeffs and the variances
+  // vol^2 * varianceCoeffs, see PdeBase::updateGrid, where driftFactor depends on the rate
+  // through the forward factor a over the step
+  size_t n = grax.NX;
+  double vol = vols_[0];
+  double fwdRate = spaccrycs_[0]->fwdRate(timesteps_[step], timesteps_[step + 1]);
+  double a = std::exp((fwdRate - divyields_[0]) * DT);
+  double den = theta_ * a + 1.0 - theta_;
+  Vector dDrifts(n), dVariances(n);
+  size_t k = 0;
+  for (int param = 0; param < 2; ++param) {
+    if ((param == 0 && !tangentVega_) || (param == 1 && !tangentRho_))
+      continue;
+    for (size_t i = 0; i < n; ++i) {
+      if (param == 0) {       // d/dvol
+        dDrifts[i] = -vol * grax.convexityCoeffs[i];
+        dVariances[i] = 2.0 * vol * grax.varianceCoeffs[i];
+      }
+      else {                  // d/drate
+        dDrifts[i] = a / (den * den) * grax.driftCoeffs[i];
+        dVariances[i] = 0.0;
+      }
+    }
+    // the same construction as the operators, which is linear in the coefficients;
+    // the implicit one has the opposite sign, to be added to the right hand side
+    TridiagonalOp1D<Vector>& opExp = tangentOpsExplicit_[k];
+    TridiagonalOp1D<Vector>& opImp = tangentOpsImplicit_[k];
+    if (grax.uniform) {
+      deltaOpExplicit_.init(dDrifts, DT, grax.DX, 1.0 - theta_);
+      deltaOpImplicit_.init(dDrifts, DT, grax.DX, theta_);
+      gammaOpExplicit_.init(dVariances, DT, grax.DX, 1.0 - theta_);
+      gammaOpImplicit_.init(dVariances, DT, grax.DX, theta_);
+    }
+    else {
+      deltaOpExplicit_.init(dDrifts, DT, grax.Xlevels, 1.0 - theta_);
+      deltaOpImplicit_.init(dDrifts, DT, grax.Xlevels, theta_);
+      gammaOpExplicit_.init(dVariances, DT, grax.Xlevels, 1.0 - theta_);
+      gammaOpImplicit_.init(dVariances, DT, grax.Xlevels, theta_);
+    }
+    opExp.init(n, 0.0, 0.0, 0.0);
+    opExp += deltaOpExplicit_;
+    opExp += gammaOpExplicit_;
+    opImp.init(n, 0.0, 0.0, 0.0);
+    opImp += deltaOpImplicit_;
+    opImp += gammaOpImplicit_;
+    if (grax.uniform)
+      adjustOpsForBoundaryConditions(opExp, opImp, grax.DX);
+    else
+      adjustOpsForBoundaryConditions(opExp, opImp, grax.Xlevels);
+    ++k;
+  }
+}
+
+/** Checks if the time step, drifts and variances are the same as for the cached operators */
+bool Pde1DSolver::canReuseOperators(GridAxis const& grax, double DT) const
+{
+  // relative tolerance, to absorb the round-off in time steps computed as differences of times
+  const double tol = 1.0e-12;
+  auto close = [tol](double a, double b) {
+    return std::abs(a - b) <= tol * std::max(std::abs(a), std::abs(b));
+  };
+
+  if (cachedDT_ == 0.0 || !close(DT, cachedDT_) || theta_ != cachedTheta_)
+    return false;
+  if (cachedDrifts_.size() != grax.drifts.size() || cachedVariances_.size() != grax.variances.size())
+    return false;
+  for (size_t i = 0; i < grax.drifts.size(); ++i) {
+    if (!close(grax.drifts[i], cachedDrifts_[i]) || !close(grax.variances[i], cachedVariances_[i]))
+      return false;
+  }
+  return true;
+}
+
+/** Builds the explicit and implicit operators for this step and factorizes the implicit one */
+void Pde1DSolver::buildOperators(GridAxis const& grax, double DT)
+{
+  // initialise operators, with the non-uniform stencils if the nodes are not equally spaced
+  if (grax.uniform) {
+    deltaOpExplicit_.init(grax.drifts, DT, grax.DX, 1.0 - theta_);
+    deltaOpImplicit_.init(grax.drifts, DT, grax.DX, theta_);
+    gammaOpExplicit_.init(grax.variances, DT, grax.DX, 1.0 - theta_);
+    gammaOpImplicit_.init(grax.variances, DT, grax.DX, theta_);
+  }
+  else {
+    deltaOpExplicit_.init(grax.drifts, DT, grax.Xlevels, 1.0 - theta_);
+    deltaOpImplicit_.init(grax.drifts, DT, grax.Xlevels, theta_);
+    gammaOpExplicit_.init(grax.variances, DT, grax.Xlevels, 1.0 - theta_);
+    gammaOpImplicit_.init(grax.variances, DT, grax.Xlevels, theta_);
+  }
 
   // build the explicit and implicit operators
   opExplicit_.init(grax.NX, 0.0, 1.0, 0.0); // initialize to identity matrix
@@ -27,21 +357,21 @@ void Pde1DSolver::solveFromStepToStep(ptrdiff_t step, double DT)
   opImplicit_ -= deltaOpImplicit_;
   opImplicit_ -= gammaOpImplicit_;
 
-  // adjust the operators for boundary conditions
-  adjustOpsForBoundaryConditions(opExplicit_, opImplicit_, grax.DX);
+  // adjust the operators for boundary conditions; with asymptotic boundary values the explicit operator
+  // is left as it is, since the edge values of the previous step are known
+  if (boundaryCondition_ != PdeParams::BoundaryCondition::LINEAR)
+    opImplicit_.adjustForAffineBoundaryConditions(boundaryWeight_, boundaryWeight_);
+  else if (grax.uniform)
+    adjustOpsForBoundaryConditions(opExplicit_, opImplicit_, grax.DX);
+  else
+    adjustOpsForBoundaryConditions(opExplicit_, opImplicit_, grax.Xlevels);
 
-  // Main loop over the layers
-  for (size_t j = 0; j < nLayers_; ++j) {
-    // NOTE: v1 and v2 are read-write views into the corresponding columns
-    // They are not independent copies, so we are modifying in place prevValues and currValues
-    auto v1 = prevValues->col(j);
-    auto v2 = currValues->col(j);
-    opExplicit_.apply(v1, v2);
-    opImplicit_.applyInverse(v2, v1);
-  }
+  opImplicit_.factorize();
 
-  // apply boundary coditions to solution
-  applyBoundaryConditions(*prevValues);
+  cachedDT_ = DT;
+  cachedTheta_ = theta_;
+  cachedDrifts_ = grax.drifts;
+  cachedVariances_ = grax.variances;
 }
 
 
@@ -59,11 +389,31 @@ void Pde1DSolver::initValLayers()
   }
   prevValues = &values1; currValues = &values2;
 
-  // prepare the results
+  // the grid and theta may have changed since the last solve
+  cachedDT_ = 0.0;
+  boundaryStep_ = -1;
+  lowBoundary_.zeros(nLayers_);
+  highBoundary_.zeros(nLayers_);
+  nextStepValues_[0].reset();
+  nextStepValues_[1].reset();
+
+  // with the exercise imposed in the implicit solve, the bounds hold on every step,
+  // with the rights of the next fixing, so that the exercise is continuous between fixings
+  exerciseIndex_.assign(nSteps_, -1);
+  ptrdiff_t nextIdx = -1;
+  for (ptrdiff_t i = nSteps_ - 1; i >= 0; --i) {
+    if (stepindex_[i] >= 0)
+      nextIdx = stepindex_[i];
+    exerciseIndex_[i] = nextIdx;
+  }
+
+  // prepare the results; the full grid values are kept only on request
   results_.times.resize(nSteps_);
-  results_.values.resize(nSteps_);
+  results_.values.clear();
   if (storeAllResults_)
     results_.values.resize(nSteps_);
+  if (spsink_)
+    spsink_->init(timesteps_, gridAxes_[0], nLayers_);
 }
 
 
@@ -72,36 +422,186 @@ void Pde1DSolver::evalProduct(size_t stepIdx)
 {
   ptrdiff_t eventIdx = stepindex_[stepIdx];
   if (eventIdx >= 0) {             // product event, must evaluate
-    Vector const & payTms = spprod_->payTimes();       // the payment times
-    double fixtime = spprod_->fixTimes()[eventIdx]; // the fixing time
-    Vector spots(1);                                   // one underlying spot
-    for (size_t node = 0; node <= gridAxes_[0].NX + 1; ++node) {
-      spots[0] = gridAxes_[0].Slevels[node];
-      spprod_->eval(eventIdx, spots, (*prevValues)(node, 0));
-      // read out the ammounts
-      Vector const & payAms = spprod_->payAmounts();
-      size_t i = 0;
-      while (fixtime > payTms[i]) ++i;
+    size_t nprods = spprods_.size();
+    for (size_t j = 0; j < nprods; ++j) {
+      // the tangents go through the event by the directional derivative of the evaluation
+      // along the tangent, by a small difference; this needs the values before the event
+      Vector oldValues;
+      if (nTangents() > 0)
+        oldValues = prevValues->col(j);
+      // evaluate in place on the column of this layer, with a vector borrowing its memory
       // TODO: fwd discount
-      (*prevValues)(node, 0) = payAms[eventIdx];
+      Vector values(prevValues->colptr(j), prevValues->n_rows, false, true);
+      spprods_[j]->evalOnGrid(eventIdx, gridAxes_[0].Slevels, values);
+      if (cashLayer_) {
+        Vector cash(prevValues->colptr(1), prevValues->n_rows, false, true);
+        bool provided = spprods_[j]->evalCashOnGrid(eventIdx, gridAxes_[0].Slevels, values, cash);
+        ORF_ASSERT(provided, "Pde1DSolver: the credit spread needs a product with a cash part!");
+      }
+      for (size_t k = 0; k < nTangents(); ++k) {
+        Vector tangent(prevValues->colptr((k + 1) * nprods + j), prevValues->n_rows, false, true);
+        double tmax = arma::abs(tangent).max();
+        if (tmax == 0.0)
+          continue;
+        double h = 1.0e-6 * (1.0 + arma::abs(values).max()) / tmax;
+        Vector bumped = oldValues + h * tangent;
+        spprods_[j]->evalOnGrid(eventIdx, gridAxes_[0].Slevels, bumped);
+        tangent = (bumped - values) / h;
+      }
     }
   }
+  // keep the price layers at the first two steps after 0, for theta
+  if (stepIdx == 1 || stepIdx == 2)
+    nextStepValues_[stepIdx - 1] = prevValues->cols(0, spprods_.size() - 1);
   results_.times[stepIdx] = timesteps_[stepIdx];
   if (storeAllResults_)
     results_.values[stepIdx] = *prevValues;
+  if (spsink_)
+    spsink_->store(stepIdx, *prevValues);
 }
 
 /** Stores the solver results */
 void Pde1DSolver::storeResults()
 {
   results_.gridAxes = gridAxes_;
-  results_.prices.resize(nLayers_);
-  for (size_t j = 0; j < nLayers_; ++j) {
-    double X0 = gridAxes_[0].coordinateChange->fromRealToDiffused(spots_[0]);
+  size_t nprods = spprods_.size();
+  double X0 = gridAxes_[0].coordinateChange->fromRealToDiffused(spots_[0]);
+  results_.prices.resize(nprods);
+  for (size_t j = 0; j < nprods; ++j) {
     Vector temp(prevValues->col(j));
     LinearInterpolation1D<Vector> interp(gridAxes_[0].Xlevels, temp);
     results_.prices[j] = interp.getValue(X0);
   }
+
+  // the cash part, interpolated as the prices
+  results_.cashParts.reset();
+  if (cashLayer_) {
+    Vector temp(prevValues->col(1));
+    LinearInterpolation1D<Vector> interp(gridAxes_[0].Xlevels, temp);
+    results_.cashParts = { interp.getValue(X0) };
+  }
+
+  // the tangent layers, interpolated as the prices
+  results_.vegas.reset();
+  results_.rhos.reset();
+  size_t col = nprods;
+  for (int param = 0; param < 2; ++param) {
+    if ((param == 0 && !tangentVega_) || (param == 1 && !tangentRho_))
+      continue;
+    Vector& sens = param == 0 ? results_.vegas : results_.rhos;
+    sens.resize(nprods);
+    for (size_t j = 0; j < nprods; ++j, ++col) {
+      Vector temp(prevValues->col(col));
+      LinearInterpolation1D<Vector> interp(gridAxes_[0].Xlevels, temp);
+      sens[j] = interp.getValue(X0);
+    }
+  }
+
+  // delta and gamma from the quadratic through the three nodes nearest the spot, in spot space,
+  // since the nodes are not equally spaced in spot
+  Vector const& S = gridAxes_[0].Slevels;
+  double S0 = spots_[0];
+  size_t i = std::lower_bound(S.begin(), S.end(), S0) - S.begin();
+  if (i > 0 && (i == S.size() || S0 - S[i - 1] < S[i] - S0))
+    --i;
+  i = std::min(std::max(i, size_t(1)), size_t(S.size() - 2));   // the middle node of the three
+  double h1 = S[i] - S[i - 1], h2 = S[i + 1] - S[i];
+  double x = S0 - S[i];
+  results_.deltas.resize(nprods);
+  results_.gammas.resize(nprods);
+  for (size_t j = 0; j < nprods; ++j) {
+    double vm = (*prevValues)(i - 1, j), v = (*prevValues)(i, j), vp = (*prevValues)(i + 1, j);
+    double dm = (v - vm) / h1, dp = (vp - v) / h2;        // the one-sided slopes
+    double gamma = 2.0 * (dp - dm) / (h1 + h2);
+    results_.deltas[j] = (h1 * dp + h2 * dm) / (h1 + h2) + gamma * x;
+    results_.gammas[j] = gamma;
+  }
+
+  // theta from the prices at the same spot at the next two time steps, by the second order
+  // one-sided difference; with one step only, by the first order difference
+  results_.thetas.zeros(nprods);
+  for (size_t j = 0; j < nprods && nSteps_ > 1; ++j) {
+    double nextPrices[2] = { 0.0, 0.0 };
+    for (size_t k = 0; k < 2 && k + 1 < nSteps_; ++k) {
+      Vector temp(nextStepValues_[k].col(j));
+      LinearInterpolation1D<Vector> interp(gridAxes_[0].Xlevels, temp);
+      nextPrices[k] = interp.getValue(X0);
+    }
+    results_.thetas[j] = theta(results_.prices[j], nextPrices[0], nextPrices[1]);
+  }
+
+  if (!outputSpots_.empty())
+    storeSpotResults();
+}
+
+/** Returns theta from the prices at the same spot at times 0, t1 and t2 */
+double Pde1DSolver::theta(double v0, double v1, double v2) const
+{
+  // the second order one-sided difference; with one step only, the first order difference
+  if (nSteps_ > 2) {
+    double t1 = timesteps_[1] - timesteps_[0], t2 = timesteps_[2] - timesteps_[0];
+    return -(t1 + t2) / (t1 * t2) * v0 + t2 / (t1 * (t2 - t1)) * v1 - t1 / (t2 * (t2 - t1)) * v2;
+  }
+  return (v1 - v0) / (timesteps_[1] - timesteps_[0]);
+}
+
+/** Stores the prices and Greeks at the output spots */
+void Pde1DSolver::storeSpotResults()
+{
+  GridAxis const& grax = gridAxes_[0];
+  size_t nprods = spprods_.size();
+  size_t nspots = outputSpots_.size();
+  results_.outputSpots = outputSpots_;
+  results_.spotPrices.set_size(nspots, nprods);
+  results_.spotDeltas.reset();
+  results_.spotGammas.reset();
+  results_.spotThetas.reset();
+  if (outputGreeks_) {
+    results_.spotDeltas.set_size(nspots, nprods);
+    results_.spotGammas.set_size(nspots, nprods);
+    results_.spotThetas.set_size(nspots, nprods);
+  }
+
+  // the spots in the diffused coordinate, and the derivatives of the spot in it by central differences,
+  // to turn the derivatives of the interpolant in the diffused coordinate into delta and gamma
+  Vector X(nspots), dS(nspots), d2S(nspots);
+  double eps = 1.0e-4 * grax.DX;
+  for (size_t k = 0; k < nspots; ++k) {
+    ORF_ASSERT(outputSpots_[k] >= grax.Slevels[0] && outputSpots_[k] <= grax.Slevels[grax.NX + 1],
+               "Pde1DSolver: the output spots must lie within the grid!");
+    X[k] = grax.coordinateChange->fromRealToDiffused(outputSpots_[k]);
+    double Sm = grax.coordinateChange->fromDiffusedToReal(X[k] - eps);
+    double Sp = grax.coordinateChange->fromDiffusedToReal(X[k] + eps);
+    dS[k] = (Sp - Sm) / (2.0 * eps);
+    d2S[k] = (Sp - 2.0 * outputSpots_[k] + Sm) / (eps * eps);
+  }
+
+  for (size_t j = 0; j < nprods; ++j) {
+    Vector temp(prevValues->col(j));
+    CubicInterpolation1D<Vector> interp(grax.Xlevels, temp);
+    for (size_t k = 0; k < nspots; ++k) {
+      results_.spotPrices(k, j) = interp.getValue(X[k]);
+      if (outputGreeks_) {
+        double delta = interp.getDerivative(X[k]) / dS[k];
+        results_.spotDeltas(k, j) = delta;
+        results_.spotGammas(k, j) = (interp.getSecondDerivative(X[k]) - delta * d2S[k]) / (dS[k] * dS[k]);
+      }
+    }
+    if (!outputGreeks_)
+      continue;
+    Vector nextPrices[2];
+    for (size_t l = 0; l < 2; ++l) {
+      nextPrices[l].zeros(nspots);
+      if (l + 1 >= nSteps_)
+        continue;
+      Vector next(nextStepValues_[l].col(j));
+      CubicInterpolation1D<Vector> nextInterp(grax.Xlevels, next);
+      for (size_t k = 0; k < nspots; ++k)
+        nextPrices[l][k] = nextInterp.getValue(X[k]);
+    }
+    for (size_t k = 0; k < nspots; ++k)
+      results_.spotThetas(k, j) = nSteps_ > 1 ? theta(results_.spotPrices(k, j), nextPrices[0][k], nextPrices[1][k]) : 0.0;
+  }
 }
 
 /** Discounts the grid functions on the current time step, by applying
@@ -109,6 +609,20 @@ void Pde1DSolver::storeResults()
 void Pde1DSolver::discountFromStepToStep(double df)
 {
   *prevValues *= df;
+  // the cash part is discounted with the credit spread too, and so is the value through it;
+  // these terms commute with the operators, so that applying them after the step is exact
+  if (cashLayer_) {
+    double dfSpread = std::exp(-creditSpread_ * stepLength_);
+    prevValues->col(0) -= (1.0 - dfSpread) * prevValues->col(1);
+    prevValues->col(1) *= dfSpread;
+  }
+  // the discount factor depends on the rate too
+  if (tangentRho_) {
+    size_t nprods = spprods_.size();
+    size_t rhoCol = nprods * (tangentVega_ ? 2 : 1);
+    for (size_t j = 0; j < nprods; ++j)
+      prevValues->col(rhoCol + j) -= stepLength_ * prevValues->col(j);
+  }
 }
 
 END_NAMESPACE(orf)
\ No newline at end of file
@@ -9,10 +9,18 @@
 #include <orflib/methods/pde/pdebase.hpp>
 #include <orflib/methods/pde/tridiagonalops1d.hpp>
 #include <orflib/methods/pde/pderesults.hpp>
+#include <orflib/methods/pde/pderesultssink.hpp>
 
 BEGIN_NAMESPACE(orf)
 
-/** The 1-d pde solver class */
+/** The 1-d pde solver class.
+    Early exercise is applied by the products after each step, or imposed inside the implicit solve
+    as selected in PdeParams::exerciseMethod, for the products that provide exerciseBounds().
+    The values on the edge nodes are extrapolated linearly, or set from the asymptotic values of the products
+    as selected in PdeParams::boundaryCondition, for the products that provide asymptoticValue().
+    Products that pay either cash or shares, e.g. convertible bonds, can be solved with a credit spread
+    on the cash part, see setCreditSpread().
+*/
 class Pde1DSolver : public PdeBase
 {
 public:
@@ -24,10 +32,14 @@ public:
               double vol,
               Pde1DResults& results,
               bool storeAllResults = false)
-  : PdeBase(product), results_(results), storeAllResults_(storeAllResults)
+  : PdeBase(product), results_(results), storeAllResults_(storeAllResults),
+    spprods_(1, product), cachedDT_(0.0), cachedTheta_(0.0),
+    exerciseMethod_(PdeParams::ExerciseMethod::EXPLICIT), tangentVega_(false), tangentRho_(false),
+    stepLength_(0.0), outputGreeks_(false), boundaryCondition_(PdeParams::BoundaryCondition::LINEAR),
+    boundaryWeight_(0.0), boundaryStep_(-1), boundaryTime_(0.0), cashLayer_(false), creditSpread_(0.0)
   {
     nAssets_ = product->nAssets();
-    nLayers_ = 1;  // currently we solve for only one variable
+    nLayers_ = 1;  // one variable, the value of the product
     spdiscyc_ = discountYieldCurve;
     spots_.push_back(spot),
     spaccrycs_.push_back(discountYieldCurve);
@@ -35,9 +47,68 @@ public:
     vols_.push_back(vol);
   }
 
+  /** Ctor for several products on the same underlying, solved as layers on a shared grid,
+      e.g. a strike ladder. The operators are built and factorized once per time step for all layers.
+      All products must depend on one asset and have the same fixing times.
+      The results hold one price per product, in the order of the input.
+  */
+  Pde1DSolver(std::vector<SPtrProduct> const& products,
+              SPtrYieldCurve discountYieldCurve,
+              double spot,
+              double divyield,
+              double vol,
+              Pde1DResults& results,
+              bool storeAllResults = false);
+
   /** Dtor */
   virtual ~Pde1DSolver() override {}
 
+  /** Sets a sink receiving the grid values at each time step, e.g. decimated in time or restricted
+      to a spot window, instead of or in addition to the full copies kept with storeAllResults */
+  void setResultsSink(SPtrPde1DResultsSink sink) { spsink_ = sink; }
+
+  /** Sets spots at which storeResults reports the prices and, if greeks is true, delta, gamma and theta,
+      from the same solve, e.g. a spot ladder for scenarios. They are interpolated by cubic splines in the
+      diffused coordinate, so they are accurate between the nodes; the spots must lie within the grid.
+      The results hold one row per spot and one column per product.
+  */
+  void setOutputSpots(std::vector<double> const& spots, bool greeks = false);
+
+  /** Adds layers with the sensitivities of the products to the volatility (vega) and to the rate (rho),
+      solved on the same grid as the prices from the derivatives of the scheme (tangent equations).
+      The operators are shared with the prices, so that each sensitivity layer costs one more
+      back-substitution per step. Call before solve(); the results then hold vegas and rhos.
+      The grid values stored or sent to the sink hold the prices in the first columns,
+      then the vegas and then the rhos, one column per product in each block.
+      Requires the explicit exercise method.
+  */
+  void setTangentSensitivities(bool vega, bool rho);
+
+  /** Solves the product in the two-layer formulation of Tsiveriotis and Fernandes: the second layer holds
+      the cash part of the value, discounted at the risk-free rate plus the credit spread of the issuer,
+      and the value is discounted at the risk-free rate on its equity part and at the risky rate on its cash part:
+        dV/dt + L V - r (V - B) - (r + spread) B = 0,   dB/dt + L B - (r + spread) B = 0
+      where L is the Black-Scholes operator without the discounting. Both layers share the operators
+      and are solved in one sweep; the product splits its value at the fixings with evalCashOnGrid().
+      Call before solve(); the results then hold the cash parts. Needs one product, no tangent layers,
+      the explicit exercise method and the linear boundary conditions.
+  */
+  void setCreditSpread(double spread);
+
+  /** The values on the grid at the last time step solved, one row per spot node and one column per layer */
+  Matrix const& values() const { return *prevValues; }
+
+  /** Replaces the values on the grid at the last time step solved, e.g. before propagate() */
+  void setValues(Matrix const& values)
+  {
+    ORF_ASSERT(values.n_rows == prevValues->n_rows && values.n_cols == prevValues->n_cols,
+               "Pde1DSolver: the values do not match the grid!");
+    *prevValues = values;
+  }
+
+  /** Initializes the grid axes and keeps the exercise method and the boundary conditions of params */
+  virtual void initGrid(double T, PdeParams const& params) override;
+
   /** Solves backwards from one time step to the previous */
   virtual void solveFromStepToStep(ptrdiff_t step, double DT) override;
 
@@ -58,6 +129,39 @@ public:
 
 protected:
 
+  /** Returns true if the operators built for the previous step can be reused for this step,
+      i.e. if the time step, theta, the drifts and the variances are unchanged */
+  bool canReuseOperators(GridAxis const& grax, double DT) const;
+
+  /** Builds the explicit and implicit operators for this step and factorizes the implicit one */
+  void buildOperators(GridAxis const& grax, double DT);
+
+  /** The number of tangent (sensitivity) layers per product */
+  size_t nTangents() const { return (tangentVega_ ? 1 : 0) + (tangentRho_ ? 1 : 0); }
+
+  /** Builds the derivatives of the explicit and implicit operators in the tangent parameters */
+  void buildTangentOperators(GridAxis const& grax, ptrdiff_t step, double DT);
+
+  /** Computes the boundary values of the layers at the end of the (possibly fractional) step of length DT
+      that ends the step with index step, from the asymptotic values of the products */
+  void updateBoundaryValues(ptrdiff_t step, double DT);
+
+  /** Adds to the explicit step of layer j the terms of the boundary values */
+  void addBoundaryTerms(size_t j);
+
+  /** Sets the values on the edge nodes after the implicit step */
+  void setBoundaryValues();
+
+  /** Solves one step for the prices and the tangent layers */
+  void solveWithTangents();
+
+  /** Returns theta from the prices at the same spot at the time steps 0, 1 and 2 */
+  double theta(double v0, double v1, double v2) const;
+
+  /** Stores the prices and Greeks at the output spots */
+  void storeSpotResults();
+
+
   //state
   DeltaOp1D<Vector> deltaOpExplicit_, deltaOpImplicit_;
   GammaOp1D<Vector> gammaOpExplicit_, gammaOpImplicit_;
@@ -69,6 +173,35 @@ protected:
   Matrix values1, values2;  // each row corresponds to a spot node, each column to a variable
   Matrix* prevValues, * currValues;
 
+  std::vector<SPtrProduct> spprods_;  // the products, one per layer
+  SPtrPde1DResultsSink spsink_;       // optional, receives the grid values at each time step
+
+  // the coefficients for which the cached operators were built
+  double cachedDT_, cachedTheta_;
+  Vector cachedDrifts_, cachedVariances_;
+
+  PdeParams::ExerciseMethod exerciseMethod_;
+  std::vector<ptrdiff_t> exerciseIndex_;  // for each time step, the index of the next fixing
+  Matrix nextStepValues_[2];          // the price layers at the first two time steps after 0, for theta
+  Vector lowerBound_, upperBound_;    // the exercise bounds of a layer at the current step
+
+  bool tangentVega_, tangentRho_;
+  // the derivatives of the operators, (1 - theta) * DT * dA and theta * DT * dA, one per tangent
+  TridiagonalOp1D<Vector> tangentOpsExplicit_[2], tangentOpsImplicit_[2];
+  double stepLength_;                 // the length of the current time step, for the rho of the discounting
+
+  Vector outputSpots_;                // the spots for the prices and Greeks of storeSpotResults
+  bool outputGreeks_;
+
+  PdeParams::BoundaryCondition boundaryCondition_;
+  double boundaryWeight_;             // the edge values are boundaryWeight_ times the next interior values,
+  Vector lowBoundary_, highBoundary_; // plus these terms, one per layer
+  ptrdiff_t boundaryStep_;            // the step and the end time of the last (fractional) step solved
+  double boundaryTime_;
+
+  bool cashLayer_;                    // true for the two-layer formulation, with the cash part in the second layer
+  double creditSpread_;
+
 };
 
 END_NAMESPACE(orf)
@@ -0,0 +1,265 @@
+/**
+@file  pde2dsolver.cpp
+@brief Implementation of the 2-dim ADI PDE solver class
+*/
+
+#include <orflib/methods/pde/pde2dsolver.hpp>
+#include <cmath>
+#include <algorithm>
+
+BEGIN_NAMESPACE(orf)
+
+/** Ctor */
+Pde2DSolver::Pde2DSolver(SPtrProduct product,
+                         SPtrYieldCurve discountYieldCurve,
+                         std::vector<double> const& spots,
+                         std::vector<double> const& divyields,
+                         std::vector<double> const& vols,
+                         double correlation,
+                         Pde2DResults& results,
+                         size_t nThreads)
+: PdeBase(product, discountYieldCurve, spots,
+          std::vector<SPtrYieldCurve>(spots.size(), discountYieldCurve), divyields, vols),
+  results_(results), correlation_(correlation), adiScheme_(PdeParams::AdiScheme::CRAIG_SNEYD),
+  pool_(nThreads)
+{
+  ORF_ASSERT(nAssets_ == 2, "Pde2DSolver: the product must depend on two assets!");
+  ORF_ASSERT(correlation >= -1.0 && correlation <= 1.0, "Pde2DSolver: the correlation must be in [-1, 1]!");
+  nLayers_ = 1;  // one variable, the value of the product
+}
+
+/** Initializes the grid axes and keeps the ADI scheme */
+void Pde2DSolver::initGrid(double T, PdeParams const& params)
+{
+  adiScheme_ = params.adiScheme;
+  PdeBase::initGrid(T, params);
+}
+
+/** Solves backwards from one time step to the previous.
+    With the directional operators A0, A1 and the mixed operator A2, the Douglas scheme is
+      Y0 = V + DT * (A0 + A1 + A2) V
+      (I - theta * DT * A0) Y1 = Y0 - theta * DT * A0 V
+      (I - theta * DT * A1) Y2 = Y1 - theta * DT * A1 V
+    and Craig-Sneyd repeats the implicit sweeps from Y0 + 0.5 * DT * A2 (Y2 - V).
+*/
+void Pde2DSolver::solveFromStepToStep(ptrdiff_t step, double DT)
+{
+  axisOps_[0].update(gridAxes_[0], DT, theta_);
+  axisOps_[1].update(gridAxes_[1], DT, theta_);
+  updateCrossCoefficients(DT);
+
+  // the explicit terms, all from the values at the later time
+  size_t n0 = gridAxes_[0].NX, n1 = gridAxes_[1].NX;
+  applyExplicit0(values_, exp0_);
+  applyExplicit1(values_, exp1_);
+  applyMixed(values_, mixed_);
+
+  // the predictor
+  pool_.run(n1, [&](size_t begin, size_t end, size_t) {
+    for (size_t j = begin + 1; j <= end; ++j) {
+      double const* v = values_.colptr(j);
+      double const* e0 = exp0_.colptr(j);
+      double const* e1 = exp1_.colptr(j);
+      double const* m = mixed_.colptr(j);
+      double* y = y0_.colptr(j);
+      for (size_t i = 1; i <= n0; ++i)
+        y[i] = v[i] + e0[i] + e1[i] + m[i];
+    }
+  });
+
+  implicitSweeps(y0_, values_);
+  applyBoundaryConditions2D(values_);
+
+  if (adiScheme_ == PdeParams::AdiScheme::CRAIG_SNEYD && correlation_ != 0.0) {
+    // correct the predictor with the mixed term at the Douglas solution, and sweep again
+    applyMixed(values_, mixed2_);
+    y0_ += 0.5 * (mixed2_ - mixed_);
+    implicitSweeps(y0_, values_);
+    applyBoundaryConditions2D(values_);
+  }
+}
+
+/** Runs the two implicit sweeps. The lines of a sweep are solved all together, a block of lines per thread,
+    with the innermost loops across the lines: the lines of axis 1 are the rows of the matrices,
+    and the lines of axis 0 the rows of the transposed matrices.
+*/
+void Pde2DSolver::implicitSweeps(Matrix const& y0, Matrix& res)
+{
+  size_t n0 = gridAxes_[0].NX, n1 = gridAxes_[1].NX;
+  double theta = theta_;
+
+  // along axis 0, on the transposed right hand sides
+  pool_.run(n1, [&](size_t begin, size_t end, size_t) {
+    for (size_t j = begin + 1; j <= end; ++j) {
+      double const* y = y0.colptr(j);
+      double const* e0 = exp0_.colptr(j);
+      double* y1 = y1_.colptr(j);
+      for (size_t i = 1; i <= n0; ++i)
+        y1[i] = y[i] - theta * e0[i];
+    }
+  });
+  y1T_ = y1_.t();
+  TridiagonalOp1D<Vector> const& op0 = axisOps_[0].opImplicit;
+  pool_.run(n1, [&](size_t begin, size_t end, size_t) {
+    op0.applyFactorizedInverseToRows(y1T_, begin + 1, end + 1);
+  });
+  res.submat(1, 1, n0, n1) = y1T_.submat(1, 1, n1, n0).t();
+
+  // along axis 1, in place
+  TridiagonalOp1D<Vector> const& op1 = axisOps_[1].opImplicit;
+  pool_.run(n0, [&](size_t begin, size_t end, size_t) {
+    for (size_t j = 1; j <= n1; ++j) {
+      double const* e1 = exp1_.colptr(j);
+      double* y2 = res.colptr(j);
+      for (size_t i = begin + 1; i <= end; ++i)
+        y2[i] -= theta * e1[i];
+    }
+    op1.applyFactorizedInverseToRows(res, begin + 1, end + 1);
+  });
+}
+
+/** Applies the explicit operator of axis 0 on the columns */
+void Pde2DSolver::applyExplicit0(Matrix const& vals, Matrix& res)
+{
+  size_t n0 = gridAxes_[0].NX, n1 = gridAxes_[1].NX;
+  TridiagonalOp1D<Vector> const& op = axisOps_[0].opExplicit;
+  pool_.run(n1, [&](size_t begin, size_t end, size_t) {
+    for (size_t j = begin + 1; j <= end; ++j) {
+      Vector const line(const_cast<double*>(vals.colptr(j)), n0 + 2, false, true);
+      Vector out(res.colptr(j), n0 + 2, false, true);
+      op.apply(line, out);
+    }
+  });
+}
+
+/** Applies the explicit operator of axis 1 on the rows */
+void Pde2DSolver::applyExplicit1(Matrix const& vals, Matrix& res)
+{
+  size_t n0 = gridAxes_[0].NX;
+  TridiagonalOp1D<Vector> const& op = axisOps_[1].opExplicit;
+  pool_.run(n0, [&](size_t begin, size_t end, size_t) {
+    op.applyToRows(vals, res, begin + 1, end + 1);
+  });
+}
+
+/** Applies the mixed derivative term, with the central difference stencil on the four diagonal neighbours */
+void Pde2DSolver::applyMixed(Matrix const& vals, Matrix& res)
+{
+  size_t n0 = gridAxes_[0].NX, n1 = gridAxes_[1].NX;
+  if (correlation_ == 0.0) {
+    res.zeros();
+    return;
+  }
+  pool_.run(n1, [&](size_t begin, size_t end, size_t) {
+    for (size_t j = begin + 1; j <= end; ++j) {
+      double const* vm = vals.colptr(j - 1);
+      double const* vp = vals.colptr(j + 1);
+      double const* c = crossCoeffs_.colptr(j - 1);
+      double* r = res.colptr(j);
+      for (size_t i = 1; i <= n0; ++i)
+        r[i] = c[i - 1] * (vp[i + 1] - vm[i + 1] - vp[i - 1] + vm[i - 1]);
+    }
+  });
+}
+
+/** Computes DT * rho * vol0 * vol1 divided by the widths of the mixed derivative stencil */
+void Pde2DSolver::updateCrossCoefficients(double DT)
+{
+  GridAxis const& grax0 = gridAxes_[0];
+  GridAxis const& grax1 = gridAxes_[1];
+  size_t n0 = grax0.NX, n1 = grax1.NX;
+  Vector c0(n0);
+  for (size_t i = 0; i < n0; ++i)
+    c0[i] = grax0.vols[i] / (grax0.Xlevels[i + 2] - grax0.Xlevels[i]);
+  for (size_t j = 0; j < n1; ++j) {
+    double c1 = DT * correlation_ * grax1.vols[j] / (grax1.Xlevels[j + 2] - grax1.Xlevels[j]);
+    double* c = crossCoeffs_.colptr(j);
+    for (size_t i = 0; i < n0; ++i)
+      c[i] = c1 * c0[i];
+  }
+}
+
+/** Extrapolates to the boundary nodes, first along axis 0 then along axis 1, which also sets the corners */
+void Pde2DSolver::applyBoundaryConditions2D(Matrix& vals)
+{
+  GridAxis const& grax0 = gridAxes_[0];
+  GridAxis const& grax1 = gridAxes_[1];
+  if (grax0.uniform)
+    applyBoundaryConditions(vals);
+  else
+    applyBoundaryConditions(vals, grax0.Xlevels);
+
+  size_t n = grax1.NX;
+  double wLow = 1.0, wHigh = 1.0;
+  if (!grax1.uniform) {
+    Vector const& X = grax1.Xlevels;
+    wLow = (X[1] - X[0]) / (X[2] - X[1]);
+    wHigh = (X[n + 1] - X[n]) / (X[n] - X[n - 1]);
+  }
+  for (size_t i = 0; i < vals.n_rows; ++i) {
+    vals(i, 0) = vals(i, 1) + wLow * (vals(i, 1) - vals(i, 2));
+    vals(i, n + 1) = vals(i, n) + wHigh * (vals(i, n) - vals(i, n - 1));
+  }
+}
+
+/** Initializes the layers (grid functions) */
+void Pde2DSolver::initValLayers()
+{
+  ORF_ASSERT(nFactors() == 2, "Pde2DSolver: handles 2 assets only!");
+  size_t n0 = gridAxes_[0].NX, n1 = gridAxes_[1].NX;
+  ORF_ASSERT(n0 >= 3 && n1 >= 3, "Pde2DSolver: need at least 3 spot nodes per axis!");
+  values_.zeros(n0 + 2, n1 + 2);
+  y0_.zeros(n0 + 2, n1 + 2);
+  y1_.zeros(n0 + 2, n1 + 2);
+  y1T_.zeros(n1 + 2, n0 + 2);
+  exp0_.zeros(n0 + 2, n1 + 2);
+  exp1_.zeros(n0 + 2, n1 + 2);
+  mixed_.zeros(n0 + 2, n1 + 2);
+  mixed2_.zeros(n0 + 2, n1 + 2);
+  crossCoeffs_.zeros(n0, n1);
+
+  // the grid and theta may have changed since the last solve
+  for (auto& ops : axisOps_)
+    ops.reset();
+
+  results_.times = Vector(timesteps_);
+}
+
+/** Evaluates the product at the passed-in time step index */
+void Pde2DSolver::evalProduct(size_t stepIdx)
+{
+  ptrdiff_t eventIdx = stepindex_[stepIdx];
+  if (eventIdx >= 0)             // product event, must evaluate
+    spprod_->evalOnGrid2D(eventIdx, gridAxes_[0].Slevels, gridAxes_[1].Slevels, values_);
+}
+
+/** Stores the solver results, with the price interpolated bilinearly at the spots */
+void Pde2DSolver::storeResults()
+{
+  results_.gridAxes = gridAxes_;
+  results_.values = values_;
+
+  size_t idx[2];
+  double w[2];
+  for (size_t k = 0; k < 2; ++k) {
+    Vector const& X = gridAxes_[k].Xlevels;
+    double X0 = gridAxes_[k].coordinateChange->fromRealToDiffused(spots_[k]);
+    size_t i = std::upper_bound(X.begin(), X.end(), X0) - X.begin();
+    i = std::min(std::max(i, size_t(1)), size_t(X.size() - 1)) - 1;
+    idx[k] = i;
+    w[k] = (X0 - X[i]) / (X[i + 1] - X[i]);
+  }
+  size_t i = idx[0], j = idx[1];
+  results_.prices.resize(1);
+  results_.prices[0] = (1.0 - w[0]) * ((1.0 - w[1]) * values_(i, j) + w[1] * values_(i, j + 1))
+                     + w[0] * ((1.0 - w[1]) * values_(i + 1, j) + w[1] * values_(i + 1, j + 1));
+}
+
+/** Discounts the grid functions on the current time step, by applying
+    the passed-in one-step discount factor. */
+void Pde2DSolver::discountFromStepToStep(double df)
+{
+  values_ *= df;
+}
+
+END_NAMESPACE(orf)
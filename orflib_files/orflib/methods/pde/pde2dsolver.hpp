@@ -0,0 +1,94 @@
+/**
+@file  pde2dsolver.hpp
+@brief Definition of the 2-dim ADI PDE solver class
+*/
+
+#ifndef ORF_PDE2DSOLVER_HPP
+#define ORF_PDE2DSOLVER_HPP
+
+#include <orflib/methods/pde/pdebase.hpp>
+#include <orflib/methods/pde/adioperators.hpp>
+#include <orflib/methods/pde/pderesults.hpp>
+#include <orflib/methods/pde/workerpool.hpp>
+
+BEGIN_NAMESPACE(orf)
+
+/** The 2-d pde solver class, for products on two correlated assets.
+    It steps back in time with an alternating direction implicit (ADI) scheme, Douglas or Craig-Sneyd
+    as selected in PdeParams::adiScheme: the mixed derivative term is explicit, and each direction is
+    made implicit in turn by tridiagonal solves along the grid lines of that direction.
+    The line solves of a sweep are independent and run on a pool of threads.
+    With theta = 0.5 Craig-Sneyd is second order in time, Douglas only when the correlation is zero.
+*/
+class Pde2DSolver : public PdeBase
+{
+public:
+  /** Ctor; nThreads is the number of threads for the line solves, 0 for the hardware threads */
+  Pde2DSolver(SPtrProduct product,
+              SPtrYieldCurve discountYieldCurve,
+              std::vector<double> const& spots,
+              std::vector<double> const& divyields,
+              std::vector<double> const& vols,
+              double correlation,
+              Pde2DResults& results,
+              size_t nThreads = 0);
+
+  /** Dtor */
+  virtual ~Pde2DSolver() override {}
+
+  /** Initializes the grid axes and keeps the ADI scheme of params */
+  virtual void initGrid(double T, PdeParams const& params) override;
+
+  /** Solves backwards from one time step to the previous */
+  virtual void solveFromStepToStep(ptrdiff_t step, double DT) override;
+
+  /** Initializes the layers */
+  virtual void initValLayers() override;
+
+  /** Evaluates the product at the passed-in time step index */
+  virtual void evalProduct(size_t stepIdx) override;
+
+  /** Stores the solver results */
+  virtual void storeResults() override;
+
+  /** Discounts the grid functions on the current time step, by applying
+      the passed-in one-step discount factor. */
+  virtual void discountFromStepToStep(double df) override;
+
+protected:
+  /** Computes the coefficients of the mixed derivative term for this step */
+  void updateCrossCoefficients(double DT);
+
+  /** Sets res to the explicit operator of axis 0 applied to vals, on the interior nodes */
+  void applyExplicit0(Matrix const& vals, Matrix& res);
+
+  /** Same as above for axis 1 */
+  void applyExplicit1(Matrix const& vals, Matrix& res);
+
+  /** Sets res to the mixed derivative term applied to vals, on the interior nodes */
+  void applyMixed(Matrix const& vals, Matrix& res);
+
+  /** Runs the two implicit sweeps from the predictor y0; the result goes to the interior nodes of res */
+  void implicitSweeps(Matrix const& y0, Matrix& res);
+
+  /** Sets the values on the boundary nodes by extrapolation along both axes */
+  void applyBoundaryConditions2D(Matrix& vals);
+
+  //state
+  Pde2DResults& results_;
+  double correlation_;
+  PdeParams::AdiScheme adiScheme_;
+  WorkerPool pool_;
+
+  AdiAxisOperators axisOps_[2];
+  Matrix crossCoeffs_;              // the mixed term coefficients on the interior nodes
+
+  Matrix values_;                   // each row corresponds to a node of axis 0, each column to a node of axis 1
+  Matrix y0_, y1_, y1T_;            // the predictor and the right hand sides of the sweep along axis 0
+  Matrix exp0_, exp1_, mixed_;      // the explicit directional and mixed terms applied to values_
+  Matrix mixed2_;                   // the mixed term applied to the Douglas result, for Craig-Sneyd
+};
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_PDE2DSOLVER_HPP
@@ -4,17 +4,41 @@
 */
 
 #include <orflib/methods/pde/pdebase.hpp>
+#include <orflib/methods/pde/workerpool.hpp>
+#include <algorithm>
+#include <cmath>
 
 BEGIN_NAMESPACE(orf)
 
 /** The entry point for every PDE solver
 */
 void PdeBase::solve(PdeParams const& params)
+{
+  initSolve(params);
+
+  // evaluate the product at maturity
+  evalProduct(nSteps_ - 1);
+
+  // the main loop
+  propagate(nSteps_ - 1, 0, params);
+  storeResults();
+}
+
+/** Sets up the time steps, the grid, the coefficients and the value layers */
+void PdeBase::initSolve(PdeParams const& params)
 {
   // store the Theta
   theta_ = params.theta;
+  stepFraction_ = 1.0;
   // get the time steps
-  spprod_->timeSteps(params.nTimeSteps, timesteps_, stepindex_);
+  if (!fixedTimesteps_.empty()) {
+    timesteps_ = fixedTimesteps_;
+    stepindex_ = fixedStepindex_;
+  }
+  else if (params.adaptiveTimeSteps)
+    spprod_->adaptiveTimeSteps(params.nTimeSteps, timesteps_, stepindex_);
+  else
+    spprod_->timeSteps(params.nTimeSteps, timesteps_, stepindex_);
   nSteps_ = timesteps_.size();
 
   // set the alignment values to the corresponding spots
@@ -26,7 +50,7 @@ void PdeBase::solve(PdeParams const& params)
 
   // compute the conditional forward factors from step to step
   // the row index is the time, the column index is the asset
-  Matrix fwdFactors(nSteps_, nAssets_);
+  fwdFactors_.set_size(nSteps_, nAssets_);
   for (size_t j = 0; j < nAssets_; ++j) {
     SPtrYieldCurve spyc = spaccrycs_[j];
     double divyld = divyields_[j];
@@ -34,33 +58,50 @@ void PdeBase::solve(PdeParams const& params)
       double T1 = timesteps_[i];
       double T2 = timesteps_[i + 1];
       double fwdRate = spyc->fwdRate(T1, T2);
-      fwdFactors(i, j) = exp((fwdRate - divyld) * (T2 - T1));
+      fwdFactors_(i, j) = exp((fwdRate - divyld) * (T2 - T1));
     }
   }
 
   // compute the forward vols from step to step
-  Matrix fwdVols(nSteps_, nAssets_);
+  fwdVols_.set_size(nSteps_, nAssets_);
   for (size_t j = 0; j < nAssets_; ++j) {
     for (size_t i = 0; i < nSteps_ - 1; ++i) {
     double T1 = timesteps_[i];
     double T2 = timesteps_[i + 1];
-    fwdVols(i, j) = vols_[j];
+    fwdVols_(i, j) = vols_[j];
     }
   }
 
+  // tabulate the local vols on the grid, if any
+  initLocalVols();
+
   // initialize the value layers (grid functions, one per variable to solve)
   initValLayers();
+}
 
-  // evaluate the product at maturity
-  evalProduct(nSteps_ - 1);
-
-  // the main loop
-  for (ptrdiff_t stepIdx = nSteps_ - 2; stepIdx >= 0; --stepIdx) {
-    updateGrid(params, fwdFactors, fwdVols, stepIdx);
-
-    // solve
+/** Steps back from the time step with index fromIdx to the one with index toIdx */
+void PdeBase::propagate(size_t fromIdx, size_t toIdx, PdeParams const& params)
+{
+  ORF_ASSERT(fromIdx < nSteps_ && toIdx <= fromIdx, "PdeBase: invalid time step indices to propagate!");
+  size_t nSmooth = params.nRannacherSteps;
+  for (ptrdiff_t stepIdx = ptrdiff_t(fromIdx) - 1; stepIdx >= ptrdiff_t(toIdx); --stepIdx) {
     double dT = timesteps_[stepIdx + 1] - timesteps_[stepIdx];
-    solveFromStepToStep(stepIdx, dT);
+    if (isSmoothedStep(stepIdx, nSmooth)) {
+      // Rannacher smoothing: two fully implicit half steps damp the oscillations that
+      // Crank-Nicolson produces from the kinks of the payoff
+      double theta = theta_;
+      theta_ = 1.0;
+      stepFraction_ = 0.5;
+      updateGrid(params, fwdFactors_, fwdVols_, stepIdx);
+      solveFromStepToStep(stepIdx, 0.5 * dT);
+      solveFromStepToStep(stepIdx, 0.5 * dT);
+      theta_ = theta;
+      stepFraction_ = 1.0;
+    }
+    else {
+      updateGrid(params, fwdFactors_, fwdVols_, stepIdx);
+      solveFromStepToStep(stepIdx, dT);
+    }
 
     // discount
     double df = spdiscyc_->fwdDiscount(timesteps_[stepIdx], timesteps_[stepIdx + 1]);
@@ -69,7 +110,77 @@ void PdeBase::solve(PdeParams const& params)
     // eval product for next iteration
     evalProduct(stepIdx);
   }
-  storeResults();
+}
+
+/** Overrides the time steps of the product */
+void PdeBase::setTimeSteps(std::vector<double> const& timesteps, std::vector<ptrdiff_t> const& stepindex)
+{
+  ORF_ASSERT(timesteps.size() == stepindex.size(), "PdeBase: need one step index per time step!");
+  ORF_ASSERT(timesteps.empty() || timesteps.size() >= 2, "PdeBase: need at least two time steps!");
+  fixedTimesteps_ = timesteps;
+  fixedStepindex_ = stepindex;
+}
+
+/** Checks if the step from stepIdx + 1 to stepIdx follows a product event by at most nSmooth steps,
+    with no events in between, i.e. if it is solved by Rannacher half steps
+*/
+bool PdeBase::isSmoothedStep(ptrdiff_t stepIdx, size_t nSmooth) const
+{
+  ptrdiff_t last = std::min(stepIdx + ptrdiff_t(nSmooth), ptrdiff_t(nSteps_) - 1);
+  for (ptrdiff_t s = stepIdx + 1; s <= last; ++s)
+    if (startsRannacher(s, nSmooth))
+      return true;
+  return false;
+}
+
+/** Sets the local volatility surface of an asset */
+void PdeBase::setLocalVolSurface(SPtrLocalVolSurface splocalvol, size_t assetIdx, size_t nThreads)
+{
+  ORF_ASSERT(assetIdx < nAssets_, "PdeBase: invalid asset index for the local volatility surface!");
+  splocalvols_.resize(nAssets_);
+  splocalvols_[assetIdx] = splocalvol;
+  localVolThreads_ = nThreads;
+}
+
+/** Tabulates the local vols at the interior nodes and at the middle of the time steps */
+void PdeBase::initLocalVols()
+{
+  localVols_.assign(nAssets_, Matrix());
+  for (size_t assetIdx = 0; assetIdx < splocalvols_.size(); ++assetIdx) {
+    SPtrLocalVolSurface splv = splocalvols_[assetIdx];
+    if (!splv)
+      continue;
+    GridAxis const& grax = gridAxes_[assetIdx];
+    Vector logSpots = arma::log(grax.Slevels.subvec(1, grax.NX));
+    Matrix& table = localVols_[assetIdx];
+    table.set_size(grax.NX, nSteps_ - 1);
+    // the steps are independent, each thread fills a block of columns
+    size_t nThreads = localVolThreads_ > 0 ? localVolThreads_ : std::max(1u, std::thread::hardware_concurrency());
+    WorkerPool pool(std::min(nThreads, nSteps_ - 1));
+    pool.run(nSteps_ - 1, [&](size_t begin, size_t end, size_t) {
+      for (size_t i = begin; i < end; ++i) {
+        Vector vols(table.colptr(i), grax.NX, false, true);
+        splv->localVols(0.5 * (timesteps_[i] + timesteps_[i + 1]), logSpots, vols);
+      }
+    });
+  }
+}
+
+/** Checks if the product event at stepIdx is followed by nSmooth steps without events.
+    Products with events on (almost) every step, like American options, are thus smoothed only at expiration.
+*/
+bool PdeBase::startsRannacher(ptrdiff_t stepIdx, size_t nSmooth) const
+{
+  if (nSmooth == 0 || theta_ == 1.0 || stepindex_[stepIdx] < 0)
+    return false;
+  if (stepIdx == ptrdiff_t(nSteps_) - 1)   // always smooth the final payoff
+    return true;
+  if (stepIdx < ptrdiff_t(nSmooth))
+    return false;
+  for (ptrdiff_t i = stepIdx - 1; i >= stepIdx - ptrdiff_t(nSmooth); --i)
+    if (stepindex_[i] >= 0)
+      return false;
+  return true;
 }
 
 /** Initializes the grid axes, sets up the nodes and the bounds
@@ -113,16 +224,31 @@ void PdeBase::initGrid(double T, PdeParams const& params)
     // fill in the original and the transformed spot nodes
     grax.Xlevels.resize(params.nSpotNodes[i] + 2);  // add 2 for the boundary nodes
     grax.Slevels.resize(params.nSpotNodes[i] + 2);
-    for (size_t j = 0; j <= params.nSpotNodes[i] + 1; ++j) {
-      grax.Xlevels[j] = grax.Xmin + j * grax.DX;
-      grax.Slevels[j] = grax.coordinateChange->fromDiffusedToReal(grax.Xlevels[j]);
+    grax.uniform = i >= params.concentrationSpots.size() || params.concentrationSpots[i].empty();
+    if (grax.uniform) {
+      for (size_t j = 0; j <= params.nSpotNodes[i] + 1; ++j)
+        grax.Xlevels[j] = grax.Xmin + j * grax.DX;
     }
+    else {
+      // concentrate the nodes around the requested spots, keeping a node on the alignment value
+      std::vector<double> centers;
+      for (double S : params.concentrationSpots[i])
+        centers.push_back(grax.coordinateChange->fromRealToDiffused(S));
+      double width = params.concentrationWidths[i] * (grax.Xmax - grax.Xmin);
+      concentratedLevels(grax.Xmin, grax.Xmax, grax.NX, centers, width, alignValue, grax.Xlevels);
+    }
+    for (size_t j = 0; j <= params.nSpotNodes[i] + 1; ++j)
+      grax.Slevels[j] = grax.coordinateChange->fromDiffusedToReal(grax.Xlevels[j]);
 
     // resize the drift, variance and vol vectors
     // no need to add boundary points here
     grax.drifts.resize(params.nSpotNodes[i]);
     grax.variances.resize(params.nSpotNodes[i]);
     grax.vols.resize(params.nSpotNodes[i]);
+
+    // the coefficients depending only on the grid, so that updateGrid needs no coordinate changes
+    grax.coordinateChange->gridCoefficients(grax.Xlevels, grax.driftCoeffs,
+      grax.convexityCoeffs, grax.varianceCoeffs, grax.volCoeffs);
   }
 }
 
@@ -134,19 +260,45 @@ void PdeBase::updateGrid(PdeParams const& params,
 {
   double T1 = timesteps_[stepIdx];
   double T2 = timesteps_[stepIdx + 1];
-  double DT = T2 - T1;
+  double DT = (T2 - T1) * stepFraction_;
 
   for (size_t assetIdx = 0; assetIdx < nAssets_; ++assetIdx) {
-    for (size_t j = 1; j <= params.nSpotNodes[assetIdx]; ++j) {
-      GridAxis& grax = gridAxes_[assetIdx];
-      double RealS = grax.Slevels[j];
-      double aCoeff = fwdFactors(stepIdx, assetIdx);
-      double RealF = RealS * aCoeff;
-      //changed for step localvol
-      double RealLNvol = fvols(stepIdx, assetIdx);
-      // set the drift, variance and vol values for this time step
-      grax.coordinateChange->driftAndVariance(RealS, RealF, theta_, DT, RealLNvol,
-        aCoeff, grax.DX, grax.drifts[j - 1], grax.variances[j - 1], grax.vols[j - 1]);
+    GridAxis& grax = gridAxes_[assetIdx];
+    double aCoeff = fwdFactors(stepIdx, assetIdx);
+    if (stepFraction_ != 1.0)   // the forward factor over the fraction of the step
+      aCoeff = std::pow(aCoeff, stepFraction_);
+    double RealLNvol = fvols(stepIdx, assetIdx);
+    bool localVol = !localVols_.empty() && !localVols_[assetIdx].empty();
+    // the factors common to all nodes, see CoordinateChangeBase::gridCoefficients
+    double driftFactor = (aCoeff - 1.0) / ((theta_ * aCoeff + 1.0 - theta_) * DT);
+    double varFactor = RealLNvol * RealLNvol;
+    double convFactor = 0.5 * varFactor;
+
+    // set the drift, variance and vol values for this time step
+    size_t n = params.nSpotNodes[assetIdx];
+    double const* dc = grax.driftCoeffs.memptr();
+    double const* cc = grax.convexityCoeffs.memptr();
+    double const* vc = grax.varianceCoeffs.memptr();
+    double const* sc = grax.volCoeffs.memptr();
+    double* drifts = grax.drifts.memptr();
+    double* variances = grax.variances.memptr();
+    double* vols = grax.vols.memptr();
+    if (localVol) {
+      // one streaming pass over the column of the local vols of this step
+      double const* lv = localVols_[assetIdx].colptr(stepIdx);
+      for (size_t j = 0; j < n; ++j) {
+        double var = lv[j] * lv[j];
+        drifts[j] = driftFactor * dc[j] - 0.5 * var * cc[j];
+        variances[j] = var * vc[j];
+        vols[j] = lv[j] * sc[j];
+      }
+    }
+    else {
+      for (size_t j = 0; j < n; ++j) {
+        drifts[j] = driftFactor * dc[j] - convFactor * cc[j];
+        variances[j] = varFactor * vc[j];
+        vols[j] = RealLNvol * sc[j];
+      }
     }
   }
 }
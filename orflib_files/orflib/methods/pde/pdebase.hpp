@@ -11,6 +11,7 @@
 #include <orflib/products/product.hpp>
 #include <orflib/market/yieldcurve.hpp>
 #include <orflib/market/volatilitytermstructure.hpp>
+#include <orflib/market/localvolsurface.hpp>
 
 #include <vector>
 
@@ -59,9 +60,38 @@ public:
     gridAxes_.resize(nEq);
   }
 
+  /** Sets the local volatility surface of the asset with index assetIdx, replacing its constant volatility
+      in the drifts and variances; the constant volatility still sets the range of the grid axis.
+      The local vols at the nodes are tabulated once per solve, for all steps, on nThreads threads,
+      0 for the hardware threads. The default of one thread suits the solvers run concurrently,
+      e.g. by solvePde1DBatch or solvePde1DParareal, which would otherwise oversubscribe the cores.
+      A null surface restores the constant volatility.
+  */
+  void setLocalVolSurface(SPtrLocalVolSurface splocalvol, size_t assetIdx = 0, size_t nThreads = 1);
+
   /** The entry point for the solver; this is the method that the client needs to call */
   void solve(PdeParams const& params);
 
+  /** Sets the time steps and, for each, the index of the product fixing on it or -1, replacing those
+      of the product, e.g. to solve on a subset of the steps of another solver; empty vectors restore them */
+  void setTimeSteps(std::vector<double> const& timesteps, std::vector<ptrdiff_t> const& stepindex);
+
+  /** The first part of solve(): sets up the time steps, the grid, the coefficients and the value layers */
+  void initSolve(PdeParams const& params);
+
+  /** The main loop of solve(): steps back from the time step with index fromIdx to the one with index toIdx,
+      from the values at fromIdx after the product evaluation there, and evaluates the product on each step.
+      Solving in pieces gives the same values as solving at once, so that the pieces may start from values
+      computed elsewhere, e.g. by a parallel in time method. Call initSolve() first.
+  */
+  void propagate(size_t fromIdx, size_t toIdx, PdeParams const& params);
+
+  /** The time steps set up by initSolve() */
+  std::vector<double> const& timeSteps() const { return timesteps_; }
+
+  /** For each time step set up by initSolve(), the index of the product fixing on it, or -1 */
+  std::vector<ptrdiff_t> const& stepIndices() const { return stepindex_; }
+
   /** Initializes the grid axes, sets up the nodes and the bounds */
   virtual void initGrid(double T, PdeParams const& params);
 
@@ -94,11 +124,24 @@ protected:
   /** Ctor from product; inherited classes must set the other market data */
   PdeBase(SPtrProduct product) : spprod_(product) {}
 
+  /** Returns true if the Rannacher smoothing must start after the product event at stepIdx,
+      i.e. if the next nSmooth steps backwards are free of product events */
+  bool startsRannacher(ptrdiff_t stepIdx, size_t nSmooth) const;
+
+  /** Returns true if the step from stepIdx + 1 to stepIdx is solved by Rannacher half steps,
+      i.e. if one of the nSmooth steps after it starts the smoothing */
+  bool isSmoothedStep(ptrdiff_t stepIdx, size_t nSmooth) const;
+
+  /** Tabulates the local vols of the assets with a local volatility surface at the interior nodes
+      of their grid axes, at the middle of each time step */
+  void initLocalVols();
+
   // state
   size_t nSteps_;                     // number of times steps
   size_t nAssets_;                    // number of assets to diffuse
   size_t nLayers_;                    // number of PDE variables being solved on the same grid
   double theta_;
+  double stepFraction_;               // the fraction of the time step being solved, less than 1 for Rannacher half steps
 
   SPtrProduct spprod_;                       // the product being priced
   SPtrYieldCurve spdiscyc_;                  // the discounting yield curve 
@@ -106,12 +149,21 @@ protected:
   std::vector<SPtrYieldCurve> spaccrycs_;    // the accrual yield curve (used for forward calculation)
   std::vector<double> divyields_;            // the dividend yields for each asset
   std::vector<double> vols_;                 // the volatility for each asset
+  std::vector<SPtrLocalVolSurface> splocalvols_;  // the local volatility surface for each asset, or null
+  size_t localVolThreads_ = 1;               // the number of threads tabulating the local vols
 
   std::vector<GridAxis> gridAxes_;  // the grid axes
   std::vector<double> spotAxis_;
   std::vector<double> alignments_;  // one value per axis at which a grid node must pass through
   std::vector<double> timesteps_;   // the vector of time steps
   std::vector<ptrdiff_t> stepindex_;      // the vector of time step indices; of >= 0, product must be evaluated
+  std::vector<double> fixedTimesteps_;    // the time steps set by setTimeSteps(), if any
+  std::vector<ptrdiff_t> fixedStepindex_;
+  Matrix fwdFactors_;                     // the forward factors from step to step, one column per asset
+  Matrix fwdVols_;                        // the forward vols from step to step, one column per asset
+  // for each asset with a local volatility surface, the local vols with one row per interior node
+  // and one column per time step, so that updateGrid reads one contiguous column per step
+  std::vector<Matrix> localVols_;
 
 };
 
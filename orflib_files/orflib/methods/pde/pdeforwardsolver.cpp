@@ -0,0 +1,269 @@
+/**
+@file  pdeforwardsolver.cpp
+@brief Implementation of the forward (Dupire) PDE solver class
+*/
+
+#include <orflib/methods/pde/pdeforwardsolver.hpp>
+#include <orflib/math/interpol/interpolation1d.hpp>
+#include <cmath>
+#include <algorithm>
+
+BEGIN_NAMESPACE(orf)
+
+/** Ctor */
+PdeForwardSolver::PdeForwardSolver(SPtrYieldCurve discountYieldCurve,
+                                   double spot,
+                                   double divyield,
+                                   double vol,
+                                   std::vector<double> const& strikes,
+                                   std::vector<double> const& maturities,
+                                   PdeForwardResults& results)
+: results_(results), spdiscyc_(discountYieldCurve), spot_(spot), divyield_(divyield), vol_(vol),
+  strikes_(strikes), maturities_(maturities), theta_(0.5), stepFraction_(1.0),
+  cachedDT_(0.0), cachedTheta_(0.0), currValues_(nullptr), nextValues_(nullptr)
+{
+  ORF_ASSERT(spdiscyc_, "PdeForwardSolver: null yield curve!");
+  ORF_ASSERT(spot > 0.0, "PdeForwardSolver: the spot must be positive!");
+  ORF_ASSERT(vol > 0.0, "PdeForwardSolver: the volatility must be positive!");
+  ORF_ASSERT(!strikes.empty(), "PdeForwardSolver: need at least one strike!");
+  ORF_ASSERT(!maturities.empty(), "PdeForwardSolver: need at least one maturity!");
+  for (size_t j = 0; j < maturities.size(); ++j)
+    ORF_ASSERT(maturities[j] > (j == 0 ? 0.0 : maturities[j - 1]),
+               "PdeForwardSolver: the maturities must be positive and increasing!");
+}
+
+/** The entry point for the solver */
+void PdeForwardSolver::solve(PdeParams const& params)
+{
+  ORF_ASSERT(params.nSpotNodes.size() == 1, "PdeForwardSolver: need the parameters of one axis!");
+  theta_ = params.theta;
+  stepFraction_ = 1.0;
+  timeSteps(params.nTimeSteps);
+  initGrid(maturities_.back(), params);
+
+  // the prices at time 0, averaged over the cell of the node on the spot, where they have a kink
+  size_t n = grax_.NX;
+  values1_.set_size(n + 2, 1);
+  values2_.zeros(n + 2, 1);
+  for (size_t i = 0; i < n + 2; ++i)
+    values1_(i, 0) = std::max(spot_ - grax_.Slevels[i], 0.0);
+  size_t i0 = std::lower_bound(grax_.Slevels.begin(), grax_.Slevels.end(), spot_) - grax_.Slevels.begin();
+  if (i0 > 0 && i0 <= n) {
+    double Km = std::exp(0.5 * (grax_.Xlevels[i0 - 1] + grax_.Xlevels[i0]));
+    double Kp = std::exp(0.5 * (grax_.Xlevels[i0] + grax_.Xlevels[i0 + 1]));
+    values1_(i0, 0) = 0.5 * (spot_ - Km) * (spot_ - Km) / (Kp - Km);
+  }
+  currValues_ = &values1_; nextValues_ = &values2_;
+  cachedDT_ = 0.0;
+
+  results_.gridAxes.assign(1, grax_);
+  results_.times = Vector(timesteps_);
+  results_.strikes = strikes_;
+  results_.maturities = maturities_;
+  results_.callPrices.set_size(strikes_.size(), maturities_.size());
+  results_.values.set_size(n + 2, maturities_.size());
+
+  // the main loop, forward in time
+  size_t nSmooth = params.nRannacherSteps;
+  for (size_t stepIdx = 0; stepIdx + 1 < timesteps_.size(); ++stepIdx) {
+    double T1 = timesteps_[stepIdx], T2 = timesteps_[stepIdx + 1];
+    double dT = T2 - T1;
+    if (stepIdx < nSmooth && theta_ != 1.0) {
+      // Rannacher smoothing of the kink of the initial prices, by two fully implicit half steps
+      double theta = theta_;
+      theta_ = 1.0;
+      stepFraction_ = 0.5;
+      updateGrid(T1, T2, 0.5 * dT);
+      solveFromStepToStep(0.5 * dT);
+      solveFromStepToStep(0.5 * dT);
+      stepFraction_ = 1.0;
+      theta_ = theta;
+    }
+    else {
+      updateGrid(T1, T2, dT);
+      solveFromStepToStep(dT);
+    }
+    // the dividend term, exactly
+    *currValues_ *= std::exp(-divyield_ * dT);
+
+    if (matindex_[stepIdx + 1] >= 0)
+      storeMaturity(matindex_[stepIdx + 1]);
+  }
+}
+
+/** Sets up the strike axis up to the last maturity T */
+void PdeForwardSolver::initGrid(double T, PdeParams const& params)
+{
+  grax_.NX = params.nSpotNodes[0];
+  ORF_ASSERT(grax_.NX >= 3, "PdeForwardSolver: need at least 3 nodes!");
+
+  // the bounds around the spot and the forward to T, as for the backward solvers
+  double forward = spot_ * std::exp((spdiscyc_->spotRate(T) - divyield_) * T);
+  grax_.coordinateChange->init(params);
+  double X0 = grax_.coordinateChange->fromRealToDiffused(spot_);
+  double forwardX = forward;
+  double volX = vol_;
+  grax_.coordinateChange->forwardAndVariance(forwardX, volX, T);
+  grax_.coordinateChange->bounds(X0, forwardX, volX, T, params.nStdDevs[0], grax_.Xmin, grax_.Xmax);
+  grax_.DX = (grax_.Xmax - grax_.Xmin) / (grax_.NX + 1);
+
+  // align the grid axis so that a node passes through the spot
+  int X0NodeIdx = int(0.5 + (X0 - grax_.Xmin) / grax_.DX);
+  double closestX = grax_.Xmin + X0NodeIdx * grax_.DX;
+  grax_.Xmin -= closestX - X0;
+  grax_.Xmax -= closestX - X0;
+
+  grax_.Xlevels.resize(grax_.NX + 2);
+  grax_.Slevels.resize(grax_.NX + 2);
+  grax_.uniform = params.concentrationSpots.empty() || params.concentrationSpots[0].empty();
+  if (grax_.uniform) {
+    for (size_t j = 0; j <= grax_.NX + 1; ++j)
+      grax_.Xlevels[j] = grax_.Xmin + j * grax_.DX;
+  }
+  else {
+    // concentrate the nodes around the requested strikes, keeping a node on the spot
+    std::vector<double> centers;
+    for (double K : params.concentrationSpots[0])
+      centers.push_back(grax_.coordinateChange->fromRealToDiffused(K));
+    double width = params.concentrationWidths[0] * (grax_.Xmax - grax_.Xmin);
+    concentratedLevels(grax_.Xmin, grax_.Xmax, grax_.NX, centers, width, X0, grax_.Xlevels);
+  }
+  for (size_t j = 0; j <= grax_.NX + 1; ++j)
+    grax_.Slevels[j] = grax_.coordinateChange->fromDiffusedToReal(grax_.Xlevels[j]);
+
+  for (size_t k = 0; k < strikes_.size(); ++k)
+    ORF_ASSERT(strikes_[k] >= grax_.Slevels[0] && strikes_[k] <= grax_.Slevels[grax_.NX + 1],
+               "PdeForwardSolver: the strikes must lie within the grid!");
+
+  grax_.drifts.resize(grax_.NX);
+  grax_.variances.resize(grax_.NX);
+  grax_.vols.resize(grax_.NX);
+  grax_.coordinateChange->gridCoefficients(grax_.Xlevels, grax_.driftCoeffs,
+    grax_.convexityCoeffs, grax_.varianceCoeffs, grax_.volCoeffs);
+  if (splocalvol_) {
+    logStrikes_ = arma::log(grax_.Slevels.subvec(1, grax_.NX));
+    localVols_.set_size(grax_.NX);
+  }
+}
+
+/** Sets up the time steps, with about nTimeSteps steps up to the last maturity, all maturities on steps */
+void PdeForwardSolver::timeSteps(size_t nTimeSteps)
+{
+  ORF_ASSERT(nTimeSteps > 0, "PdeForwardSolver: need at least one time step!");
+  double Tmax = maturities_.back();
+  timesteps_.assign(1, 0.0);
+  matindex_.assign(1, -1);
+  double Tprev = 0.0;
+  for (size_t j = 0; j < maturities_.size(); ++j) {
+    double Tmat = maturities_[j];
+    size_t nsteps = std::max(size_t(1), size_t(0.5 + nTimeSteps * (Tmat - Tprev) / Tmax));
+    for (size_t i = 1; i < nsteps; ++i) {
+      timesteps_.push_back(Tprev + (Tmat - Tprev) * i / nsteps);
+      matindex_.push_back(-1);
+    }
+    timesteps_.push_back(Tmat);
+    matindex_.push_back(j);
+    Tprev = Tmat;
+  }
+}
+
+/** Updates the drifts and the variances of the strike axis for the step from T1 to T2,
+    with the local vols, if any, at the middle of the step as in PdeBase::initLocalVols */
+void PdeForwardSolver::updateGrid(double T1, double T2, double DT)
+{
+  // In log-strike the Dupire equation for C * exp(q * T) has the drift -(r - q) K in strike space.
+  // With the forward factor a over the step, the drift factor below makes the theta scheme
+  // reproduce exactly the decay exp(-(r - q) * DT) of the prices linear in the strike.
+  double fwdRate = spdiscyc_->fwdRate(T1, T2);
+  double aCoeff = std::exp((fwdRate - divyield_) * DT);
+  double driftFactor = -(aCoeff - 1.0) / ((theta_ + (1.0 - theta_) * aCoeff) * DT);
+  if (splocalvol_) {
+    splocalvol_->localVols(0.5 * (T1 + T2), logStrikes_, localVols_);
+    for (size_t j = 0; j < grax_.NX; ++j) {
+      double var = localVols_[j] * localVols_[j];
+      grax_.drifts[j] = driftFactor * grax_.driftCoeffs[j] - 0.5 * var * grax_.convexityCoeffs[j];
+      grax_.variances[j] = var * grax_.varianceCoeffs[j];
+      grax_.vols[j] = localVols_[j] * grax_.volCoeffs[j];
+    }
+    return;
+  }
+  double varFactor = vol_ * vol_;
+  for (size_t j = 0; j < grax_.NX; ++j) {
+    grax_.drifts[j] = driftFactor * grax_.driftCoeffs[j] - 0.5 * varFactor * grax_.convexityCoeffs[j];
+    grax_.variances[j] = varFactor * grax_.varianceCoeffs[j];
+    grax_.vols[j] = vol_ * grax_.volCoeffs[j];
+  }
+}
+
+/** Solves forward from time T to T + DT */
+void PdeForwardSolver::solveFromStepToStep(double DT)
+{
+  buildOperators(DT);
+  auto v1 = currValues_->col(0);
+  auto v2 = nextValues_->col(0);
+  opExplicit_.apply(v1, v2);
+  opImplicit_.applyFactorizedInverse(v2, v1);
+  if (grax_.uniform)
+    applyBoundaryConditions(*currValues_);
+  else
+    applyBoundaryConditions(*currValues_, grax_.Xlevels);
+}
+
+/** Builds the explicit and implicit operators and factorizes the implicit one, if the coefficients changed */
+void PdeForwardSolver::buildOperators(double DT)
+{
+  // relative tolerance, to absorb the round-off in time steps computed as differences of times
+  const double tol = 1.0e-12;
+  auto close = [tol](double a, double b) {
+    return std::abs(a - b) <= tol * std::max(std::abs(a), std::abs(b));
+  };
+  bool same = cachedDT_ != 0.0 && close(DT, cachedDT_) && cachedTheta_ == theta_ &&
+              cachedDrifts_.size() == grax_.drifts.size() && cachedVariances_.size() == grax_.variances.size();
+  for (size_t i = 0; same && i < grax_.drifts.size(); ++i)
+    same = close(grax_.drifts[i], cachedDrifts_[i]) && close(grax_.variances[i], cachedVariances_[i]);
+  if (same)
+    return;
+
+  if (grax_.uniform) {
+    deltaOpExplicit_.init(grax_.drifts, DT, grax_.DX, 1.0 - theta_);
+    deltaOpImplicit_.init(grax_.drifts, DT, grax_.DX, theta_);
+    gammaOpExplicit_.init(grax_.variances, DT, grax_.DX, 1.0 - theta_);
+    gammaOpImplicit_.init(grax_.variances, DT, grax_.DX, theta_);
+  }
+  else {
+    deltaOpExplicit_.init(grax_.drifts, DT, grax_.Xlevels, 1.0 - theta_);
+    deltaOpImplicit_.init(grax_.drifts, DT, grax_.Xlevels, theta_);
+    gammaOpExplicit_.init(grax_.variances, DT, grax_.Xlevels, 1.0 - theta_);
+    gammaOpImplicit_.init(grax_.variances, DT, grax_.Xlevels, theta_);
+  }
+  opExplicit_.init(grax_.NX, 0.0, 1.0, 0.0);
+  opExplicit_ += deltaOpExplicit_;
+  opExplicit_ += gammaOpExplicit_;
+  opImplicit_.init(grax_.NX, 0.0, 1.0, 0.0);
+  opImplicit_ -= deltaOpImplicit_;
+  opImplicit_ -= gammaOpImplicit_;
+
+  // the prices are linear in the strike at both ends of the grid
+  if (grax_.uniform)
+    adjustOpsForBoundaryConditions(opExplicit_, opImplicit_, grax_.DX);
+  else
+    adjustOpsForBoundaryConditions(opExplicit_, opImplicit_, grax_.Xlevels);
+  opImplicit_.factorize();
+
+  cachedDT_ = DT;
+  cachedTheta_ = theta_;
+  cachedDrifts_ = grax_.drifts;
+  cachedVariances_ = grax_.variances;
+}
+
+/** Stores the call prices at the maturity with index matIdx */
+void PdeForwardSolver::storeMaturity(size_t matIdx)
+{
+  Vector prices(currValues_->col(0));
+  results_.values.col(matIdx) = prices;
+  CubicInterpolation1D<Vector> interp(grax_.Xlevels, prices);
+  for (size_t k = 0; k < strikes_.size(); ++k)
+    results_.callPrices(k, matIdx) = interp.getValue(grax_.coordinateChange->fromRealToDiffused(strikes_[k]));
+}
+
+END_NAMESPACE(orf)
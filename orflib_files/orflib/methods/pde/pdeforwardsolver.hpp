@@ -0,0 +1,104 @@
+/**
+@file  pdeforwardsolver.hpp
+@brief Definition of the forward (Dupire) PDE solver class for European call prices
+*/
+
+#ifndef ORF_PDEFORWARDSOLVER_HPP
+#define ORF_PDEFORWARDSOLVER_HPP
+
+#include <orflib/methods/pde/tridiagonalops1d.hpp>
+#include <orflib/methods/pde/pderesults.hpp>
+#include <orflib/methods/pde/pdeparams.hpp>
+#include <orflib/market/yieldcurve.hpp>
+#include <orflib/market/localvolsurface.hpp>
+
+#include <vector>
+
+BEGIN_NAMESPACE(orf)
+
+/** The forward pde solver class.
+    It solves the Dupire equation for the prices C(K, T) of European calls as functions of the strike K
+    and the maturity T, forward in time from C(K, 0) = max(S0 - K, 0):
+      dC/dT = 0.5 * sigma^2 * K^2 * d2C/dK2 - (r - q) * K * dC/dK - q * C
+    on a grid in log-strike, so that one sweep prices all strikes and all maturities.
+    The grid axis is set up as for the backward solvers, with params.nSpotNodes[0] nodes around the spot,
+    and params.nTimeSteps steps up to the last maturity. The spot is on a node; the kink of the initial
+    prices is smoothed by averaging them over the cell of that node, and by params.nRannacherSteps
+    fully implicit half steps at the start.
+    As for the backward solver, the drift coefficients make the scheme exact for prices linear in the strike,
+    e.g. for the prices of deep in the money calls.
+    Put prices follow from the call prices by put-call parity.
+    With a local volatility surface, sigma is the local vol at the strike K and the time T.
+*/
+class PdeForwardSolver
+{
+public:
+  /** Ctor; the strikes and the maturities at which the results hold the call prices */
+  PdeForwardSolver(SPtrYieldCurve discountYieldCurve,
+                   double spot,
+                   double divyield,
+                   double vol,
+                   std::vector<double> const& strikes,
+                   std::vector<double> const& maturities,
+                   PdeForwardResults& results);
+
+  /** Dtor */
+  virtual ~PdeForwardSolver() {}
+
+  /** Sets the local volatility surface, replacing the constant volatility in the variances;
+      the constant volatility still sets the range of the grid axis.
+      A null surface restores the constant volatility.
+  */
+  void setLocalVolSurface(SPtrLocalVolSurface splocalvol) { splocalvol_ = splocalvol; }
+
+  /** The entry point for the solver */
+  void solve(PdeParams const& params);
+
+protected:
+  /** Sets up the strike axis up to the last maturity T */
+  virtual void initGrid(double T, PdeParams const& params);
+
+  /** Sets up the time steps, with about nTimeSteps steps up to the last maturity, all maturities on steps */
+  void timeSteps(size_t nTimeSteps);
+
+  /** Updates the drifts and the variances of the strike axis for the step from T1 to T2,
+      with the length DT of the (possibly fractional) step being solved */
+  virtual void updateGrid(double T1, double T2, double DT);
+
+  /** Solves forward from time T to T + DT */
+  void solveFromStepToStep(double DT);
+
+  /** Builds the explicit and implicit operators and factorizes the implicit one, if the coefficients changed */
+  void buildOperators(double DT);
+
+  /** Stores the call prices at the maturity with index matIdx */
+  void storeMaturity(size_t matIdx);
+
+  //state
+  PdeForwardResults& results_;
+  SPtrYieldCurve spdiscyc_;
+  double spot_, divyield_, vol_;
+  Vector strikes_, maturities_;
+  SPtrLocalVolSurface splocalvol_;    // the local volatility surface, or null
+
+  GridAxis grax_;                     // the axis in log-strike
+  Vector logStrikes_, localVols_;     // the logs of the strikes at the interior nodes and their local vols
+  std::vector<double> timesteps_;
+  std::vector<ptrdiff_t> matindex_;   // for each time step, the index of the maturity on it, or -1
+  double theta_;
+  double stepFraction_;               // the fraction of the time step being solved, less than 1 for Rannacher half steps
+
+  DeltaOp1D<Vector> deltaOpExplicit_, deltaOpImplicit_;
+  GammaOp1D<Vector> gammaOpExplicit_, gammaOpImplicit_;
+  TridiagonalOp1D<Vector> opExplicit_, opImplicit_;
+  // the coefficients for which the operators were built
+  double cachedDT_, cachedTheta_;
+  Vector cachedDrifts_, cachedVariances_;
+
+  Matrix values1_, values2_;          // one column, the call prices on the strike nodes
+  Matrix* currValues_, * nextValues_;
+};
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_PDEFORWARDSOLVER_HPP
@@ -10,6 +10,8 @@
 #include <orflib/math/matrix.hpp>
 #include <memory>
 #include <algorithm>
+#include <cmath>
+#include <vector>
 
 BEGIN_NAMESPACE(orf)
 
@@ -54,6 +56,19 @@ public:
                       double nstds,
                       double& Xmin,
                       double& Xmax) = 0;
+
+  /** Computes the per-node coefficients of driftAndVariance that depend only on the grid,
+      for the interior nodes Xlevels[1] ... Xlevels[n], which need not be equally spaced.
+      With the forward factor a, corr = theta * a + 1 - theta and the lognormal vol sigma,
+      the drift, variance and vol at node i are
+        driftCoeffs[i] * (a - 1) / (corr * DT) - 0.5 * sigma^2 * convexityCoeffs[i],
+        sigma^2 * varianceCoeffs[i] and sigma * volCoeffs[i].
+  */
+  virtual void gridCoefficients(Vector const& Xlevels,
+                                Vector& driftCoeffs,
+                                Vector& convexityCoeffs,
+                                Vector& varianceCoeffs,
+                                Vector& volCoeffs) = 0;
 };
 
 
@@ -105,6 +120,26 @@ public:
     Xmin = std::min(S0, F) * exp(-0.5 * vol * vol * T - nstds * vol * sqrt(T));
     Xmax = std::max(S0, F) * exp(-0.5 * vol * vol * T + nstds * vol * sqrt(T));
   }
+
+  virtual void gridCoefficients(Vector const& Xlevels,
+                                Vector& driftCoeffs,
+                                Vector& convexityCoeffs,
+                                Vector& varianceCoeffs,
+                                Vector& volCoeffs)
+  {
+    size_t n = Xlevels.size() - 2;
+    driftCoeffs.resize(n);
+    convexityCoeffs.resize(n);
+    varianceCoeffs.resize(n);
+    volCoeffs.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      double realS = Xlevels[i + 1];
+      driftCoeffs[i] = realS;
+      convexityCoeffs[i] = 0.0;
+      varianceCoeffs[i] = realS * realS;
+      volCoeffs[i] = realS;
+    }
+  }
 };
 
 /** Logarithmic coordinate change, i.e. Diffused = log(Real) */
@@ -159,6 +194,33 @@ public:
     variance = realLNVol * realLNVol;
     finalVol = realLNVol;
   }
+
+  virtual void gridCoefficients(Vector const& Xlevels,
+                                Vector& driftCoeffs,
+                                Vector& convexityCoeffs,
+                                Vector& varianceCoeffs,
+                                Vector& volCoeffs)
+  {
+    size_t n = Xlevels.size() - 2;
+    driftCoeffs.resize(n);
+    convexityCoeffs.resize(n);
+    varianceCoeffs.resize(n);
+    volCoeffs.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      // the finite difference Jacobian and convexity, with the same stencils as the pde operators,
+      // as in driftAndVariance; on a uniform grid hL = hR = DX
+      double Xi = Xlevels[i + 1];
+      double hL = Xi - Xlevels[i], hR = Xlevels[i + 2] - Xi;
+      double realS = fromDiffusedToReal(Xi);
+      double SL = fromDiffusedToReal(Xi - hL), SR = fromDiffusedToReal(Xi + hR);
+      double Deltaip1 = (hL * hL * (SR - realS) + hR * hR * (realS - SL)) / (hL * hR * (hL + hR));
+      double Gammaip1 = 2.0 * (hL * (SR - realS) - hR * (realS - SL)) / (hL * hR * (hL + hR));
+      driftCoeffs[i] = realS / Deltaip1;
+      convexityCoeffs[i] = Gammaip1 / Deltaip1;
+      varianceCoeffs[i] = 1.0;
+      volCoeffs[i] = 1.0;
+    }
+  }
 };
 
 
@@ -167,15 +229,18 @@ public:
 class GridAxis
 {
 public:
-  double Xmin, Xmax, DX;    // max, min and distance between nodes
+  double Xmin, Xmax, DX;    // max, min and distance between nodes (average distance if not uniform)
   size_t NX;                // number of interior nodes
+  bool uniform;             // true if the nodes are equally spaced in the diffused coordinate
   Vector Xlevels, Slevels;
   Vector drifts, variances, vols;
+  // the per-node coefficients of the drifts, variances and vols, set once per grid by initGrid
+  Vector driftCoeffs, convexityCoeffs, varianceCoeffs, volCoeffs;
   std::shared_ptr<CoordinateChangeBase> coordinateChange;  // the coordinate change rules for this axis
 
   /** Default ctor uses logarithmic coordinate changes */
   GridAxis()
-    : coordinateChange(new LogCoordinateChange())
+    : uniform(true), coordinateChange(new LogCoordinateChange())
   {}
 
   /** Sets the coordinate changes */
@@ -185,6 +250,93 @@ public:
   }
 };
 
+/** Computes NX + 2 nodes between Xmin and Xmax, concentrated around the points centers.
+    The node density is proportional to the sum over the centers c of 1 / sqrt(width^2 + (X - c)^2),
+    so that with one center the nodes follow the sinh stretching X = c + width * sinh(a + b * k).
+    The smaller the width, the stronger the concentration.
+    A node is placed exactly on Xalign, and each center within the bounds is placed half way between two nodes,
+    by stretching the mapping linearly between them; this keeps the kinks of the payoffs, which are typically
+    at the centers, off the nodes. Centers closer than one node to Xalign or to each other are skipped.
+*/
+inline
+void concentratedLevels(double Xmin,
+                        double Xmax,
+                        size_t NX,
+                        std::vector<double> const& centers,
+                        double width,
+                        double Xalign,
+                        Vector& Xlevels)
+{
+  ORF_ASSERT(!centers.empty(), "concentratedLevels: need at least one concentration point!");
+  ORF_ASSERT(width > 0.0, "concentratedLevels: the concentration width must be positive!");
+  ORF_ASSERT(Xmin < Xalign && Xalign < Xmax, "concentratedLevels: the alignment point must be within the bounds!");
+
+  // the cumulative node density and its derivative
+  auto cumDensity = [&](double X) {
+    double F = 0.0;
+    for (double c : centers)
+      F += std::asinh((X - c) / width) - std::asinh((Xmin - c) / width);
+    return F;
+  };
+  auto density = [&](double X) {
+    double f = 0.0;
+    for (double c : centers)
+      f += 1.0 / std::sqrt(width * width + (X - c) * (X - c));
+    return f;
+  };
+  double Ftot = cumDensity(Xmax);
+
+  // the fixed points of the mapping: the bounds and the alignment point on nodes,
+  // the centers half way between two nodes, as pairs of (fractional node index, X)
+  std::vector<std::pair<double, double>> pinned;
+  pinned.push_back(std::make_pair(0.0, Xmin));
+  pinned.push_back(std::make_pair(double(NX + 1), Xmax));
+  double k0 = std::floor(0.5 + cumDensity(Xalign) / Ftot * (NX + 1));
+  pinned.push_back(std::make_pair(std::min(std::max(k0, 1.0), double(NX)), Xalign));
+  for (double c : centers) {
+    if (c <= Xmin || c >= Xmax)
+      continue;
+    double k = std::floor(cumDensity(c) / Ftot * (NX + 1)) + 0.5;
+    k = std::min(std::max(k, 0.5), NX + 0.5);
+    bool taken = false;
+    for (auto const& kp : pinned)
+      taken = taken || std::abs(kp.first - k) < 1.0;
+    if (!taken)
+      pinned.push_back(std::make_pair(k, c));
+  }
+  std::sort(pinned.begin(), pinned.end());
+
+  Xlevels.resize(NX + 2);
+  Xlevels[0] = Xmin;
+  size_t m = 0;
+  double X = Xmin;
+  for (size_t k = 1; k <= NX; ++k) {
+    while (pinned[m + 1].first <= k)
+      ++m;
+    if (pinned[m].first == k) {
+      X = Xlevels[k] = pinned[m].second;
+      continue;
+    }
+    // the target cumulative density, linear in the node index between the fixed points
+    double k1 = pinned[m].first, k2 = pinned[m + 1].first;
+    double u1 = cumDensity(pinned[m].second), u2 = cumDensity(pinned[m + 1].second);
+    double target = u1 + (u2 - u1) * (k - k1) / (k2 - k1);
+    // invert the cumulative density by Newton steps, safeguarded by bisection,
+    // starting from the previous node
+    double lo = X, hi = pinned[m + 1].second;
+    for (int iter = 0; iter < 100; ++iter) {
+      double F = cumDensity(X) - target;
+      if (std::abs(F) <= 1.0e-14 * Ftot)
+        break;
+      if (F < 0.0) lo = X; else hi = X;
+      double Xnew = X - F / density(X);
+      X = (Xnew > lo && Xnew < hi) ? Xnew : 0.5 * (lo + hi);
+    }
+    Xlevels[k] = X;
+  }
+  Xlevels[NX + 1] = Xmax;
+}
+
 END_NAMESPACE(orf)
 
 #endif  // #ifndef ORF_PDEGRID_HPP
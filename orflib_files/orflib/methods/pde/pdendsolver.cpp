@@ -0,0 +1,342 @@
+/**
+@file  pdendsolver.cpp
+@brief Implementation of the N-dim ADI PDE solver class
+*/
+
+#include <orflib/methods/pde/pdendsolver.hpp>
+#include <cmath>
+#include <algorithm>
+
+BEGIN_NAMESPACE(orf)
+
+/** Ctor */
+PdeNDSolver::PdeNDSolver(SPtrProduct product,
+                         SPtrYieldCurve discountYieldCurve,
+                         std::vector<double> const& spots,
+                         std::vector<double> const& divyields,
+                         std::vector<double> const& vols,
+                         Matrix const& correlations,
+                         PdeNDResults& results,
+                         size_t nThreads)
+: PdeBase(product, discountYieldCurve, spots,
+          std::vector<SPtrYieldCurve>(spots.size(), discountYieldCurve), divyields, vols),
+  results_(results), correlations_(correlations), adiScheme_(PdeParams::AdiScheme::CRAIG_SNEYD),
+  pool_(nThreads), nNodes_(0)
+{
+  ORF_ASSERT(nAssets_ >= 1, "PdeNDSolver: the product must depend on at least one asset!");
+  ORF_ASSERT(correlations_.n_rows == nAssets_ && correlations_.n_cols == nAssets_,
+             "PdeNDSolver: the correlation matrix must have one row and one column per asset!");
+  for (size_t k = 0; k < nAssets_; ++k) {
+    ORF_ASSERT(correlations_(k, k) == 1.0, "PdeNDSolver: the correlations of the assets with themselves must be 1!");
+    for (size_t l = 0; l < k; ++l) {
+      double rho = correlations_(k, l);
+      ORF_ASSERT(rho == correlations_(l, k), "PdeNDSolver: the correlation matrix must be symmetric!");
+      ORF_ASSERT(rho >= -1.0 && rho <= 1.0, "PdeNDSolver: the correlations must be in [-1, 1]!");
+    }
+  }
+  nLayers_ = 1;  // one variable, the value of the product
+}
+
+/** Initializes the grid axes and keeps the ADI scheme */
+void PdeNDSolver::initGrid(double T, PdeParams const& params)
+{
+  adiScheme_ = params.adiScheme;
+  PdeBase::initGrid(T, params);
+}
+
+/** Solves backwards from one time step to the previous.
+    With the directional operators A1 ... AN and the mixed operator A0, the Douglas scheme is
+      Y0 = V + DT * (A0 + A1 + ... + AN) V
+      (I - theta * DT * Ak) Yk = Yk-1 - theta * DT * Ak V,  k = 1 ... N
+    and Craig-Sneyd repeats the implicit sweeps from Y0 + 0.5 * DT * A0 (YN - V), as in Pde2DSolver.
+*/
+void PdeNDSolver::solveFromStepToStep(ptrdiff_t step, double DT)
+{
+  size_t nDims = nAssets_;
+  for (size_t k = 0; k < nDims; ++k)
+    axisOps_[k].update(gridAxes_[k], DT, theta_);
+  updateCrossCoefficients(DT);
+
+  // the explicit terms, all from the values at the later time, and the predictor
+  for (size_t k = 0; k < nDims; ++k)
+    applyExplicit(k, values_, explicit_[k]);
+  applyMixed(values_, mixed_);
+  y0_ = values_ + mixed_;
+  for (size_t k = 0; k < nDims; ++k)
+    y0_ += explicit_[k];
+
+  implicitSweeps(y0_, values_);
+  applyBoundaryConditionsND(values_);
+
+  if (adiScheme_ == PdeParams::AdiScheme::CRAIG_SNEYD && !crossPairs_.empty()) {
+    // correct the predictor with the mixed terms at the Douglas solution, and sweep again
+    applyMixed(values_, mixed2_);
+    y0_ += 0.5 * (mixed2_ - mixed_);
+    implicitSweeps(y0_, values_);
+    applyBoundaryConditionsND(values_);
+  }
+}
+
+/** Runs the implicit sweeps, one axis after the other */
+void PdeNDSolver::implicitSweeps(Vector const& y0, Vector& res)
+{
+  res = y0;
+  for (size_t k = 0; k < nAssets_; ++k) {
+    res -= theta_ * explicit_[k];
+    solveAlongAxis(k, res);
+  }
+}
+
+/** Solves the implicit systems of axis k. Seen as a matrix with one row per index of the axes before k,
+    the values of a block with fixed indices of the axes after k hold the lines of axis k in their rows,
+    so the lines of a block are solved all together as in Pde2DSolver; the lines of axis 0 are the columns,
+    which are transposed into rows first. The lines through the boundary nodes of the other axes are solved
+    too, since they are contiguous with the others; their values are then replaced by the boundary conditions.
+*/
+void PdeNDSolver::solveAlongAxis(size_t k, Vector& vals)
+{
+  size_t N = gridAxes_[k].NX + 2;
+  size_t s = strides_[k];
+  size_t nBlocks = nNodes_ / (s * N);
+  TridiagonalOp1D<Vector> const& op = axisOps_[k].opImplicit;
+
+  if (k == 0) {
+    Matrix lines(vals.memptr(), N, nBlocks, false, true);
+    linesT_ = lines.t();
+    pool_.run(nBlocks, [&](size_t begin, size_t end, size_t) {
+      op.applyFactorizedInverseToRows(linesT_, begin, end);
+    });
+    lines = linesT_.t();
+  }
+  else if (nBlocks > 1) {
+    pool_.run(nBlocks, [&](size_t begin, size_t end, size_t) {
+      for (size_t b = begin; b < end; ++b) {
+        Matrix block(vals.memptr() + b * s * N, s, N, false, true);
+        op.applyFactorizedInverseToRows(block, 0, s);
+      }
+    });
+  }
+  else {
+    // the last axis, one block split by rows
+    Matrix block(vals.memptr(), s, N, false, true);
+    pool_.run(s, [&](size_t begin, size_t end, size_t) {
+      op.applyFactorizedInverseToRows(block, begin, end);
+    });
+  }
+}
+
+/** Applies the explicit operator of axis k, on the same blocks as solveAlongAxis */
+void PdeNDSolver::applyExplicit(size_t k, Vector const& vals, Vector& res)
+{
+  size_t N = gridAxes_[k].NX + 2;
+  size_t s = strides_[k];
+  size_t nBlocks = nNodes_ / (s * N);
+  TridiagonalOp1D<Vector> const& op = axisOps_[k].opExplicit;
+  double* in = const_cast<double*>(vals.memptr());
+
+  if (k == 0) {
+    pool_.run(nBlocks, [&](size_t begin, size_t end, size_t) {
+      for (size_t b = begin; b < end; ++b) {
+        Vector const line(in + b * N, N, false, true);
+        Vector out(res.memptr() + b * N, N, false, true);
+        op.apply(line, out);
+      }
+    });
+  }
+  else if (nBlocks > 1) {
+    pool_.run(nBlocks, [&](size_t begin, size_t end, size_t) {
+      for (size_t b = begin; b < end; ++b) {
+        Matrix const block(in + b * s * N, s, N, false, true);
+        Matrix out(res.memptr() + b * s * N, s, N, false, true);
+        op.applyToRows(block, out, 0, s);
+      }
+    });
+  }
+  else {
+    Matrix const block(in, s, N, false, true);
+    Matrix out(res.memptr(), s, N, false, true);
+    pool_.run(s, [&](size_t begin, size_t end, size_t) {
+      op.applyToRows(block, out, begin, end);
+    });
+  }
+}
+
+/** Runs f on the interior lines of axis 0, decoding the node indices of the other axes from the line index */
+void PdeNDSolver::forInteriorLines(std::function<void(size_t base, std::vector<size_t> const& node)> const& f)
+{
+  size_t nDims = nAssets_;
+  size_t nLines = 1;
+  for (size_t k = 1; k < nDims; ++k)
+    nLines *= gridAxes_[k].NX;
+  pool_.run(nLines, [&](size_t begin, size_t end, size_t) {
+    std::vector<size_t> node(nDims, 0);
+    for (size_t q = begin; q < end; ++q) {
+      size_t rem = q, base = 0;
+      for (size_t k = 1; k < nDims; ++k) {
+        size_t n = gridAxes_[k].NX;
+        node[k] = 1 + rem % n;
+        rem /= n;
+        base += node[k] * strides_[k];
+      }
+      f(base, node);
+    }
+  });
+}
+
+/** Applies the mixed derivative terms, with the central difference stencil on the four diagonal neighbours
+    in the plane of each pair of correlated axes */
+void PdeNDSolver::applyMixed(Vector const& vals, Vector& res)
+{
+  res.zeros();
+  if (crossPairs_.empty())
+    return;
+  size_t n0 = gridAxes_[0].NX;
+  double const* v = vals.memptr();
+  double* r = res.memptr();
+  forInteriorLines([&](size_t base, std::vector<size_t> const& node) {
+    for (size_t c = 0; c < crossPairs_.size(); ++c) {
+      size_t k = crossPairs_[c].first, l = crossPairs_[c].second;
+      size_t sk = strides_[k], sl = strides_[l];
+      double cl = crossFactors_[c] * crossCoeffs_[l][node[l] - 1];
+      if (k == 0) {
+        double const* ck = crossCoeffs_[0].memptr();
+        for (size_t i = 1; i <= n0; ++i) {
+          size_t p = base + i;
+          r[p] += cl * ck[i - 1] * (v[p + 1 + sl] - v[p + 1 - sl] - v[p - 1 + sl] + v[p - 1 - sl]);
+        }
+      }
+      else {
+        double ckl = cl * crossCoeffs_[k][node[k] - 1];
+        for (size_t i = 1; i <= n0; ++i) {
+          size_t p = base + i;
+          r[p] += ckl * (v[p + sk + sl] - v[p + sk - sl] - v[p - sk + sl] + v[p - sk - sl]);
+        }
+      }
+    }
+  });
+}
+
+/** Computes DT * rho for each pair of correlated axes, and the vols divided by the widths of the stencil */
+void PdeNDSolver::updateCrossCoefficients(double DT)
+{
+  if (crossPairs_.empty())
+    return;
+  for (size_t c = 0; c < crossPairs_.size(); ++c)
+    crossFactors_[c] = DT * correlations_(crossPairs_[c].first, crossPairs_[c].second);
+  for (size_t k = 0; k < nAssets_; ++k) {
+    GridAxis const& grax = gridAxes_[k];
+    for (size_t i = 0; i < grax.NX; ++i)
+      crossCoeffs_[k][i] = grax.vols[i] / (grax.Xlevels[i + 2] - grax.Xlevels[i]);
+  }
+}
+
+/** Extrapolates to the boundary nodes of each axis in turn, which also sets the edges and corners */
+void PdeNDSolver::applyBoundaryConditionsND(Vector& vals)
+{
+  double* v = vals.memptr();
+  for (size_t k = 0; k < nAssets_; ++k) {
+    GridAxis const& grax = gridAxes_[k];
+    size_t n = grax.NX, s = strides_[k];
+    size_t nBlocks = nNodes_ / (s * (n + 2));
+    double wLow = 1.0, wHigh = 1.0;
+    if (!grax.uniform) {
+      Vector const& X = grax.Xlevels;
+      wLow = (X[1] - X[0]) / (X[2] - X[1]);
+      wHigh = (X[n + 1] - X[n]) / (X[n] - X[n - 1]);
+    }
+    for (size_t b = 0; b < nBlocks; ++b) {
+      double* lo = v + b * s * (n + 2);
+      double* hi = lo + (n + 1) * s;
+      for (size_t r = 0; r < s; ++r) {
+        lo[r] = lo[r + s] + wLow * (lo[r + s] - lo[r + 2 * s]);
+        hi[r] = hi[r - s] + wHigh * (hi[r - s] - hi[r - 2 * s]);
+      }
+    }
+  }
+}
+
+/** Initializes the layers (grid functions) */
+void PdeNDSolver::initValLayers()
+{
+  size_t nDims = nAssets_;
+  ORF_ASSERT(nFactors() == nDims, "PdeNDSolver: one grid axis per asset!");
+  strides_.resize(nDims);
+  nNodes_ = 1;
+  spotLevels_.resize(nDims);
+  for (size_t k = 0; k < nDims; ++k) {
+    ORF_ASSERT(gridAxes_[k].NX >= 3, "PdeNDSolver: need at least 3 spot nodes per axis!");
+    strides_[k] = nNodes_;
+    nNodes_ *= gridAxes_[k].NX + 2;
+    spotLevels_[k] = gridAxes_[k].Slevels;
+  }
+  values_.zeros(nNodes_);
+  y0_.zeros(nNodes_);
+  explicit_.assign(nDims, Vector(nNodes_, arma::fill::zeros));
+  mixed_.zeros(nNodes_);
+  mixed2_.zeros(nNodes_);
+
+  // the grid and theta may have changed since the last solve
+  axisOps_.assign(nDims, AdiAxisOperators());
+
+  crossPairs_.clear();
+  for (size_t k = 0; k < nDims; ++k)
+    for (size_t l = k + 1; l < nDims; ++l)
+      if (correlations_(k, l) != 0.0)
+        crossPairs_.push_back(std::make_pair(k, l));
+  crossFactors_.assign(crossPairs_.size(), 0.0);
+  crossCoeffs_.resize(nDims);
+  for (size_t k = 0; k < nDims; ++k)
+    crossCoeffs_[k].zeros(gridAxes_[k].NX);
+
+  results_.times = Vector(timesteps_);
+}
+
+/** Evaluates the product at the passed-in time step index */
+void PdeNDSolver::evalProduct(size_t stepIdx)
+{
+  ptrdiff_t eventIdx = stepindex_[stepIdx];
+  if (eventIdx >= 0)             // product event, must evaluate
+    spprod_->evalOnGridND(eventIdx, spotLevels_, values_);
+}
+
+/** Stores the solver results, with the price interpolated multilinearly at the spots */
+void PdeNDSolver::storeResults()
+{
+  results_.gridAxes = gridAxes_;
+  results_.values = values_;
+
+  size_t nDims = nAssets_;
+  std::vector<size_t> idx(nDims);
+  std::vector<double> w(nDims);
+  for (size_t k = 0; k < nDims; ++k) {
+    Vector const& X = gridAxes_[k].Xlevels;
+    double X0 = gridAxes_[k].coordinateChange->fromRealToDiffused(spots_[k]);
+    size_t i = std::upper_bound(X.begin(), X.end(), X0) - X.begin();
+    i = std::min(std::max(i, size_t(1)), size_t(X.size() - 1)) - 1;
+    idx[k] = i;
+    w[k] = (X0 - X[i]) / (X[i + 1] - X[i]);
+  }
+  // the weighted values at the 2^N corners of the cell holding the spots
+  double price = 0.0;
+  for (size_t corner = 0; corner < (size_t(1) << nDims); ++corner) {
+    double weight = 1.0;
+    size_t p = 0;
+    for (size_t k = 0; k < nDims; ++k) {
+      bool up = (corner >> k) & 1;
+      weight *= up ? w[k] : 1.0 - w[k];
+      p += (idx[k] + (up ? 1 : 0)) * strides_[k];
+    }
+    price += weight * values_[p];
+  }
+  results_.prices.resize(1);
+  results_.prices[0] = price;
+}
+
+/** Discounts the grid functions on the current time step, by applying
+    the passed-in one-step discount factor. */
+void PdeNDSolver::discountFromStepToStep(double df)
+{
+  values_ *= df;
+}
+
+END_NAMESPACE(orf)
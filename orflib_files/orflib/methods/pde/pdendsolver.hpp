@@ -0,0 +1,111 @@
+/**
+@file  pdendsolver.hpp
+@brief Definition of the N-dim ADI PDE solver class
+*/
+
+#ifndef ORF_PDENDSOLVER_HPP
+#define ORF_PDENDSOLVER_HPP
+
+#include <orflib/methods/pde/pdebase.hpp>
+#include <orflib/methods/pde/adioperators.hpp>
+#include <orflib/methods/pde/pderesults.hpp>
+#include <orflib/methods/pde/workerpool.hpp>
+
+#include <functional>
+
+BEGIN_NAMESPACE(orf)
+
+/** The N-d pde solver class, for products on any number of correlated assets, e.g. baskets.
+    It extends the ADI schemes of Pde2DSolver to N directions: the mixed derivative terms of all the
+    pairs of correlated assets are explicit, and each direction is made implicit in turn by tridiagonal
+    solves along the grid lines of that direction, with the same axis operators as the 2-d solver.
+    The values are stored in one vector, with the index of the first axis running fastest.
+    The size of a full grid grows as the product of the axis sizes, so beyond three assets it is
+    meant for the small anisotropic grids of the sparse grid combination, see solvePdeSparseGrid().
+*/
+class PdeNDSolver : public PdeBase
+{
+public:
+  /** Ctor; the correlation matrix has one row and one column per asset,
+      nThreads is the number of threads for the line solves, 0 for the hardware threads */
+  PdeNDSolver(SPtrProduct product,
+              SPtrYieldCurve discountYieldCurve,
+              std::vector<double> const& spots,
+              std::vector<double> const& divyields,
+              std::vector<double> const& vols,
+              Matrix const& correlations,
+              PdeNDResults& results,
+              size_t nThreads = 0);
+
+  /** Dtor */
+  virtual ~PdeNDSolver() override {}
+
+  /** Initializes the grid axes and keeps the ADI scheme of params */
+  virtual void initGrid(double T, PdeParams const& params) override;
+
+  /** Solves backwards from one time step to the previous */
+  virtual void solveFromStepToStep(ptrdiff_t step, double DT) override;
+
+  /** Initializes the layers */
+  virtual void initValLayers() override;
+
+  /** Evaluates the product at the passed-in time step index */
+  virtual void evalProduct(size_t stepIdx) override;
+
+  /** Stores the solver results */
+  virtual void storeResults() override;
+
+  /** Discounts the grid functions on the current time step, by applying
+      the passed-in one-step discount factor. */
+  virtual void discountFromStepToStep(double df) override;
+
+protected:
+  /** Calls f on the lines along axis 0 through the interior nodes, with the flat index of the line start
+      and the node indices of the other axes, a block of lines per thread */
+  void forInteriorLines(std::function<void(size_t base, std::vector<size_t> const& node)> const& f);
+
+  /** Computes the coefficients of the mixed derivative terms for this step */
+  void updateCrossCoefficients(double DT);
+
+  /** Sets res to the explicit operator of axis k applied to vals */
+  void applyExplicit(size_t k, Vector const& vals, Vector& res);
+
+  /** Sets res to the sum of the mixed derivative terms applied to vals, on the interior nodes */
+  void applyMixed(Vector const& vals, Vector& res);
+
+  /** Solves in place the implicit systems of axis k along all the grid lines of that axis */
+  void solveAlongAxis(size_t k, Vector& vals);
+
+  /** Runs the implicit sweeps from the predictor y0 */
+  void implicitSweeps(Vector const& y0, Vector& res);
+
+  /** Sets the values on the boundary nodes by extrapolation along each axis in turn */
+  void applyBoundaryConditionsND(Vector& vals);
+
+  //state
+  PdeNDResults& results_;
+  Matrix correlations_;
+  PdeParams::AdiScheme adiScheme_;
+  WorkerPool pool_;
+
+  std::vector<AdiAxisOperators> axisOps_;
+  std::vector<size_t> strides_;       // for each axis, the distance between neighbours in the flat values
+  size_t nNodes_;                     // the number of nodes, boundaries included
+  std::vector<Vector> spotLevels_;    // the spot levels of each axis, for the product evaluation
+
+  // the pairs of correlated axes, with DT times their correlation, and for each axis
+  // the vols at the interior nodes divided by the widths of the mixed derivative stencil
+  std::vector<std::pair<size_t, size_t>> crossPairs_;
+  std::vector<double> crossFactors_;
+  std::vector<Vector> crossCoeffs_;
+
+  Vector values_;
+  Vector y0_;                         // the predictor
+  std::vector<Vector> explicit_;      // the explicit directional terms applied to values_, one per axis
+  Vector mixed_, mixed2_;             // the mixed terms applied to values_ and, for Craig-Sneyd, to the Douglas result
+  Matrix linesT_;                     // the lines of axis 0 as rows, for the sweeps along axis 0
+};
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_PDENDSOLVER_HPP
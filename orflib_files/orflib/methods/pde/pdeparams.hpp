@@ -13,13 +13,55 @@ BEGIN_NAMESPACE(orf)
 struct PdeParams
 {
 public:
+  /** The alternating direction implicit (ADI) schemes for the multi-dimensional solvers */
+  enum class AdiScheme
+  {
+    DOUGLAS,      // one predictor and one implicit correction per direction
+    CRAIG_SNEYD   // Douglas, followed by a second pass correcting the mixed derivative terms
+  };
+
+  /** The treatment of early exercise (American options, conversions, calls) in the 1-d solver */
+  enum class ExerciseMethod
+  {
+    EXPLICIT,           // the exercise value is applied after each step, by the product
+    BRENNAN_SCHWARTZ,   // the bounds are imposed in the substitution sweep of the implicit solve
+    PENALTY             // the bounds are imposed by penalty terms, iterating the implicit solve
+  };
+
+  /** The conditions on the low and high spot boundaries of the 1-d solver */
+  enum class BoundaryCondition
+  {
+    LINEAR,       // the values are extrapolated linearly from the interior nodes
+    DIRICHLET,    // the values are the asymptotic values of the product
+    NEUMANN       // the slopes are those of the asymptotic values of the product
+  };
+
   size_t nTimeSteps;
   std::vector<size_t> nSpotNodes; // spot nodes for each dimension
   std::vector<double> nStdDevs;   // num. standard deviations for each dimension
   double theta;
+  // for each dimension, the spots around which the nodes are concentrated; if empty, the nodes are equally spaced
+  std::vector<std::vector<double>> concentrationSpots;
+  // for each dimension, the width of the concentration regions as a fraction of the grid range
+  std::vector<double> concentrationWidths;
+  // number of time steps after a payoff event that are replaced by two fully implicit half steps
+  size_t nRannacherSteps;
+  // the ADI scheme for the solvers with more than one dimension
+  AdiScheme adiScheme;
+  // how early exercise is imposed by the 1-d solver
+  ExerciseMethod exerciseMethod;
+  // if true, the time steps are picked among the fixings of products with dense fixings (daily exercise),
+  // about nTimeSteps of them, concentrated around the expiration and the exercise windows boundaries
+  bool adaptiveTimeSteps;
+  // the boundary conditions of the 1-d solver; DIRICHLET and NEUMANN need products with asymptotic values
+  BoundaryCondition boundaryCondition;
 
   /** Default ctor */
-  PdeParams(size_t n = 1) : nTimeSteps(1), nSpotNodes(n, 10), nStdDevs(n, 4.0), theta(0.0) {};
+  PdeParams(size_t n = 1)
+  : nTimeSteps(1), nSpotNodes(n, 10), nStdDevs(n, 4.0), theta(0.0),
+    concentrationSpots(n), concentrationWidths(n, 0.1), nRannacherSteps(0),
+    adiScheme(AdiScheme::CRAIG_SNEYD), exerciseMethod(ExerciseMethod::EXPLICIT),
+    adaptiveTimeSteps(false), boundaryCondition(BoundaryCondition::LINEAR) {};
 };
 
 
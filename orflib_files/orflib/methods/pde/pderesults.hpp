@@ -1,6 +1,6 @@
 /**
 @file  pderesults.hpp
-@brief Definition of the PdeResults and Pde1DResults classes
+@brief Definition of the PdeResults, Pde1DResults, Pde2DResults, PdeNDResults and PdeForwardResults classes
 */
 
 #ifndef ORF_PDERESULTS_HPP
@@ -23,10 +23,9 @@ public:
   {
     ORF_ASSERT(!gridAxes.empty(), "No grid axes info. in PDE results!");
     axis.resize(gridAxes[assetIdx].NX + 2);
-    double xmin = gridAxes[assetIdx].Xmin;
-    double dx = gridAxes[assetIdx].DX;
+    Vector const& xlevels = gridAxes[assetIdx].Xlevels;  // not necessarily equally spaced
     for (size_t i = 0; i < axis.size(); ++i) {
-      axis[i] = gridAxes[assetIdx].coordinateChange->fromDiffusedToReal(xmin + i * dx);
+      axis[i] = gridAxes[assetIdx].coordinateChange->fromDiffusedToReal(xlevels[i]);
     }
   }
 
@@ -55,6 +54,18 @@ class Pde1DResults : public PdeResults
 {
 public:
   std::vector<Matrix> values; // for each time a nSpots x nLayers matrix of values
+  // the Greeks at the current spot, one per product, from the same solve:
+  // delta and gamma from the values at time 0 on the three nodes nearest the spot,
+  // theta from the values at the first time step after 0
+  Vector deltas, gammas, thetas;
+  // vega and rho, from the tangent layers if requested with Pde1DSolver::setTangentSensitivities, else empty
+  Vector vegas, rhos;
+  // the cash part of the price, with the credit spread set with Pde1DSolver::setCreditSpread, else empty
+  Vector cashParts;
+  // the prices, and if requested delta, gamma and theta, at the spots set with Pde1DSolver::setOutputSpots,
+  // one row per spot and one column per product; empty if none
+  Vector outputSpots;
+  Matrix spotPrices, spotDeltas, spotGammas, spotThetas;
 
   /** Returns the vector of times, the vector of spots and the matrix of values for
       a variable with index varIdx
@@ -73,6 +84,30 @@ public:
   }
 };
 
+
+class Pde2DResults : public PdeResults
+{
+public:
+  Matrix values;  // the values at time 0, one row per node of the first axis and one column per node of the second
+};
+
+
+class PdeNDResults : public PdeResults
+{
+public:
+  // the values at time 0, one per node, with the index of the first axis running fastest
+  Vector values;
+};
+
+
+class PdeForwardResults : public PdeResults
+{
+public:
+  Vector strikes, maturities;
+  Matrix callPrices;  // the call prices, one row per strike and one column per maturity
+  Matrix values;      // the call prices on the strike nodes, one column per maturity
+};
+
 END_NAMESPACE(orf)
 
 
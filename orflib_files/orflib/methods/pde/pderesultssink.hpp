@@ -0,0 +1,224 @@
+/**
+@file  pderesultssink.hpp
+@brief Definition of the sinks receiving the grid values of the 1-d PDE solver during the solve
+*/
+
+#ifndef ORF_PDERESULTSSINK_HPP
+#define ORF_PDERESULTSSINK_HPP
+
+#include <orflib/methods/pde/pdegrid.hpp>
+#include <limits>
+#include <memory>
+#include <vector>
+
+BEGIN_NAMESPACE(orf)
+
+/** Abstract base class for the objects receiving the grid values of a 1-d PDE solver,
+    once per time step, as the solver runs backwards in time.
+    It selects which values are kept: every k-th time step (the first and the last are always kept),
+    and the spot nodes within the window [sMin, sMax]. Derived classes decide where they go.
+    Keeping only the prices needs no sink at all.
+*/
+class Pde1DResultsSink
+{
+public:
+  /** Ctor; keeps every storeEvery-th time step and the nodes with spots in [sMin, sMax] */
+  explicit Pde1DResultsSink(size_t storeEvery = 1,
+                            double sMin = 0.0,
+                            double sMax = std::numeric_limits<double>::infinity());
+
+  /** Dtor */
+  virtual ~Pde1DResultsSink() {}
+
+  /** Called by the solver once the grid is set up, before the first call to store() */
+  void init(std::vector<double> const& timesteps, GridAxis const& grax, size_t nLayers);
+
+  /** Called by the solver after evaluating the product at time step index stepIdx */
+  void store(size_t stepIdx, Matrix const& values);
+
+  /** The number of time steps kept */
+  size_t nTimes() const { return times_.size(); }
+
+  /** The number of spot nodes kept */
+  size_t nSpots() const { return spots_.size(); }
+
+  /** The number of layers */
+  size_t nLayers() const { return nLayers_; }
+
+  /** The times kept, in increasing order */
+  Vector const& times() const { return times_; }
+
+  /** The spots kept, in increasing order */
+  Vector const& spots() const { return spots_; }
+
+protected:
+  /** Called by init() once the selection is known, to prepare the storage */
+  virtual void doInit() = 0;
+
+  /** Stores the selected values for the time slot timeIdx, an index into times() */
+  virtual void doStore(size_t timeIdx, Matrix const& values) = 0;
+
+  size_t storeEvery_;
+  double sMin_, sMax_;
+  size_t nLayers_;
+  size_t firstNode_;                 // the grid node index of the first spot kept
+  Vector times_, spots_;
+  std::vector<ptrdiff_t> timeSlot_;  // for each time step, the index in times_ or -1 if not kept
+};
+
+/** Smart pointer to Pde1DResultsSink */
+using SPtrPde1DResultsSink = std::shared_ptr<Pde1DResultsSink>;
+
+
+/** Sink keeping the selected values in memory, one nSpots x nLayers matrix per time kept */
+class Pde1DMemorySink : public Pde1DResultsSink
+{
+public:
+  /** Ctor */
+  explicit Pde1DMemorySink(size_t storeEvery = 1,
+                           double sMin = 0.0,
+                           double sMax = std::numeric_limits<double>::infinity())
+  : Pde1DResultsSink(storeEvery, sMin, sMax) {}
+
+  /** The values, one nSpots x nLayers matrix per time kept */
+  std::vector<Matrix> const& values() const { return values_; }
+
+  /** Returns the nTimes x nSpots matrix of values for the layer with index layerIdx */
+  Matrix layerValues(size_t layerIdx) const;
+
+protected:
+  virtual void doInit() override;
+  virtual void doStore(size_t timeIdx, Matrix const& values) override;
+
+  std::vector<Matrix> values_;
+};
+
+
+/** Sink streaming the selected values into a caller-owned buffer, e.g. a preallocated array or
+    a memory mapped file. The values for time slot i, spot j and layer k are written at
+    buffer[(i * nLayers + k) * nSpots + j]. The buffer must hold at least requiredSize() values.
+*/
+class Pde1DBufferSink : public Pde1DResultsSink
+{
+public:
+  /** Ctor from the buffer start and its size in number of doubles */
+  Pde1DBufferSink(double* buffer,
+                  size_t bufferSize,
+                  size_t storeEvery = 1,
+                  double sMin = 0.0,
+                  double sMax = std::numeric_limits<double>::infinity())
+  : Pde1DResultsSink(storeEvery, sMin, sMax), buffer_(buffer), bufferSize_(bufferSize) {}
+
+  /** The number of doubles written for the current selection */
+  size_t requiredSize() const { return nTimes() * nLayers() * nSpots(); }
+
+  /** Returns an upper bound of the buffer size needed, to size the buffer before the solve.
+      nTimes is the number of time points returned by Product::timeSteps(),
+      nNodes the number of spot nodes of the grid, including the two boundary nodes.
+  */
+  static size_t maxRequiredSize(size_t nTimes, size_t nNodes, size_t nLayers, size_t storeEvery = 1)
+  {
+    return ((nTimes - 1) / storeEvery + 2) * nNodes * nLayers;
+  }
+
+protected:
+  virtual void doInit() override;
+  virtual void doStore(size_t timeIdx, Matrix const& values) override;
+
+  double* buffer_;
+  size_t bufferSize_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+inline
+Pde1DResultsSink::Pde1DResultsSink(size_t storeEvery, double sMin, double sMax)
+: storeEvery_(storeEvery), sMin_(sMin), sMax_(sMax), nLayers_(0), firstNode_(0)
+{
+  ORF_ASSERT(storeEvery > 0, "Pde1DResultsSink: the storage frequency must be positive!");
+  ORF_ASSERT(sMin <= sMax, "Pde1DResultsSink: the spot window is empty!");
+}
+
+inline
+void Pde1DResultsSink::init(std::vector<double> const& timesteps, GridAxis const& grax, size_t nLayers)
+{
+  nLayers_ = nLayers;
+
+  // every storeEvery-th step, plus the last one
+  size_t nSteps = timesteps.size();
+  timeSlot_.assign(nSteps, -1);
+  std::vector<double> tms;
+  for (size_t i = 0; i < nSteps; ++i) {
+    if (i % storeEvery_ == 0 || i == nSteps - 1) {
+      timeSlot_[i] = tms.size();
+      tms.push_back(timesteps[i]);
+    }
+  }
+  times_ = Vector(tms);
+
+  // the nodes in the spot window
+  size_t nNodes = grax.Slevels.size();
+  firstNode_ = 0;
+  while (firstNode_ < nNodes && grax.Slevels[firstNode_] < sMin_)
+    ++firstNode_;
+  size_t lastNode = firstNode_;
+  while (lastNode < nNodes && grax.Slevels[lastNode] <= sMax_)
+    ++lastNode;
+  ORF_ASSERT(lastNode > firstNode_, "Pde1DResultsSink: no grid node in the spot window!");
+  spots_ = grax.Slevels.subvec(firstNode_, lastNode - 1);
+
+  doInit();
+}
+
+inline
+void Pde1DResultsSink::store(size_t stepIdx, Matrix const& values)
+{
+  ptrdiff_t slot = timeSlot_[stepIdx];
+  if (slot >= 0)
+    doStore(slot, values);
+}
+
+inline
+Matrix Pde1DMemorySink::layerValues(size_t layerIdx) const
+{
+  ORF_ASSERT(layerIdx < nLayers_, "Pde1DMemorySink: layer index out of range!");
+  Matrix vals(nTimes(), nSpots());
+  for (size_t i = 0; i < nTimes(); ++i)
+    vals.row(i) = values_[i].col(layerIdx).t();
+  return vals;
+}
+
+inline
+void Pde1DMemorySink::doInit()
+{
+  values_.assign(nTimes(), Matrix());
+}
+
+inline
+void Pde1DMemorySink::doStore(size_t timeIdx, Matrix const& values)
+{
+  values_[timeIdx] = values.rows(firstNode_, firstNode_ + nSpots() - 1);
+}
+
+inline
+void Pde1DBufferSink::doInit()
+{
+  ORF_ASSERT(buffer_ != nullptr, "Pde1DBufferSink: null buffer!");
+  ORF_ASSERT(bufferSize_ >= requiredSize(), "Pde1DBufferSink: the buffer is too small!");
+}
+
+inline
+void Pde1DBufferSink::doStore(size_t timeIdx, Matrix const& values)
+{
+  size_t ns = nSpots();
+  double* dst = buffer_ + timeIdx * nLayers_ * ns;
+  for (size_t k = 0; k < nLayers_; ++k) {
+    double const* src = values.colptr(k) + firstNode_;
+    std::copy(src, src + ns, dst + k * ns);
+  }
+}
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_PDERESULTSSINK_HPP
@@ -0,0 +1,130 @@
+/**
+@file  pdesparsegrid.cpp
+@brief Implementation of the sparse grid combination of N-dim PDE prices
+*/
+
+#include <orflib/methods/pde/pdesparsegrid.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <numeric>
+#include <thread>
+
+BEGIN_NAMESPACE(orf)
+
+/** Appends to grids all the level vectors of nDims non-negative levels summing to sum */
+static
+void levelVectors(size_t nDims, size_t sum, std::vector<size_t>& levels, std::vector<std::vector<size_t>>& grids)
+{
+  size_t k = levels.size();
+  if (k + 1 == nDims) {
+    levels.push_back(sum);
+    grids.push_back(levels);
+    levels.pop_back();
+    return;
+  }
+  for (size_t l = 0; l <= sum; ++l) {
+    levels.push_back(l);
+    levelVectors(nDims, sum - l, levels, grids);
+    levels.pop_back();
+  }
+}
+
+PdeSparseGridResults solvePdeSparseGrid(std::function<SPtrProduct()> const& productFactory,
+                                        SPtrYieldCurve discountYieldCurve,
+                                        std::vector<double> const& spots,
+                                        std::vector<double> const& divyields,
+                                        std::vector<double> const& vols,
+                                        Matrix const& correlations,
+                                        PdeParams const& params,
+                                        size_t level,
+                                        size_t nThreads)
+{
+  size_t nDims = spots.size();
+  ORF_ASSERT(nDims >= 1, "solvePdeSparseGrid: need at least one asset!");
+  ORF_ASSERT(params.nSpotNodes.size() == nDims, "solvePdeSparseGrid: need one number of spot nodes per asset!");
+  ORF_ASSERT(level + 1 >= nDims, "solvePdeSparseGrid: the level must be at least the number of assets minus 1!");
+
+  // the component grids of the levels level - q, with their coefficients (-1)^q * C(nDims - 1, q)
+  std::vector<std::vector<size_t>> grids;
+  std::vector<double> coeffs;
+  double binom = 1.0;
+  for (size_t q = 0; q < nDims; ++q) {
+    std::vector<size_t> levels;
+    levelVectors(nDims, level - q, levels, grids);
+    coeffs.resize(grids.size(), (q % 2 == 0 ? 1.0 : -1.0) * binom);
+    binom = binom * double(nDims - 1 - q) / double(q + 1);
+  }
+  size_t nGrids = grids.size();
+
+  // the pde parameters of each grid, and its number of nodes
+  std::vector<PdeParams> gridParams(nGrids, params);
+  std::vector<size_t> gridNodes(nGrids, 1);
+  for (size_t g = 0; g < nGrids; ++g) {
+    for (size_t k = 0; k < nDims; ++k) {
+      size_t& nx = gridParams[g].nSpotNodes[k];
+      nx = ((params.nSpotNodes[k] + 1) << grids[g][k]) - 1;
+      gridNodes[g] *= nx + 2;
+    }
+  }
+
+  // the largest grids first, so that the small ones fill the threads at the end
+  std::vector<size_t> order(nGrids);
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return gridNodes[a] > gridNodes[b]; });
+
+  // each worker pulls the next grid, as in solvePde1DBatch; every grid writes only to its own slot
+  std::vector<double> prices(nGrids, 0.0);
+  std::vector<SPtrProduct> products(nGrids);
+  for (size_t g = 0; g < nGrids; ++g)
+    products[g] = productFactory();
+  std::vector<std::exception_ptr> errors(nGrids);
+  std::atomic<size_t> nextGrid(0);
+  auto worker = [&]() {
+    for (size_t i = nextGrid++; i < nGrids; i = nextGrid++) {
+      size_t g = order[i];
+      try {
+        PdeNDResults results;
+        PdeNDSolver solver(products[g], discountYieldCurve, spots, divyields, vols, correlations, results, 1);
+        solver.solve(gridParams[g]);
+        prices[g] = results.prices[0];
+      }
+      catch (...) {
+        errors[g] = std::current_exception();
+      }
+    }
+  };
+
+  if (nThreads == 0)
+    nThreads = std::max(1u, std::thread::hardware_concurrency());
+  nThreads = std::min(nThreads, nGrids);
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < nThreads; ++t)
+    pool.emplace_back(worker);
+  worker();   // the calling thread works too
+  for (auto& th : pool)
+    th.join();
+
+  for (auto const& err : errors)
+    if (err)
+      std::rethrow_exception(err);
+
+  PdeSparseGridResults res;
+  res.gridLevels.set_size(nGrids, nDims);
+  res.gridPrices = Vector(prices);
+  res.coefficients = Vector(coeffs);
+  res.price = 0.0;
+  res.nNodes = 0;
+  for (size_t g = 0; g < nGrids; ++g) {
+    for (size_t k = 0; k < nDims; ++k)
+      res.gridLevels(g, k) = double(grids[g][k]);
+    res.price += coeffs[g] * prices[g];
+    res.nNodes += gridNodes[g];
+  }
+  res.nFullGridNodes = 1;
+  for (size_t k = 0; k < nDims; ++k)
+    res.nFullGridNodes *= ((params.nSpotNodes[k] + 1) << level) + 1;
+  return res;
+}
+
+END_NAMESPACE(orf)
@@ -0,0 +1,53 @@
+/**
+@file  pdesparsegrid.hpp
+@brief Sparse grid combination of N-dim PDE prices over anisotropic grids
+*/
+
+#ifndef ORF_PDESPARSEGRID_HPP
+#define ORF_PDESPARSEGRID_HPP
+
+#include <orflib/methods/pde/pdendsolver.hpp>
+#include <functional>
+
+BEGIN_NAMESPACE(orf)
+
+/** The results of the sparse grid combination */
+struct PdeSparseGridResults
+{
+  double price;          // the combined price
+  Matrix gridLevels;     // the levels of the component grids, one row per grid and one column per asset
+  Vector gridPrices;     // the prices on the component grids
+  Vector coefficients;   // the combination coefficients of the component grids
+  size_t nNodes;         // the total number of nodes of the component grids
+  size_t nFullGridNodes; // the number of nodes of the full grid of the same level, for comparison
+};
+
+/** Prices a product on N assets by the sparse grid combination technique: instead of one full grid with
+    the finest spacing on all axes, it solves many small anisotropic grids, fine on some axes and coarse on
+    the others, and combines their prices so that the leading error terms cancel, as in the sparse grids.
+    The component grid with levels (l_1, ..., l_N) has (params.nSpotNodes[k] + 1) * 2^l_k - 1 spot nodes
+    on axis k, so that params sets level 0, as in solvePde1DRichardson. The combined price is
+      sum over q = 0 ... N - 1 of (-1)^q * C(N - 1, q) * sum over l_1 + ... + l_N = level - q of P(l)
+    which needs level >= N - 1. The grids of the top level have about as many nodes as one axis of the
+    full grid with level on all axes, so that the nodes grow as 2^level * level^(N - 1) instead of 2^(N * level).
+    The grids are independent, and are solved concurrently on nThreads threads (0 for the hardware threads),
+    the largest first, each by a PdeNDSolver on one thread.
+    The cancellation relies on the error expansion holding already on the coarsest grids, so level 0 must
+    resolve the payoff kink, e.g. with 15 or more spot nodes per axis; with fewer the combined prices
+    oscillate with the level.
+    All grids share the time steps of params, so the time error is that of a single solve.
+    The products are evaluated in place, so the factory must return a new product on each call.
+*/
+PdeSparseGridResults solvePdeSparseGrid(std::function<SPtrProduct()> const& productFactory,
+                                        SPtrYieldCurve discountYieldCurve,
+                                        std::vector<double> const& spots,
+                                        std::vector<double> const& divyields,
+                                        std::vector<double> const& vols,
+                                        Matrix const& correlations,
+                                        PdeParams const& params,
+                                        size_t level,
+                                        size_t nThreads = 0);
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_PDESPARSEGRID_HPP
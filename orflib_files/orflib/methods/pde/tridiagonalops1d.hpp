@@ -10,6 +10,8 @@
 #include <orflib/exception.hpp>
 #include <orflib/math/matrix.hpp>
 #include <algorithm>
+#include <cmath>
+#include <vector>
 
 BEGIN_NAMESPACE(orf)
 
@@ -29,6 +31,109 @@ void solveTridiagonal(ARRAY2& x,
                       ARRAY1	const& upper,
                       ARRAY2	const& y);
 
+/** Same as above, with caller-provided scratch vectors D and Y, resized as needed.
+    It does not allocate when the scratch vectors are already of the right size,
+    and it is reentrant as long as different callers pass different scratch vectors.
+*/
+template <typename ARRAY1, typename ARRAY2>
+void solveTridiagonal(ARRAY2& x,
+                      ARRAY1	const& lower,
+                      ARRAY1	const& diag,
+                      ARRAY1	const& upper,
+                      ARRAY2	const& y,
+                      Vector& D,
+                      Vector& Y);
+
+/** Computes the factors of the tridiagonal matrix T for solveFactoredTridiagonal.
+    The elimination runs from the last interior row up, as in solveTridiagonal:
+    D holds the pivots and M the multipliers upper[i] / D[i+1], both of size N-1.
+*/
+template <typename ARRAY1>
+void factorTridiagonal(ARRAY1 const& lower,
+                       ARRAY1 const& diag,
+                       ARRAY1 const& upper,
+                       Vector& D,
+                       Vector& M);
+
+/** Solves T*x=y given the factors from factorTridiagonal, using Y as scratch.
+    Only the elements x[1] ... x[N-2] are modified.
+*/
+template <typename ARRAY1, typename ARRAY2, typename ARRAY3>
+void solveFactoredTridiagonal(ARRAY2& x,
+                              ARRAY1 const& lower,
+                              Vector const& D,
+                              Vector const& M,
+                              ARRAY3 const& y,
+                              Vector& Y);
+
+/** Solves T*X=Y for all the columns (layers) of y at once, given the factors from factorTridiagonal.
+    The sweeps run on the scratch matrix S, which holds the transpose of y, so that the innermost
+    loops run over the layers on contiguous memory and carry no dependency from one iteration
+    to the next; the compiler can then vectorize them.
+    Only the rows x(1, :) ... x(N-2, :) are modified.
+*/
+template <typename ARRAY1>
+void solveFactoredTridiagonalLayers(Matrix& x,
+                                    ARRAY1 const& lower,
+                                    Vector const& D,
+                                    Vector const& M,
+                                    Matrix const& y,
+                                    Matrix& S);
+
+/** Solves T*x=y in place for the lines stored in the rows firstRow ... endRow - 1 of x, each line running
+    along the columns, given the factors from factorTridiagonal. As in solveFactoredTridiagonalLayers,
+    the sweeps run column by column and the innermost loops over the rows, on contiguous memory,
+    but without the transposition.
+    Only the elements x(firstRow:endRow-1, 1) ... x(firstRow:endRow-1, N-2) are modified.
+*/
+template <typename ARRAY1>
+void solveFactoredTridiagonalRows(Matrix& x,
+                                  ARRAY1 const& lower,
+                                  Vector const& D,
+                                  Vector const& M,
+                                  size_t firstRow,
+                                  size_t endRow);
+
+/** Solves the linear complementarity problem T*x = y where lb < x < ub, with x = lb or x = ub where
+    a bound is active, as for early exercise, by the Brennan-Schwartz algorithm: the elimination is that
+    of factorTridiagonal, and x is projected on [lb, ub] in the substitution sweep from the first row up.
+    The solution is exact when the active bounds form one interval at the start of the grid, e.g. for puts.
+    Only the elements x[1] ... x[N-2] are modified.
+*/
+template <typename ARRAY1, typename ARRAY2, typename ARRAY3>
+void solveFactoredTridiagonalProjected(ARRAY2& x,
+                                       ARRAY1 const& lower,
+                                       Vector const& D,
+                                       Vector const& M,
+                                       ARRAY3 const& y,
+                                       Vector const& lb,
+                                       Vector const& ub,
+                                       Vector& Y);
+
+/** Computes the factors of T with the elimination running from the first interior row down,
+    the reverse of factorTridiagonal: D holds the pivots and M the multipliers lower[i] / D[i-1].
+*/
+template <typename ARRAY1>
+void factorTridiagonalReversed(ARRAY1 const& lower,
+                               ARRAY1 const& diag,
+                               ARRAY1 const& upper,
+                               Vector& D,
+                               Vector& M);
+
+/** Same as solveFactoredTridiagonalProjected, given the factors from factorTridiagonalReversed:
+    the substitution sweep runs from the last row down, so the solution is exact when the active bounds
+    form one interval at the end of the grid, e.g. for calls.
+*/
+template <typename ARRAY1, typename ARRAY2, typename ARRAY3>
+void solveFactoredTridiagonalReversedProjected(ARRAY2& x,
+                                               ARRAY1 const& upper,
+                                               Vector const& D,
+                                               Vector const& M,
+                                               ARRAY3 const& y,
+                                               Vector const& lb,
+                                               Vector const& ub,
+                                               Vector& Y);
+
 /** Utility function that adjusts the explicit and implicit operators for boundary conditions.
     The adjustment implements constant first derivative in spot space at the edge nodes
     (zero second derivative in spot space)
@@ -49,6 +154,31 @@ void adjustOpsForBoundaryConditions(EXPOP& opExplicit,
   opExplicit.addToUpperVal(-highAdjustmentValueImp + highAdjustmentValueExp);
 }
 
+/** Same as above, for a non-uniform grid with node coordinates Xlevels.
+    The same condition is discretized with the non-uniform stencils at the first and last interior nodes.
+*/
+template <typename EXPOP, typename IMPOP>
+void adjustOpsForBoundaryConditions(EXPOP& opExplicit,
+                                    IMPOP& opImplicit,
+                                    Vector const& Xlevels)
+{
+  size_t n = Xlevels.size() - 2;
+  // V[0] = lowDiag * V[1] + lowUp * V[2]
+  double hL = Xlevels[1] - Xlevels[0], hR = Xlevels[2] - Xlevels[1];
+  double lowDiag = (2.0 + hR - hL) * (hL + hR) / (hR * (2.0 + hR));
+  double lowUp = -(2.0 - hL) * hL / (hR * (2.0 + hR));
+  // V[n+1] = highDiag * V[n] + highLow * V[n-1]
+  hL = Xlevels[n] - Xlevels[n - 1];
+  hR = Xlevels[n + 1] - Xlevels[n];
+  double highDiag = (2.0 + hR - hL) * (hL + hR) / (hL * (2.0 - hL));
+  double highLow = -(2.0 + hR) * hR / (hL * (2.0 - hL));
+
+  opImplicit.adjustForLowerBoundaryCondition(4, 0.0, 0.0, lowDiag, lowUp);
+  opImplicit.adjustForHigherBoundaryCondition(4, 0.0, 0.0, highDiag, highLow);
+  opExplicit.adjustForLowerBoundaryCondition(4, 0.0, 0.0, lowDiag, lowUp);
+  opExplicit.adjustForHigherBoundaryCondition(4, 0.0, 0.0, highDiag, highLow);
+}
+
 
 /** Adjusts the solution at the edge notes */
 inline
@@ -62,6 +192,20 @@ void applyBoundaryConditions(Matrix& solution)
   }
 }
 
+/** Same as above, for a non-uniform grid with node coordinates Xlevels */
+inline
+void applyBoundaryConditions(Matrix& solution, Vector const& Xlevels)
+{
+  size_t n = solution.n_rows - 2;
+  size_t nLayers = solution.n_cols;
+  double wLow = (Xlevels[1] - Xlevels[0]) / (Xlevels[2] - Xlevels[1]);
+  double wHigh = (Xlevels[n + 1] - Xlevels[n]) / (Xlevels[n] - Xlevels[n - 1]);
+  for (size_t j = 0; j < nLayers; ++j) {
+    solution(0, j) = solution(1, j) + wLow * (solution(1, j) - solution(2, j));
+    solution(n + 1, j) = solution(n, j) + wHigh * (solution(n, j) - solution(n - 1, j));
+  }
+}
+
 /** Base class representing a tridiagonal operator arising in discretization of
     1-dimensional PDEs.
 */
@@ -121,6 +265,23 @@ public:
   /** Adds to the upper value */
   void addToUpperVal(double upperVal) { UpperVal_ += upperVal; }
 
+  /** Folds the boundary conditions V[0] = lowWeight * V[1] + b0 and V[N+1] = highWeight * V[N] + b1
+      into the first and last rows. The terms in b0 and b1 may change from step to step, so they are
+      not kept in the operator: the caller adds lowerBoundaryCoeff() * b0 and upperBoundaryCoeff() * b1
+      to the first and last rows of the result.
+  */
+  void adjustForAffineBoundaryConditions(double lowWeight, double highWeight)
+  {
+    diag_[1] += lowWeight * lower_[1];
+    diag_[N_] += highWeight * upper_[N_];
+  }
+
+  /** The coefficient of V[0] in the first row */
+  double lowerBoundaryCoeff() const { return lower_[1]; }
+
+  /** The coefficient of V[N+1] in the last row */
+  double upperBoundaryCoeff() const { return upper_[N_]; }
+
   // Boundary conditions
 
   /** Adjust for the standard (log-linear interpolation) boundary conditions */
@@ -167,7 +328,65 @@ public:
   template <typename ARRAY1, typename ARRAY2>
   void applyInverse(ARRAY1 const& vals, ARRAY2& result)
   {
-    solveTridiagonal(result, lower_, diag_, upper_, vals);
+    solveTridiagonal(result, lower_, diag_, upper_, vals, scratchD_, scratchY_);
+  }
+
+  /** Computes and stores the LU factors of the operator, for repeated calls of applyFactorizedInverse.
+      The factors must be recomputed whenever the operator is modified.
+  */
+  void factorize()
+  {
+    factorTridiagonal(lower_, diag_, upper_, factorD_, factorM_);
+    factorTridiagonalReversed(lower_, diag_, upper_, factorRevD_, factorRevM_);
+  }
+
+  /** Same as applyInverse, but using the factors stored by the last call to factorize();
+      only the substitution sweeps are done */
+  template <typename ARRAY1, typename ARRAY2>
+  void applyFactorizedInverse(ARRAY1 const& vals, ARRAY2& result)
+  {
+    ORF_ASSERT(factorD_.size() == N_ + 1, "TridiagonalOperator1D: the operator has not been factorized!");
+    solveFactoredTridiagonal(result, lower_, factorD_, factorM_, vals, scratchY_);
+  }
+
+  /** Same as applyFactorizedInverse, for all the columns (layers) of vals in one sweep */
+  void applyFactorizedInverseToLayers(Matrix const& vals, Matrix& result)
+  {
+    ORF_ASSERT(factorD_.size() == N_ + 1, "TridiagonalOperator1D: the operator has not been factorized!");
+    solveFactoredTridiagonalLayers(result, lower_, factorD_, factorM_, vals, scratchLayers_);
+  }
+
+  /** Same as applyFactorizedInverse, with the result constrained to lb <= result <= ub (early exercise)
+      by the Brennan-Schwartz algorithm. The substitution sweep starts from the end of the grid where
+      the unconstrained solution violates the bounds, so it is exact for bounds active on one side only,
+      as for American calls and puts.
+  */
+  template <typename ARRAY1, typename ARRAY2>
+  void applyProjectedInverse(ARRAY1 const& vals, ARRAY2& result, Vector const& lb, Vector const& ub);
+
+  /** Same as applyProjectedInverse, by the penalty method: the operator is augmented with a large
+      diagonal penalty on the nodes violating the bounds, and solved again until these nodes do not change,
+      usually in two or three iterations, or until the solution changes by less than 1e-6 relative, as the node
+      next to the free boundary may flip in and out forever. It does not assume where the bounds are active.
+      Throws if neither happens after 50 iterations.
+  */
+  template <typename ARRAY1, typename ARRAY2>
+  void applyPenalizedInverse(ARRAY1 const& vals, ARRAY2& result, Vector const& lb, Vector const& ub);
+
+  /** Applies the operator to the lines stored in the rows firstRow ... endRow - 1 of vals, each line running
+      along the columns; the innermost loops run over the rows. The other rows of result are not modified,
+      so that threads can share the operator and work on different blocks of rows.
+  */
+  void applyToRows(Matrix const& vals, Matrix& result, size_t firstRow, size_t endRow) const;
+
+  /** Same as applyFactorizedInverse, in place on the lines stored in the rows firstRow ... endRow - 1
+      of vals, each line running along the columns, e.g. for the independent line solves of an ADI sweep.
+      Only the rows in the range are modified, so that threads can share the operator.
+  */
+  void applyFactorizedInverseToRows(Matrix& vals, size_t firstRow, size_t endRow) const
+  {
+    ORF_ASSERT(factorD_.size() == N_ + 1, "TridiagonalOperator1D: the operator has not been factorized!");
+    solveFactoredTridiagonalRows(vals, lower_, factorD_, factorM_, firstRow, endRow);
   }
 
 
@@ -243,6 +462,12 @@ protected:
 
 private:
   double LowerVal_, UpperVal_;
+  Vector scratchD_, scratchY_;  // scratch for applyInverse, owned so that operators are reentrant
+  Vector factorD_, factorM_;    // the pivots and multipliers of the LU factors
+  Vector factorRevD_, factorRevM_;  // the same, with the elimination in reverse order
+  Vector penaltyDiag_, penaltyRhs_, penaltyM_, penaltyPrev_;  // scratch for applyPenalizedInverse
+  std::vector<signed char> penaltyState_;  // -1, 0, 1 where the lower bound, no bound, the upper bound is active
+  Matrix scratchLayers_;        // scratch for applyFactorizedInverseToLayers
 };
 
 /** The identity operator */
@@ -282,6 +507,25 @@ public:
     }
     TridiagonalOp1D<ARRAY>::init();
   }
+
+  /** Initializes with the non-uniform central difference stencil on the nodes Xlevels */
+  template <class ARRAY2>
+  void init(ARRAY2 const & drifts, double DT, Vector const& Xlevels, double theta)
+  {
+    size_t N = drifts.size();
+    TridiagonalOp1D<ARRAY>::lower_.resize(N + 2);
+    TridiagonalOp1D<ARRAY>::diag_.resize(N + 2);
+    TridiagonalOp1D<ARRAY>::upper_.resize(N + 2);
+    double f1 = DT * theta;
+    for (size_t i = 1; i <= N; ++i) {
+      double hL = Xlevels[i] - Xlevels[i - 1], hR = Xlevels[i + 1] - Xlevels[i];
+      double temp = drifts[i - 1] * f1;
+      TridiagonalOp1D<ARRAY>::lower_[i] = -temp * hR / (hL * (hL + hR));
+      TridiagonalOp1D<ARRAY>::diag_[i] = temp * (hR - hL) / (hL * hR);
+      TridiagonalOp1D<ARRAY>::upper_[i] = temp * hL / (hR * (hL + hR));
+    }
+    TridiagonalOp1D<ARRAY>::init();
+  }
 };
 
 /** The Gamma Operator */
@@ -313,6 +557,26 @@ public:
     }
     TridiagonalOp1D<ARRAY>::init();
   }
+
+  /** Initializes with the non-uniform three point stencil on the nodes Xlevels */
+  template <typename ARRAY2>
+  void init(ARRAY2 const & variances, double DT, Vector const& Xlevels, double theta)
+  {
+    size_t N = variances.size();
+    TridiagonalOp1D<ARRAY>::lower_.resize(N + 2);
+    TridiagonalOp1D<ARRAY>::diag_.resize(N + 2);
+    TridiagonalOp1D<ARRAY>::upper_.resize(N + 2);
+
+    double f1 = DT * theta;
+    for (size_t i = 1; i <= N; ++i) {
+      double hL = Xlevels[i] - Xlevels[i - 1], hR = Xlevels[i + 1] - Xlevels[i];
+      double temp = f1 * variances[i - 1];
+      TridiagonalOp1D<ARRAY>::lower_[i] = temp / (hL * (hL + hR));
+      TridiagonalOp1D<ARRAY>::diag_[i] = -temp / (hL * hR);
+      TridiagonalOp1D<ARRAY>::upper_[i] = temp / (hR * (hL + hR));
+    }
+    TridiagonalOp1D<ARRAY>::init();
+  }
 };
 
 
@@ -326,16 +590,26 @@ void solveTridiagonal(ARRAY2& x,
                       ARRAY1 const& upper,
                       ARRAY2 const& y)
 {
-  ptrdiff_t i, n = diag.size() - 2;
+  Vector D, Y;
+  solveTridiagonal(x, lower, diag, upper, y, D, Y);
+}
 
-  static Vector D(1);
-  static Vector Y(1);
+template <typename ARRAY1, typename ARRAY2> inline
+void solveTridiagonal(ARRAY2& x,
+                      ARRAY1 const& lower,
+                      ARRAY1 const& diag,
+                      ARRAY1 const& upper,
+                      ARRAY2 const& y,
+                      Vector& D,
+                      Vector& Y)
+{
+  ptrdiff_t i, n = diag.size() - 2;
 
   if (D.size() != n + 1)
-    D = Vector(n + 1);
+    D.set_size(n + 1);
 
   if (Y.size() != n + 1)
-    Y = Vector(n + 1);
+    Y.set_size(n + 1);
 
   D[n] = diag[n];
   Y[n] = y[n];
@@ -352,6 +626,292 @@ void solveTridiagonal(ARRAY2& x,
   }
 }
 
+template <typename ARRAY1> inline
+void factorTridiagonal(ARRAY1 const& lower,
+                       ARRAY1 const& diag,
+                       ARRAY1 const& upper,
+                       Vector& D,
+                       Vector& M)
+{
+  ptrdiff_t i, n = diag.size() - 2;
+
+  if (D.size() != n + 1)
+    D.set_size(n + 1);
+
+  if (M.size() != n + 1)
+    M.set_size(n + 1);
+
+  D[n] = diag[n];
+  M[n] = 0.0;
+  for (i = n - 1; i >= 1; i--) {
+    M[i] = upper[i] / D[i + 1];
+    D[i] = diag[i] - M[i] * lower[i + 1];
+  }
+}
+
+template <typename ARRAY1, typename ARRAY2, typename ARRAY3> inline
+void solveFactoredTridiagonal(ARRAY2& x,
+                              ARRAY1 const& lower,
+                              Vector const& D,
+                              Vector const& M,
+                              ARRAY3 const& y,
+                              Vector& Y)
+{
+  ptrdiff_t i, n = D.size() - 1;
+
+  if (Y.size() != n + 1)
+    Y.set_size(n + 1);
+
+  Y[n] = y[n];
+  for (i = n - 1; i >= 1; i--)
+    Y[i] = y[i] - M[i] * Y[i + 1];
+
+  x[1] = Y[1] / D[1];
+  for (i = 2; i <= n; i++)
+    x[i] = (Y[i] - lower[i] * x[i - 1]) / D[i];
+}
+
+template <typename ARRAY1> inline
+void solveFactoredTridiagonalLayers(Matrix& x,
+                                    ARRAY1 const& lower,
+                                    Vector const& D,
+                                    Vector const& M,
+                                    Matrix const& y,
+                                    Matrix& S)
+{
+  size_t n = D.size() - 1;
+  size_t nl = y.n_cols;
+  S = y.t();  // one column per node, one row per layer
+
+  for (size_t i = n - 1; i >= 1; i--) {
+    double* Si = S.colptr(i);
+    double const* Si1 = S.colptr(i + 1);
+    double m = M[i];
+    for (size_t j = 0; j < nl; ++j)
+      Si[j] -= m * Si1[j];
+  }
+
+  double* S1 = S.colptr(1);
+  for (size_t j = 0; j < nl; ++j)
+    S1[j] /= D[1];
+  for (size_t i = 2; i <= n; i++) {
+    double* Si = S.colptr(i);
+    double const* Sim1 = S.colptr(i - 1);
+    double lo = lower[i], di = D[i];
+    for (size_t j = 0; j < nl; ++j)
+      Si[j] = (Si[j] - lo * Sim1[j]) / di;
+  }
+
+  x.rows(1, n) = S.cols(1, n).t();
+}
+
+template <typename ARRAY1> inline
+void solveFactoredTridiagonalRows(Matrix& x,
+                                  ARRAY1 const& lower,
+                                  Vector const& D,
+                                  Vector const& M,
+                                  size_t firstRow,
+                                  size_t endRow)
+{
+  size_t n = D.size() - 1;
+  size_t nr = endRow - firstRow;
+
+  for (size_t i = n - 1; i >= 1; i--) {
+    double* xi = x.colptr(i) + firstRow;
+    double const* xi1 = x.colptr(i + 1) + firstRow;
+    double m = M[i];
+    for (size_t r = 0; r < nr; ++r)
+      xi[r] -= m * xi1[r];
+  }
+
+  double* x1 = x.colptr(1) + firstRow;
+  for (size_t r = 0; r < nr; ++r)
+    x1[r] /= D[1];
+  for (size_t i = 2; i <= n; i++) {
+    double* xi = x.colptr(i) + firstRow;
+    double const* xim1 = x.colptr(i - 1) + firstRow;
+    double lo = lower[i], di = D[i];
+    for (size_t r = 0; r < nr; ++r)
+      xi[r] = (xi[r] - lo * xim1[r]) / di;
+  }
+}
+
+template <typename ARRAY1, typename ARRAY2, typename ARRAY3> inline
+void solveFactoredTridiagonalProjected(ARRAY2& x,
+                                       ARRAY1 const& lower,
+                                       Vector const& D,
+                                       Vector const& M,
+                                       ARRAY3 const& y,
+                                       Vector const& lb,
+                                       Vector const& ub,
+                                       Vector& Y)
+{
+  ptrdiff_t i, n = D.size() - 1;
+
+  if (Y.size() != n + 1)
+    Y.set_size(n + 1);
+
+  Y[n] = y[n];
+  for (i = n - 1; i >= 1; i--)
+    Y[i] = y[i] - M[i] * Y[i + 1];
+
+  x[1] = std::min(std::max(Y[1] / D[1], lb[1]), ub[1]);
+  for (i = 2; i <= n; i++)
+    x[i] = std::min(std::max((Y[i] - lower[i] * x[i - 1]) / D[i], lb[i]), ub[i]);
+}
+
+template <typename ARRAY1> inline
+void factorTridiagonalReversed(ARRAY1 const& lower,
+                               ARRAY1 const& diag,
+                               ARRAY1 const& upper,
+                               Vector& D,
+                               Vector& M)
+{
+  ptrdiff_t i, n = diag.size() - 2;
+
+  if (D.size() != n + 1)
+    D.set_size(n + 1);
+
+  if (M.size() != n + 1)
+    M.set_size(n + 1);
+
+  D[1] = diag[1];
+  M[1] = 0.0;
+  for (i = 2; i <= n; i++) {
+    M[i] = lower[i] / D[i - 1];
+    D[i] = diag[i] - M[i] * upper[i - 1];
+  }
+}
+
+template <typename ARRAY1, typename ARRAY2, typename ARRAY3> inline
+void solveFactoredTridiagonalReversedProjected(ARRAY2& x,
+                                               ARRAY1 const& upper,
+                                               Vector const& D,
+                                               Vector const& M,
+                                               ARRAY3 const& y,
+                                               Vector const& lb,
+                                               Vector const& ub,
+                                               Vector& Y)
+{
+  ptrdiff_t i, n = D.size() - 1;
+
+  if (Y.size() != n + 1)
+    Y.set_size(n + 1);
+
+  Y[1] = y[1];
+  for (i = 2; i <= n; i++)
+    Y[i] = y[i] - M[i] * Y[i - 1];
+
+  x[n] = std::min(std::max(Y[n] / D[n], lb[n]), ub[n]);
+  for (i = n - 1; i >= 1; i--)
+    x[i] = std::min(std::max((Y[i] - upper[i] * x[i + 1]) / D[i], lb[i]), ub[i]);
+}
+
+template<typename ARRAY>
+template <typename ARRAY1, typename ARRAY2>
+inline
+void TridiagonalOp1D<ARRAY>::applyProjectedInverse(ARRAY1 const& vals,
+                                                   ARRAY2& result,
+                                                   Vector const& lb,
+                                                   Vector const& ub)
+{
+  ORF_ASSERT(factorD_.size() == N_ + 1, "TridiagonalOperator1D: the operator has not been factorized!");
+  ORF_ASSERT(lb.size() == N_ + 2 && ub.size() == N_ + 2, "TridiagonalOperator1D: wrong size of the bounds!");
+
+  // the unconstrained solution tells on which side the bounds are active: the largest violation
+  // lies inside the exercise region, while round-off may give tiny violations elsewhere
+  solveFactoredTridiagonal(result, lower_, factorD_, factorM_, vals, scratchY_);
+  size_t worst = 0;
+  double worstViolation = 0.0;
+  for (size_t i = 1; i <= N_; ++i) {
+    double violation = std::max(lb[i] - result[i], result[i] - ub[i]);
+    if (violation > worstViolation) {
+      worst = i;
+      worstViolation = violation;
+    }
+  }
+  if (worst == 0)
+    return;
+
+  // start the substitution from the nearer end of the grid
+  if (2 * worst <= N_ + 1)
+    solveFactoredTridiagonalProjected(result, lower_, factorD_, factorM_, vals, lb, ub, scratchY_);
+  else
+    solveFactoredTridiagonalReversedProjected(result, upper_, factorRevD_, factorRevM_, vals, lb, ub, scratchY_);
+}
+
+template<typename ARRAY>
+template <typename ARRAY1, typename ARRAY2>
+inline
+void TridiagonalOp1D<ARRAY>::applyPenalizedInverse(ARRAY1 const& vals,
+                                                   ARRAY2& result,
+                                                   Vector const& lb,
+                                                   Vector const& ub)
+{
+  ORF_ASSERT(factorD_.size() == N_ + 1, "TridiagonalOperator1D: the operator has not been factorized!");
+  ORF_ASSERT(lb.size() == N_ + 2 && ub.size() == N_ + 2, "TridiagonalOperator1D: wrong size of the bounds!");
+  // the bounds are met up to about (residual / penalty), well below the discretization error
+  const double penalty = 1.0e8;
+  const double tol = 1.0e-6;
+  const size_t maxIter = 50;
+
+  // start from the unconstrained solution, with the stored factors
+  solveFactoredTridiagonal(result, lower_, factorD_, factorM_, vals, scratchY_);
+  penaltyState_.assign(N_ + 1, 0);
+  penaltyDiag_.set_size(N_ + 2);
+  penaltyRhs_.set_size(N_ + 2);
+  penaltyPrev_.set_size(N_ + 2);
+
+  for (size_t iter = 0; iter < maxIter; ++iter) {
+    bool changed = false;
+    for (size_t i = 1; i <= N_; ++i) {
+      // nodes with equal bounds are pinned, so that they do not flip between the two bounds
+      signed char state = result[i] < lb[i] || lb[i] == ub[i] ? -1 : (result[i] > ub[i] ? 1 : 0);
+      changed = changed || state != penaltyState_[i];
+      penaltyState_[i] = state;
+      penaltyDiag_[i] = diag_[i];
+      penaltyRhs_[i] = vals[i];
+      if (state != 0) {
+        penaltyDiag_[i] += penalty;
+        penaltyRhs_[i] += penalty * (state < 0 ? lb[i] : ub[i]);
+      }
+    }
+    if (!changed)  // same active nodes, same solution
+      return;
+    for (size_t i = 1; i <= N_; ++i)
+      penaltyPrev_[i] = result[i];
+    factorTridiagonal(lower_, penaltyDiag_, upper_, scratchD_, penaltyM_);
+    solveFactoredTridiagonal(result, lower_, scratchD_, penaltyM_, penaltyRhs_, scratchY_);
+    double maxChange = 0.0;
+    for (size_t i = 1; i <= N_; ++i)
+      maxChange = std::max(maxChange, std::abs(result[i] - penaltyPrev_[i]) / std::max(1.0, std::abs(result[i])));
+    if (maxChange < tol)  // the active set may still flip at the free boundary
+      return;
+  }
+  ORF_ASSERT(0, "TridiagonalOperator1D: the penalty iterations did not converge!");
+}
+
+template<typename ARRAY>
+inline
+void TridiagonalOp1D<ARRAY>::applyToRows(Matrix const& vals,
+                                         Matrix& result,
+                                         size_t firstRow,
+                                         size_t endRow) const
+{
+  size_t nr = endRow - firstRow;
+  for (size_t i = 1; i <= N_; ++i) {
+    double const* vm = vals.colptr(i - 1) + firstRow;
+    double const* v = vals.colptr(i) + firstRow;
+    double const* vp = vals.colptr(i + 1) + firstRow;
+    double* res = result.colptr(i) + firstRow;
+    // the boundary values are folded in the first and last rows of the operator
+    double lo = i > 1 ? lower_[i] : 0.0, di = diag_[i], up = i < N_ ? upper_[i] : 0.0;
+    double c = i == 1 ? LowerVal_ : (i == N_ ? UpperVal_ : 0.0);
+    for (size_t r = 0; r < nr; ++r)
+      res[r] = c + lo * vm[r] + di * v[r] + up * vp[r];
+  }
+}
+
 template<typename ARRAY>
 inline
 double TridiagonalOp1D<ARRAY>::adjustForLowerBoundaryCondition(
@@ -0,0 +1,156 @@
+/**
+@file  workerpool.hpp
+@brief A pool of threads running the same task on contiguous chunks of an index range
+*/
+
+#ifndef ORF_WORKERPOOL_HPP
+#define ORF_WORKERPOOL_HPP
+
+#include <orflib/exception.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+BEGIN_NAMESPACE(orf)
+
+/** A fixed pool of threads for the many short parallel loops of a PDE solver, e.g. the independent
+    line solves of an ADI sweep. The threads are started once and wait between loops,
+    so that a loop costs a wake-up instead of a thread start.
+    The calling thread works on the first chunk, so a pool of one thread runs everything serially.
+*/
+class WorkerPool
+{
+public:
+  /** The task, called with the chunk [begin, end) and the index of the thread running it */
+  using Task = std::function<void(size_t begin, size_t end, size_t threadIdx)>;
+
+  /** Ctor; nThreads is the total number of threads including the caller, 0 for the hardware threads */
+  explicit WorkerPool(size_t nThreads = 0);
+
+  /** Dtor; stops and joins the threads */
+  ~WorkerPool();
+
+  WorkerPool(WorkerPool const&) = delete;
+  WorkerPool& operator=(WorkerPool const&) = delete;
+
+  /** The total number of threads, including the calling one */
+  size_t nThreads() const { return nThreads_; }
+
+  /** Splits [0, n) in one contiguous chunk per thread, runs the task on all chunks and returns when
+      all are done. If a task throws, the first exception in thread order is rethrown.
+      CAUTION: not reentrant; the task must not call run() on the same pool.
+  */
+  void run(size_t n, Task const& task);
+
+private:
+  void work(size_t threadIdx);
+  void runChunk(size_t threadIdx);
+
+  size_t nThreads_;
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable startCv_, doneCv_;
+  Task const* task_;       // the task of the current loop
+  size_t n_;               // the size of the index range of the current loop
+  size_t generation_;      // incremented for each loop, so that the workers run each loop once
+  size_t pending_;         // the number of workers still running the current loop
+  bool stop_;
+  std::vector<std::exception_ptr> errors_;  // one per thread
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+inline
+WorkerPool::WorkerPool(size_t nThreads)
+: nThreads_(nThreads), task_(nullptr), n_(0), generation_(0), pending_(0), stop_(false)
+{
+  if (nThreads_ == 0)
+    nThreads_ = std::max(1u, std::thread::hardware_concurrency());
+  errors_.resize(nThreads_);
+  for (size_t t = 1; t < nThreads_; ++t)
+    threads_.emplace_back(&WorkerPool::work, this, t);
+}
+
+inline
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  startCv_.notify_all();
+  for (auto& th : threads_)
+    th.join();
+}
+
+inline
+void WorkerPool::run(size_t n, Task const& task)
+{
+  if (nThreads_ == 1 || n < 2) {
+    task(0, n, 0);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    n_ = n;
+    pending_ = nThreads_ - 1;
+    std::fill(errors_.begin(), errors_.end(), std::exception_ptr());
+    ++generation_;
+  }
+  startCv_.notify_all();
+  runChunk(0);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCv_.wait(lock, [this]() { return pending_ == 0; });
+    task_ = nullptr;
+  }
+  for (auto const& err : errors_)
+    if (err)
+      std::rethrow_exception(err);
+}
+
+inline
+void WorkerPool::runChunk(size_t threadIdx)
+{
+  size_t begin = n_ * threadIdx / nThreads_;
+  size_t end = n_ * (threadIdx + 1) / nThreads_;
+  try {
+    if (begin < end)
+      (*task_)(begin, end, threadIdx);
+  }
+  catch (...) {
+    errors_[threadIdx] = std::current_exception();
+  }
+}
+
+inline
+void WorkerPool::work(size_t threadIdx)
+{
+  size_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      startCv_.wait(lock, [this, seen]() { return stop_ || generation_ != seen; });
+      if (stop_)
+        return;
+      seen = generation_;
+    }
+    // task_ and n_ are not modified until all workers are done with this loop
+    runChunk(threadIdx);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_ == 0)
+        doneCv_.notify_one();
+    }
+  }
+}
+
+END_NAMESPACE(orf)
+
+#endif  // #ifndef ORF_WORKERPOOL_HPP
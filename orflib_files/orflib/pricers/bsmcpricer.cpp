@@ -18,9 +18,21 @@ BsMcPricer::BsMcPricer(SPtrProduct prod,
                        double volatility,
                        double spot,
                        McParams mcparams)
-: prod_(prod), discyc_(discountCurve), divyld_(divYield), vol_(volatility),
-spot_(spot), mcparams_(mcparams)
+: BsMcPricer(prod, discountCurve, divYield,
+             std::make_shared<VolatilityTermStructure>(volatility), spot, mcparams)
+{}
+
+BsMcPricer::BsMcPricer(SPtrProduct prod,
+                       SPtrYieldCurve discountCurve,
+                       double divYield,
+                       SPtrVolatilityTermStructure volatility,
+                       double spot,
+                       McParams mcparams)
+: prod_(prod), discyc_(discountCurve), divyld_(divYield), volts_(volatility),
+spot_(spot), mcparams_(mcparams), isShiftOptimized_(false), meanShift_(0.0), varRedFactor_(1.0)
 {
+  ORF_ASSERT(volts_, "BsMcPricer: the volatility term structure is missing!");
+
   // Get the simulation times
   Vector timesteps = prod->fixTimes();
   size_t ntimesteps = timesteps.size();
@@ -55,13 +67,15 @@ spot_(spot), mcparams_(mcparams)
     discfactors_[i] = discyc_->discount(paytimes[i]);
 
   // Pre-compute the stdevs and drifts from time step to time step
+  // Term structure effects are folded in here, the hot loop only reads the tables
   Vector const& fixtimes = prod->fixTimes();
   double t1 = 0.0;
   drifts_.resize(fixtimes.size());
   stdevs_.resize(fixtimes.size());
   for (size_t i = 0; i < fixtimes.size(); ++i) {
     double t2 = fixtimes[i];
-    double var = vol_ * vol_ * (t2 - t1);
+    double fwdvol = volts_->fwdVol(t1, t2);
+    double var = fwdvol * fwdvol * (t2 - t1);
     stdevs_[i] = sqrt(var);
     double fwdrate = discyc_->fwdRate(t1, t2);
     // risk free rate less yield plus convexity adjustment
@@ -69,6 +83,10 @@ spot_(spot), mcparams_(mcparams)
     t1 = t2;
   }
 
+  // Keep the step variances for the product, for monitoring between fixings
+  initspots_ = Vector(1, arma::fill::value(spot_));
+  stepvars_ = Matrix(stdevs_ % stdevs_);
+
   // Resize the payment amounts
   payamts_.resize(prod->payTimes().size());
 
@@ -85,14 +103,77 @@ double BsMcPricer::processOnePath(Matrix& pricePath)
     pricePath(i, 0) = spot * exp(drifts_[i] + stdevs_[i] * normaldeviate);
     spot = pricePath(i, 0);
   }
-  prod_->eval(pricePath);
+  prod_->evalWithDynamics(pricePath, initspots_, stepvars_);
   payamts_ = prod_->payAmounts();
 
   double pv = 0.0;
   for (size_t i = 0; i < payamts_.size(); ++i)
     pv += discfactors_[i] * payamts_[i];
 
-  return pv;
+  return pv * pathgen_->likelihoodRatio();
+}
+
+void BsMcPricer::setMeanShift(double shift)
+{
+  // spread the shift over the time steps in proportion to sqrt(dt),
+  // i.e. a constant drift change of the Brownian motion
+  Vector const& fixtimes = prod_->fixTimes();
+  double T = fixtimes[fixtimes.size() - 1];
+  Matrix mushift(fixtimes.size(), 1);
+  double t1 = 0.0;
+  for (size_t i = 0; i < fixtimes.size(); ++i) {
+    double t2 = fixtimes[i];
+    mushift(i, 0) = shift * sqrt((t2 - t1) / T);
+    t1 = t2;
+  }
+  pathgen_->setMeanShift(mushift);
+  meanShift_ = shift;
+}
+
+void BsMcPricer::optimizeMeanShift()
+{
+  // the variance proxy is the sample variance of the weighted PV on a pilot run
+  // per candidate shift; candidates with too few non-zero PVs are not reliable
+  const double maxShift = 5.0, shiftStep = 0.25;
+  const unsigned long minHits = 10;
+  Matrix pricePath(pathgen_->nTimeSteps(), pathgen_->nFactors());
+  unsigned long npilot = mcparams_.nPilotPaths;
+  ORF_ASSERT(npilot > 1, "BsMcPricer: need more than one pilot path for importance sampling!");
+
+  double bestShift = 0.0, bestVar = -1.0;
+  for (double shift = -maxShift; shift <= maxShift + 1.0e-8; shift += shiftStep) {
+    setMeanShift(shift);
+    // Welford's update, so that a constant PV gives exactly zero variance
+    double mean = 0.0, m2 = 0.0;
+    unsigned long nhits = 0;
+    for (unsigned long i = 0; i < npilot; ++i) {
+      double pv = processOnePath(pricePath);
+      double delta = pv - mean;
+      mean += delta / (i + 1);
+      m2 += delta * (pv - mean);
+      if (pv != 0.0)
+        ++nhits;
+    }
+    double var = m2 / npilot;
+    if (nhits >= minHits && (bestVar < 0.0 || var < bestVar)) {
+      bestVar = var;
+      bestShift = shift;
+    }
+  }
+  setMeanShift(bestShift);
+  isShiftOptimized_ = true;
+}
+
+unsigned long BsMcPricer::initStratification(unsigned long npaths)
+{
+  if (mcparams_.samplingType == McParams::SamplingType::PLAIN)
+    return 1;
+
+  unsigned long nstrata = mcparams_.nStrata;
+  ORF_ASSERT(nstrata > 1, "BsMcPricer: the number of strata must be greater than one!");
+  ORF_ASSERT(npaths % nstrata == 0, "BsMcPricer: the number of paths must be a multiple of the number of strata!");
+  pathgen_->setStratification(nstrata, mcparams_.samplingType == McParams::SamplingType::LATINHYPERCUBE);
+  return nstrata;
 }
 
 END_NAMESPACE(orf)
@@ -8,6 +8,7 @@
 
 #include <orflib/products/product.hpp>
 #include <orflib/market/yieldcurve.hpp>
+#include <orflib/market/volatilitytermstructure.hpp>
 #include <orflib/methods/montecarlo/mcparams.hpp>
 #include <orflib/methods/montecarlo/pathgenerator.hpp>
 #include <orflib/methods/montecarlo/eulerpathgenerator.hpp>
@@ -20,7 +21,7 @@ BEGIN_NAMESPACE(orf)
 class BsMcPricer
 {
 public:
-  /** Initializing ctor */
+  /** Initializing ctor with a constant volatility */
   BsMcPricer(SPtrProduct prod,
              SPtrYieldCurve discountYieldCurve,
              double divYield,
@@ -28,6 +29,14 @@ public:
              double spot,
              McParams mcparams);
 
+  /** Initializing ctor with a volatility term structure */
+  BsMcPricer(SPtrProduct prod,
+             SPtrYieldCurve discountYieldCurve,
+             double divYield,
+             SPtrVolatilityTermStructure volatility,
+             double spot,
+             McParams mcparams);
+
   /** Returns the number of variables that can be tracked for stats */
   size_t nVariables();
 
@@ -35,27 +44,51 @@ public:
   template<typename ITER>
   void simulate(StatisticsCalculator<ITER>& statsCalc, unsigned long npaths);
 
+  /** Returns the importance sampling shift of the terminal standard normal deviate; 0 if none */
+  double meanShift() const;
+
+  /** Returns the variance reduction factor of the last simulation relative to plain MC;
+      1 if importance sampling is off */
+  double varianceReductionFactor() const;
+
 protected:
 
   /** Creates and processes one price path.
-      It returns the PV of the product
+      It returns the PV of the product, weighted by the likelihood ratio of the path
       */
   double processOnePath(Matrix& pricePath);
 
+  /** Sets the path generator mean shifts so that the terminal standard normal deviate is shifted by shift */
+  void setMeanShift(double shift);
+
+  /** Chooses the mean shift that minimizes the variance of the PV on pilot runs */
+  void optimizeMeanShift();
+
+  /** Sets up stratified sampling on the path generator for a run of npaths paths.
+      Returns the number of paths per block of strata, 1 if there is no stratification.
+  */
+  unsigned long initStratification(unsigned long npaths);
+
 private:
   SPtrProduct prod_;      // pointer to the product
   SPtrYieldCurve discyc_; // pointer to the discount curve
   double divyld_;         // the constant dividend yield   
-  double vol_;            // the constant volatility
+  SPtrVolatilityTermStructure volts_; // the volatility term structure
   double spot_;           // the initial spot
   McParams mcparams_;     // the Monte Carlo parameters
 
   SPtrPathGenerator pathgen_;  // pointer to the path generator
   Vector discfactors_;         // caches the pre-computed discount factors
-  Vector drifts_;              // caches the pre-computed asset drifts
-  Vector stdevs_;              // caches the pre-computed standard deviations 
+  Vector drifts_;              // caches the pre-computed asset drifts, from fwd rates and fwd vols
+  Vector stdevs_;              // caches the pre-computed standard deviations, from fwd vols
+  Vector initspots_;           // the initial spot, passed to the product with the step variances
+  Matrix stepvars_;            // caches the step variances, for products that monitor between fixings
 
   Vector payamts_;             // scratch array for writing the payments after each simulation
+
+  bool isShiftOptimized_;      // true after the pilot runs for importance sampling
+  double meanShift_;           // the shift of the terminal standard normal deviate
+  double varRedFactor_;        // the variance reduction factor of the last simulation
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -75,13 +108,53 @@ void BsMcPricer::simulate(StatisticsCalculator<ITER>& statsCalc, unsigned long n
   // check the size of the statistics calcuilator
   ORF_ASSERT(statsCalc.nVariables() == nVariables(), "the statistics calculator must track only one variable!");
 
+  // choose the importance sampling shift on pilot runs, only once
+  if (mcparams_.impSampling && !isShiftOptimized_)
+    optimizeMeanShift();
+
+  // with stratified sampling, the samples are the averages over blocks of whole strata
+  unsigned long blocksize = initStratification(npaths);
+
   // This is the HOT loop
+  double sum = 0.0, sum2 = 0.0, sumPlain2 = 0.0, blocksum = 0.0;
   for (unsigned long i = 0; i < npaths; ++i) {
     double pv = processOnePath(pricePath);
-    statsCalc.addSample(&pv, &pv + 1);
+    blocksum += pv;
+    if ((i + 1) % blocksize == 0) {
+      double blockpv = blocksum / blocksize;
+      statsCalc.addSample(&blockpv, &blockpv + 1);
+      blocksum = 0.0;
+    }
+    if (mcparams_.impSampling) {
+      sum += pv;
+      sum2 += pv * pv;
+      sumPlain2 += pv * pv / pathgen_->likelihoodRatio();  // second moment under the original measure
+    }
+  }
+
+  // estimate the plain MC variance from the same samples
+  varRedFactor_ = 1.0;
+  if (mcparams_.impSampling && npaths > 1) {
+    double mean = sum / npaths;
+    double varIS = sum2 / npaths - mean * mean;
+    double varPlain = sumPlain2 / npaths - mean * mean;
+    if (varIS > 0.0)
+      varRedFactor_ = varPlain / varIS;
   }
 }
 
+inline
+double BsMcPricer::meanShift() const
+{
+  return meanShift_;
+}
+
+inline
+double BsMcPricer::varianceReductionFactor() const
+{
+  return varRedFactor_;
+}
+
 END_NAMESPACE(orf)
 
 #endif // ORF_PRODUCT_HPP
@@ -12,6 +12,15 @@ using namespace std;
 
 BEGIN_NAMESPACE(orf)
 
+// Helper that wraps each constant volatility into a flat term structure
+static std::vector<SPtrVolatilityTermStructure> flatVolatilities(Vector const& volatilities)
+{
+  std::vector<SPtrVolatilityTermStructure> vts(volatilities.size());
+  for (size_t j = 0; j < volatilities.size(); ++j)
+    vts[j] = std::make_shared<VolatilityTermStructure>(volatilities[j]);
+  return vts;
+}
+
 MultiAssetBsMcPricer::MultiAssetBsMcPricer(SPtrProduct prod,
                                            SPtrYieldCurve discountCurve,
                                            Vector const& divYields,
@@ -19,6 +28,17 @@ MultiAssetBsMcPricer::MultiAssetBsMcPricer(SPtrProduct prod,
                                            Vector const& spots,
                                            Matrix const& correlMatrix,
                                            McParams const& mcparams)
+: MultiAssetBsMcPricer(prod, discountCurve, divYields, flatVolatilities(volatilities),
+                       spots, correlMatrix, mcparams)
+{}
+
+MultiAssetBsMcPricer::MultiAssetBsMcPricer(SPtrProduct prod,
+                                           SPtrYieldCurve discountCurve,
+                                           Vector const& divYields,
+                                           std::vector<SPtrVolatilityTermStructure> const& volatilities,
+                                           Vector const& spots,
+                                           Matrix const& correlMatrix,
+                                           McParams const& mcparams)
 : prod_(prod), discyc_(discountCurve), divylds_(divYields), vols_(volatilities),
 spots_(spots), mcparams_(mcparams)
 {
@@ -30,6 +50,8 @@ spots_(spots), mcparams_(mcparams)
   size_t nassets = prod->nAssets();
   ORF_ASSERT(divYields.size() == nassets, "need as many div yields as product assets!");
   ORF_ASSERT(volatilities.size() == nassets, "need as many volatilities as product assets!");
+  for (size_t j = 0; j < nassets; ++j)
+    ORF_ASSERT(volatilities[j], "missing volatility term structure!");
   ORF_ASSERT(spots.size() == nassets, "need as many spots as product assets!");
   if (nassets > 1) {
     ORF_ASSERT(correlMatrix.is_square(), "the correlation matrix must be square!");
@@ -66,6 +88,7 @@ spots_(spots), mcparams_(mcparams)
     discfactors_[i] = discyc_->discount(paytimes[i]);
 
   // Pre-compute the stdevs and drifts from time step to time step
+  // Term structure effects are folded in here, the hot loop only reads the tables
   Vector const& fixtimes = prod->fixTimes();
   drifts_.resize(fixtimes.size(), nassets);
   stdevs_.resize(fixtimes.size(), nassets);
@@ -76,8 +99,9 @@ spots_(spots), mcparams_(mcparams)
     // loop over fixing times
     for (size_t i = 0; i < fixtimes.size(); ++i) {
       double t2 = fixtimes[i];
-      double var = vols_[j] * vols_[j] * (t2 - t1);
-      stdevs_(i, j) = vols_[j];
+      double fwdvol = vols_[j]->fwdVol(t1, t2);
+      double var = fwdvol * fwdvol * (t2 - t1);
+      stdevs_(i, j) = sqrt(var);
       double fwdrate = discyc_->fwdRate(t1, t2);
       // risk free rate less yield plus convexity adjustment
       drifts_(i, j) = (fwdrate - divylds_[j]) * (t2 - t1) - 0.5 * var;
@@ -85,6 +109,9 @@ spots_(spots), mcparams_(mcparams)
     }
   }
 
+  // Keep the step variances for the product, for monitoring between fixings
+  stepvars_ = stdevs_ % stdevs_;
+
   // Resize the payment amounts
   payamts_.resize(prod->payTimes().size());
 
@@ -103,7 +130,7 @@ double MultiAssetBsMcPricer::processOnePath(Matrix& pricePath)
       currspots_[j] = pricePath(i, j);  // store the spot for the next time step
     }
   }
-  prod_->eval(pricePath);
+  prod_->evalWithDynamics(pricePath, spots_, stepvars_);
   payamts_ = prod_->payAmounts();
 
   double pv = 0.0;
@@ -113,4 +140,16 @@ double MultiAssetBsMcPricer::processOnePath(Matrix& pricePath)
   return pv;
 }
 
+unsigned long MultiAssetBsMcPricer::initStratification(unsigned long npaths)
+{
+  if (mcparams_.samplingType == McParams::SamplingType::PLAIN)
+    return 1;
+
+  unsigned long nstrata = mcparams_.nStrata;
+  ORF_ASSERT(nstrata > 1, "MultiAssetBsMcPricer: the number of strata must be greater than one!");
+  ORF_ASSERT(npaths % nstrata == 0, "MultiAssetBsMcPricer: the number of paths must be a multiple of the number of strata!");
+  pathgen_->setStratification(nstrata, mcparams_.samplingType == McParams::SamplingType::LATINHYPERCUBE);
+  return nstrata;
+}
+
 END_NAMESPACE(orf)
@@ -9,9 +9,11 @@
 
 #include <orflib/products/product.hpp>
 #include <orflib/market/yieldcurve.hpp>
+#include <orflib/market/volatilitytermstructure.hpp>
 #include <orflib/methods/montecarlo/mcparams.hpp>
 #include <orflib/methods/montecarlo/pathgenerator.hpp>
 #include <orflib/math/stats/statisticscalculator.hpp>
+#include <vector>
 
 BEGIN_NAMESPACE(orf)
 
@@ -22,7 +24,7 @@ class MultiAssetBsMcPricer
 {
 
 public:
-  /** Initializing ctor */
+  /** Initializing ctor with constant volatilities */
   MultiAssetBsMcPricer(SPtrProduct prod,
                        SPtrYieldCurve discountYieldCurve,
                        Vector const& divYields,
@@ -31,6 +33,15 @@ public:
                        Matrix const& correlMatrix,
                        McParams const& mcparams);
 
+  /** Initializing ctor with volatility term structures, one per asset */
+  MultiAssetBsMcPricer(SPtrProduct prod,
+                       SPtrYieldCurve discountYieldCurve,
+                       Vector const& divYields,
+                       std::vector<SPtrVolatilityTermStructure> const& volatilities,
+                       Vector const& spots,
+                       Matrix const& correlMatrix,
+                       McParams const& mcparams);
+
   /** Returns the number of variables that can be tracked for stats */
   size_t nVariables();
 
@@ -45,18 +56,24 @@ protected:
   */
   double processOnePath(Matrix& pricePath);
 
+  /** Sets up stratified sampling on the path generator for a run of npaths paths.
+      Returns the number of paths per block of strata, 1 if there is no stratification.
+  */
+  unsigned long initStratification(unsigned long npaths);
+
 private:
   SPtrProduct prod_;               // pointer to the product
   SPtrYieldCurve discyc_;          // pointer to the discount curve
   Vector divylds_;                 // the constant dividend yield, one per asset   
-  Vector vols_;                    // the constant volatility, one per asset
+  std::vector<SPtrVolatilityTermStructure> vols_;  // the volatility term structures, one per asset
   Vector spots_;                   // the initial spots, one per asset
   McParams mcparams_;              // the Monte Carlo parameters
 
   SPtrPathGenerator pathgen_;  // pointer to the path generator
   Vector discfactors_;         // caches the pre-computed discount factors
   Matrix drifts_;              // caches the pre-computed asset drifts, one column per asset
-  Matrix stdevs_;              // caches the pre-computed standard deviations, one column per asset 
+  Matrix stdevs_;              // caches the pre-computed step standard deviations, one column per asset 
+  Matrix stepvars_;            // caches the step variances, for products that monitor between fixings
 
   Vector currspots_;           // scratch array with the current spots, one per asset
   Vector payamts_;             // scratch array for writting the payments after each simulation
@@ -79,10 +96,19 @@ void MultiAssetBsMcPricer::simulate(StatisticsCalculator<ITER>& statsCalc, unsig
   // check the size of the statistics calculator
   ORF_ASSERT(statsCalc.nVariables() == nVariables(), "the statistics calculator must track as many variables as the pricer captures!");
 
+  // with stratified sampling, the samples are the averages over blocks of whole strata
+  unsigned long blocksize = initStratification(npaths);
+
   // This is the HOT loop
+  double blocksum = 0.0;
   for (unsigned long i = 0; i < npaths; ++i) {
     double pv = processOnePath(pricePath);
-    statsCalc.addSample(&pv, &pv + 1);
+    blocksum += pv;
+    if ((i + 1) % blocksize == 0) {
+      double blockpv = blocksum / blocksize;
+      statsCalc.addSample(&blockpv, &blockpv + 1);
+      blocksum = 0.0;
+    }
   }
 }
 
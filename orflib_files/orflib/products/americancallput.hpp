@@ -7,6 +7,7 @@
 #define ORF_AMERICANCALLPUT_HPP
 
 #include <orflib/products/europeancallput.hpp>
+#include <limits>
 
 BEGIN_NAMESPACE(orf)
 
@@ -21,6 +22,22 @@ public:
   /** Evaluates the product at fixing time index idx
   */
   virtual void eval(size_t idx, Vector const& pricePath, double contValue);
+
+  /** Evaluates the product at fixing time index idx on all the nodes of a PDE grid
+  */
+  virtual void evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values) override;
+
+  /** The intrinsic value as lower bound, before expiration
+  */
+  virtual bool exerciseBounds(size_t idx, Vector const& spotLevels, Vector& lower, Vector& upper) const override;
+
+  /** The larger of the intrinsic value and the discounted payoff at the forward
+  */
+  virtual bool asymptoticValue(double t, double S, double df, double fwd, double& value) const override;
+
+  /** The expiration, where the payoff has its kink; the daily exercise dates need not all be visited
+  */
+  virtual std::vector<double> criticalTimes() const override { return std::vector<double>(1, timeToExp_); }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -63,6 +80,42 @@ inline void AmericanCallPut::eval(size_t idx, Vector const& spots, double contVa
   }
 }
 
+inline void AmericanCallPut::evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values)
+{
+  bool last = idx == payAmounts_.size() - 1;
+  for (size_t i = 0; i < spotLevels.size(); ++i) {
+    double intrinsicValue = (spotLevels[i] - strike_) * payoffType_;
+    intrinsicValue = intrinsicValue >= 0.0 ? intrinsicValue : 0.0;
+    // at expiration the payoff, otherwise the larger of the continuation and the exercise values
+    if (last || values[i] < intrinsicValue)
+      values[i] = intrinsicValue;
+  }
+}
+
+inline bool AmericanCallPut::exerciseBounds(size_t idx, Vector const& spotLevels,
+                                            Vector& lower, Vector& upper) const
+{
+  if (idx == payAmounts_.size() - 1)  // the payoff is set at expiration, there is no choice left
+    return false;
+  lower.set_size(spotLevels.size());
+  upper.set_size(spotLevels.size());
+  for (size_t i = 0; i < spotLevels.size(); ++i) {
+    double intrinsicValue = (spotLevels[i] - strike_) * payoffType_;
+    lower[i] = intrinsicValue >= 0.0 ? intrinsicValue : 0.0;
+  }
+  upper.fill(std::numeric_limits<double>::infinity());
+  return true;
+}
+
+inline bool AmericanCallPut::asymptoticValue(double t, double S, double df, double fwd, double& value) const
+{
+  EuropeanCallPut::asymptoticValue(t, S, df, fwd, value);
+  double intrinsicValue = (S - strike_) * payoffType_;
+  if (intrinsicValue > value)
+    value = intrinsicValue;
+  return true;
+}
+
 END_NAMESPACE(orf)
 
 #endif // ORF_AMERICANCALLPUT_HPP
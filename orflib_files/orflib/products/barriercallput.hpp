@@ -0,0 +1,210 @@
+/**
+@file  barriercallput.hpp
+@brief The payoff of a European barrier Call/Put option
+*/
+
+#ifndef ORF_BARRIERCALLPUT_HPP
+#define ORF_BARRIERCALLPUT_HPP
+
+#include <orflib/products/product.hpp>
+#include <cmath>
+
+BEGIN_NAMESPACE(orf)
+
+/** The European barrier call/put class.
+    The barrier is monitored at the fixing times, which are equally spaced up to expiration.
+    With the Brownian bridge correction, the probability of crossing the barrier between two
+    consecutive fixings is accounted for, so that the price converges to the continuously
+    monitored barrier even on a coarse fixing grid.
+    On a PDE grid the knock-out barriers are monitored at the fixing times only.
+*/
+class BarrierCallPut : public Product
+{
+public:
+  /** The barrier types */
+  enum class BarrierType
+  {
+    UPOUT,
+    UPIN,
+    DOWNOUT,
+    DOWNIN
+  };
+
+  /** Initializing ctor */
+  BarrierCallPut(int payoffType,
+                 double strike,
+                 double timeToExp,
+                 BarrierType barrierType,
+                 double barrier,
+                 size_t nFixings,
+                 bool bridgeCorrection = true);
+
+  /** The number of assets this product depends on */
+  virtual size_t nAssets() const override { return 1; }
+
+  /** Evaluates the product given the passed-in path, monitored at the fixing times only
+      The "pricePath" matrix must have as many rows as
+      the number of fixing times
+  */
+  virtual void eval(Matrix const& pricePath) override;
+
+  /** Same as above, with the Brownian bridge correction between the fixings
+      computed from the initial spot and the step variances
+  */
+  virtual void evalWithDynamics(Matrix const& pricePath, Vector const& spots, Matrix const& stepVariances) override;
+
+  /** Evaluates a knock-out barrier at fixing time index idx, for a backward PDE sweep:
+      zero if the spot is knocked, otherwise the payoff at expiration and the continuation value before.
+      The value goes to the single payment amount. Knock-in barriers need the path and are not supported.
+  */
+  virtual void eval(size_t idx, Vector const& spots, double contValue) override;
+
+  /** Same as above on all the nodes of a 1-d PDE grid
+  */
+  virtual void evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values) override;
+
+protected:
+  /** Returns true if the spot is on the knocked side of the barrier */
+  bool isKnocked(double spot) const;
+
+  /** Returns the probability of not crossing the barrier between s1 and s2,
+      for a Brownian bridge in log-spot with variance var */
+  double bridgeSurvivalProb(double s1, double s2, double var) const;
+
+  /** Sets the payment amount for the path; with stepVariances, one per fixing, the crossing
+      probabilities between the fixings are accounted for, starting from the initial spot */
+  void evalPath(Matrix const& pricePath, double spot, double const* stepVariances);
+
+  /** Returns the value at fixing time index idx of a knock-out barrier for the spot S */
+  double knockOutValue(size_t idx, double S, double contValue) const;
+
+  int payoffType_;         // 1: call; -1 put
+  double strike_;
+  double timeToExp_;
+  BarrierType barrierType_;
+  double barrier_;
+  bool bridgeCorrection_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+inline
+BarrierCallPut::BarrierCallPut(int payoffType,
+                               double strike,
+                               double timeToExp,
+                               BarrierType barrierType,
+                               double barrier,
+                               size_t nFixings,
+                               bool bridgeCorrection)
+: payoffType_(payoffType), strike_(strike), timeToExp_(timeToExp),
+  barrierType_(barrierType), barrier_(barrier), bridgeCorrection_(bridgeCorrection)
+{
+  ORF_ASSERT(payoffType == 1 || payoffType == -1, "BarrierCallPut: the payoff type must be 1 (call) or -1 (put)!");
+  ORF_ASSERT(strike > 0.0, "BarrierCallPut: the strike must be positive!");
+  ORF_ASSERT(timeToExp > 0.0, "BarrierCallPut: the time to expiration must be positive!");
+  ORF_ASSERT(barrier > 0.0, "BarrierCallPut: the barrier must be positive!");
+  ORF_ASSERT(nFixings > 0, "BarrierCallPut: need at least one fixing!");
+
+  // equally spaced monitoring times, the last one at expiration
+  fixTimes_.resize(nFixings);
+  for (size_t i = 0; i < nFixings; ++i)
+    fixTimes_[i] = timeToExp_ * (i + 1) / nFixings;
+  fixTimes_[nFixings - 1] = timeToExp_;
+
+  // assume that it will settle (pay) at expiration
+  payTimes_.resize(1);
+  payTimes_[0] = timeToExp_;
+
+  // this product generates only one payment
+  payAmounts_.resize(1);
+}
+
+inline
+bool BarrierCallPut::isKnocked(double spot) const
+{
+  if (barrierType_ == BarrierType::UPOUT || barrierType_ == BarrierType::UPIN)
+    return spot >= barrier_;
+  else
+    return spot <= barrier_;
+}
+
+inline
+double BarrierCallPut::bridgeSurvivalProb(double s1, double s2, double var) const
+{
+  if (var <= 0.0)
+    return 1.0;
+  double crossProb = std::exp(-2.0 * std::log(s1 / barrier_) * std::log(s2 / barrier_) / var);
+  return 1.0 - crossProb;
+}
+
+inline void BarrierCallPut::eval(Matrix const& pricePath)
+{
+  ORF_ASSERT(!bridgeCorrection_,
+    "BarrierCallPut: the Brownian bridge correction requires the path dynamics!");
+  evalPath(pricePath, 0.0, nullptr);
+}
+
+inline void BarrierCallPut::evalWithDynamics(Matrix const& pricePath, Vector const& spots, Matrix const& stepVariances)
+{
+  ORF_ASSERT(stepVariances.n_rows == fixTimes_.size(),
+    "BarrierCallPut: number of step variances mismatch with fixing times!");
+  evalPath(pricePath, spots[0], bridgeCorrection_ ? stepVariances.colptr(0) : nullptr);
+}
+
+inline void BarrierCallPut::evalPath(Matrix const& pricePath, double spot, double const* stepVariances)
+{
+  size_t nfixings = pricePath.n_rows;
+  ORF_ASSERT(fixTimes_.size() == nfixings,
+    "BarrierCallPut: number of fixings mismatch in price path!");
+
+  // the probability of the path not touching the barrier
+  double survivalProb = (spot > 0.0 && isKnocked(spot)) ? 0.0 : 1.0;
+  double s1 = spot;
+  for (size_t i = 0; i < nfixings && survivalProb > 0.0; ++i) {
+    double s2 = pricePath(i, 0);
+    if (isKnocked(s2))
+      survivalProb = 0.0;
+    else if (stepVariances)
+      survivalProb *= bridgeSurvivalProb(s1, s2, stepVariances[i]);
+    s1 = s2;
+  }
+
+  double S_T = pricePath(nfixings - 1, 0);
+  double payoff = (S_T - strike_) * payoffType_;
+  payoff = payoff > 0.0 ? payoff : 0.0;
+
+  if (barrierType_ == BarrierType::UPOUT || barrierType_ == BarrierType::DOWNOUT)
+    payAmounts_[0] = payoff * survivalProb;
+  else
+    payAmounts_[0] = payoff * (1.0 - survivalProb);
+}
+
+inline double BarrierCallPut::knockOutValue(size_t idx, double S, double contValue) const
+{
+  if (isKnocked(S))
+    return 0.0;
+  if (idx + 1 < fixTimes_.size())
+    return contValue;
+  double payoff = (S - strike_) * payoffType_;
+  return payoff > 0.0 ? payoff : 0.0;
+}
+
+inline void BarrierCallPut::eval(size_t idx, Vector const& spots, double contValue)
+{
+  ORF_ASSERT(barrierType_ == BarrierType::UPOUT || barrierType_ == BarrierType::DOWNOUT,
+    "BarrierCallPut: knock-in barriers cannot be evaluated at a fixing, they depend on the path!");
+  payAmounts_[0] = knockOutValue(idx, spots[0], contValue);
+}
+
+inline void BarrierCallPut::evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values)
+{
+  ORF_ASSERT(barrierType_ == BarrierType::UPOUT || barrierType_ == BarrierType::DOWNOUT,
+    "BarrierCallPut: knock-in barriers cannot be evaluated at a fixing, they depend on the path!");
+  for (size_t i = 0; i < spotLevels.size(); ++i)
+    values[i] = knockOutValue(idx, spotLevels[i], values[i]);
+}
+
+END_NAMESPACE(orf)
+
+#endif // ORF_BARRIERCALLPUT_HPP
@@ -0,0 +1,150 @@
+/**
+@file  basketcallput.hpp
+@brief The payoff of a European or American Call/Put option on a basket of assets
+*/
+
+#ifndef ORF_BASKETCALLPUT_HPP
+#define ORF_BASKETCALLPUT_HPP
+
+#include <orflib/products/product.hpp>
+
+BEGIN_NAMESPACE(orf)
+
+/** The basket call/put class, paying max(payoffType * (sum_k q_k S_k - strike), 0),
+    where q_k is the quantity of asset k in the basket.
+    With American exercise, the option can be exercised on each day up to expiration,
+    as for AmericanCallPut.
+*/
+class BasketCallPut : public Product
+{
+public:
+  /** Initializing ctor */
+  BasketCallPut(int payoffType, double strike, double timeToExp, Vector const& assetQuantities,
+                bool american = false);
+
+  /** The number of assets this product depends on */
+  virtual size_t nAssets() const override { return assetQuantities_.size(); }
+
+  /** Evaluates the product given the passed-in path, at the last fixing time only;
+      the early exercise of American options is ignored.
+      The "pricePath" matrix must have as many rows as the number of fixing times
+      and one column per asset
+  */
+  virtual void eval(Matrix const& pricePath) override;
+
+  /** Evaluates the product at fixing time index idx
+  */
+  virtual void eval(size_t idx, Vector const& spots, double contValue) override;
+
+  /** Evaluates the product at fixing time index idx on all the nodes of an N-d PDE grid,
+      with the basket values built up one axis at a time
+  */
+  virtual void evalOnGridND(size_t idx, std::vector<Vector> const& spotLevels, Vector& values) override;
+
+protected:
+  /** Returns the payoff for the basket value b */
+  double payoff(double b) const
+  {
+    double payoff = (b - strike_) * payoffType_;
+    return payoff > 0.0 ? payoff : 0.0;
+  }
+
+  int payoffType_;          // 1: call; -1 put
+  double strike_;
+  double timeToExp_;
+  Vector assetQuantities_;  // number of units of each asset in the basket
+  bool american_;
+  Vector basket_;           // the basket values on the grid nodes
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+inline
+BasketCallPut::BasketCallPut(int payoffType, double strike, double timeToExp, Vector const& assetQuantities,
+                             bool american)
+: payoffType_(payoffType), strike_(strike), timeToExp_(timeToExp), assetQuantities_(assetQuantities),
+  american_(american)
+{
+  ORF_ASSERT(payoffType == 1 || payoffType == -1, "BasketCallPut: the payoff type must be 1 (call) or -1 (put)!");
+  ORF_ASSERT(timeToExp > 0.0, "BasketCallPut: the time to expiration must be positive!");
+  ORF_ASSERT(assetQuantities.size() > 0, "BasketCallPut: the basket must hold at least one asset!");
+
+  if (american_) {
+    // one fixing per day between 0 and timeToExp, as for AmericanCallPut
+    size_t nfixings = static_cast<size_t>(timeToExp * DAYS_PER_YEAR) + 1;
+    fixTimes_.resize(nfixings);
+    for (size_t i = 0; i < nfixings - 1; ++i)
+      fixTimes_[i] = i / DAYS_PER_YEAR;
+    fixTimes_[nfixings - 1] = timeToExp_;
+  }
+  else {
+    fixTimes_.resize(1);
+    fixTimes_[0] = timeToExp_;
+  }
+
+  payTimes_ = fixTimes_;
+  payAmounts_.resize(payTimes_.size());
+}
+
+inline void BasketCallPut::eval(Matrix const& pricePath)
+{
+  ORF_ASSERT(pricePath.n_cols == assetQuantities_.size(), "BasketCallPut: number of assets mismatch in price path!");
+  size_t last = pricePath.n_rows - 1;
+  double b = 0.0;
+  for (size_t k = 0; k < assetQuantities_.size(); ++k)
+    b += assetQuantities_[k] * pricePath(last, k);
+  payAmounts_.zeros();
+  payAmounts_[payAmounts_.size() - 1] = payoff(b);
+}
+
+inline void BasketCallPut::eval(size_t idx, Vector const& spots, double contValue)
+{
+  double b = 0.0;
+  for (size_t k = 0; k < assetQuantities_.size(); ++k)
+    b += assetQuantities_[k] * spots[k];
+  double intrinsicValue = payoff(b);
+  if (idx == payAmounts_.size() - 1)  // this is the last index
+    payAmounts_[idx] = intrinsicValue;
+  else {  // check the exercise condition, possible only for American options
+    ORF_ASSERT(american_, "BasketCallPut: wrong fixing time index!");
+    payAmounts_[idx] = contValue >= intrinsicValue ? contValue : intrinsicValue;
+    for (size_t j = idx + 1; j < payAmounts_.size(); ++j)
+      payAmounts_[j] = 0.0;
+  }
+}
+
+inline void BasketCallPut::evalOnGridND(size_t idx, std::vector<Vector> const& spotLevels, Vector& values)
+{
+  bool last = idx == payAmounts_.size() - 1;
+  ORF_ASSERT(last || american_, "BasketCallPut: wrong fixing time index!");
+  ORF_ASSERT(spotLevels.size() == assetQuantities_.size(), "BasketCallPut: number of assets mismatch in grid!");
+
+  // the basket values, adding the axes one at a time: after axis k, the first n_0 * ... * n_k
+  // elements hold the partial baskets on the nodes of the first k + 1 axes
+  basket_.set_size(values.size());
+  size_t n = spotLevels[0].size();
+  for (size_t i = 0; i < n; ++i)
+    basket_[i] = assetQuantities_[0] * spotLevels[0][i];
+  for (size_t k = 1; k < spotLevels.size(); ++k) {
+    for (size_t j = spotLevels[k].size(); j-- > 0; ) {
+      double q = assetQuantities_[k] * spotLevels[k][j];
+      double* dst = basket_.memptr() + j * n;
+      for (size_t i = 0; i < n; ++i)
+        dst[i] = basket_[i] + q;
+    }
+    n *= spotLevels[k].size();
+  }
+  ORF_ASSERT(n == values.size(), "BasketCallPut: the values do not match the grid!");
+
+  for (size_t p = 0; p < n; ++p) {
+    double intrinsicValue = payoff(basket_[p]);
+    // at expiration the payoff, otherwise the larger of the continuation and the exercise values
+    if (last || values[p] < intrinsicValue)
+      values[p] = intrinsicValue;
+  }
+}
+
+END_NAMESPACE(orf)
+
+#endif // ORF_BASKETCALLPUT_HPP
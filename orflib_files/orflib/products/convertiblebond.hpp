@@ -8,6 +8,7 @@
 
 #include <orflib/products/product.hpp>
 #include <algorithm>
+#include <limits>
 #include <vector>  
 BEGIN_NAMESPACE(orf)
 
@@ -30,6 +31,23 @@ public:
 
   virtual void eval(size_t idx, Vector const& spots, double contValue) override;
 
+  /** Evaluates the product at fixing time index idx on all the nodes of a PDE grid */
+  virtual void evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values) override;
+
+  /** The conversion value as lower bound in the conversion window, and the call strike, or the conversion
+      value if larger since the holder can convert when called, as upper bound in the call window */
+  virtual bool exerciseBounds(size_t idx, Vector const& spotLevels, Vector& lower, Vector& upper) const override;
+
+  /** The bond floor for low spots, the conversion value for high spots */
+  virtual bool asymptoticValue(double t, double S, double df, double fwd, double& value) const override;
+
+  /** The face value at maturity unless converted, the call strike where called and not converted,
+      zero where converted */
+  virtual bool evalCashOnGrid(size_t idx, Vector const& spotLevels, Vector const& values, Vector& cash) const override;
+
+  /** The maturity and the boundaries of the conversion and call windows */
+  virtual std::vector<double> criticalTimes() const override;
+
 private:
   double faceValue_;
   double conversionRatio_;
@@ -118,6 +136,103 @@ inline void ConvertibleBond::eval(size_t idx, Vector const& spots, double contVa
   payAmounts_[idx] = bondValue;
 }
 
+inline void ConvertibleBond::evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values)
+{
+  // the call and conversion windows depend only on the time, check them once for all nodes
+  double t = fixTimes_[idx];
+  bool convertible = t >= convStartTime_ && t <= convEndTime_;
+  bool callable = t >= callStartTime_ && t <= callEndTime_;
+  size_t n = spotLevels.size();
+
+  if (idx == fixTimes_.size() - 1) {
+    // At maturity, we can convert or take the face value
+    for (size_t i = 0; i < n; ++i)
+      values[i] = convertible ? std::max(faceValue_, conversionRatio_ * spotLevels[i]) : faceValue_;
+    return;
+  }
+
+  // Induction Logic (for t < T)
+  if (callable) {
+    for (size_t i = 0; i < n; ++i)
+      values[i] = std::min(values[i], callStrike_);
+  }
+  if (convertible) {
+    for (size_t i = 0; i < n; ++i)
+      values[i] = std::max(values[i], conversionRatio_ * spotLevels[i]);
+  }
+}
+
+inline bool ConvertibleBond::exerciseBounds(size_t idx, Vector const& spotLevels,
+                                            Vector& lower, Vector& upper) const
+{
+  double t = fixTimes_[idx];
+  bool convertible = t >= convStartTime_ && t <= convEndTime_;
+  bool callable = t >= callStartTime_ && t <= callEndTime_;
+  if (idx == fixTimes_.size() - 1 || !(convertible || callable))
+    return false;
+
+  size_t n = spotLevels.size();
+  double inf = std::numeric_limits<double>::infinity();
+  lower.set_size(n);
+  upper.set_size(n);
+  for (size_t i = 0; i < n; ++i) {
+    lower[i] = convertible ? conversionRatio_ * spotLevels[i] : -inf;
+    upper[i] = callable ? std::max(callStrike_, lower[i]) : inf;
+  }
+  return true;
+}
+
+inline bool ConvertibleBond::asymptoticValue(double t, double S, double df, double fwd, double& value) const
+{
+  // the value of the conversion now if possible, else at maturity if possible, with the spot at its forward;
+  // when called, the holder converts if the conversion value is above the call strike
+  double T = fixTimes_[fixTimes_.size() - 1];
+  double conversionValue = 0.0;
+  if (t >= convStartTime_ && t <= convEndTime_)
+    conversionValue = conversionRatio_ * S;
+  else if (T >= convStartTime_ && T <= convEndTime_)
+    conversionValue = conversionRatio_ * fwd * df;
+  value = std::max(faceValue_ * df, conversionValue);
+  if (t >= callStartTime_ && t <= callEndTime_)
+    value = std::min(value, std::max(callStrike_, conversionValue));
+  return true;
+}
+
+inline bool ConvertibleBond::evalCashOnGrid(size_t idx, Vector const& spotLevels,
+                                            Vector const& values, Vector& cash) const
+{
+  double t = fixTimes_[idx];
+  bool convertible = t >= convStartTime_ && t <= convEndTime_;
+  bool callable = t >= callStartTime_ && t <= callEndTime_;
+  size_t n = spotLevels.size();
+
+  if (idx == fixTimes_.size() - 1) {
+    for (size_t i = 0; i < n; ++i)
+      cash[i] = convertible && conversionRatio_ * spotLevels[i] > faceValue_ ? 0.0 : faceValue_;
+    return true;
+  }
+
+  // the values are the conversion value where converted, else the call strike where called
+  for (size_t i = 0; i < n; ++i) {
+    if (convertible && values[i] <= conversionRatio_ * spotLevels[i])
+      cash[i] = 0.0;
+    else if (callable && values[i] >= callStrike_)
+      cash[i] = callStrike_;
+  }
+  return true;
+}
+
+inline std::vector<double> ConvertibleBond::criticalTimes() const
+{
+  double T = fixTimes_[fixTimes_.size() - 1];
+  std::vector<double> crit(1, T);
+  for (double t : { convStartTime_, convEndTime_, callStartTime_, callEndTime_ }) {
+    if (t > 0.0 && t < T)
+      crit.push_back(t);
+  }
+  return crit;
+}
+
 END_NAMESPACE(orf)
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+@file  digitalcallput.hpp
+@brief The payoff of a European digital (cash-or-nothing) Call/Put option
+*/
+
+#ifndef ORF_DIGITALCALLPUT_HPP
+#define ORF_DIGITALCALLPUT_HPP
+
+#include <orflib/products/europeancallput.hpp>
+
+BEGIN_NAMESPACE(orf)
+
+/** The European digital call/put class; it pays one unit of cash if it expires in the money
+*/
+class DigitalCallPut : public EuropeanCallPut
+{
+public:
+  /** Initializing ctor */
+  DigitalCallPut(int payoffType, double strike, double timeToExp);
+
+  /** Evaluates the product given the passed-in path
+      The "pricePath" matrix must have as many rows as
+      the number of fixing times
+  */
+  virtual void eval(Matrix const& pricePath) override;
+
+  /** Evaluates the product at fixing time index idx
+  */
+  virtual void eval(size_t idx, Vector const& spots, double contValue) override;
+
+  /** Evaluates the product at fixing time index idx on all the nodes of a PDE grid
+  */
+  virtual void evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values) override;
+
+  /** The discounted payoff at the forward
+  */
+  virtual bool asymptoticValue(double t, double S, double df, double fwd, double& value) const override;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+inline
+DigitalCallPut::DigitalCallPut(int payoffType, double strike, double timeToExp)
+: EuropeanCallPut(payoffType, strike, timeToExp)
+{}
+
+inline void DigitalCallPut::eval(Matrix const& pricePath)
+{
+  double S_T = pricePath(0, 0);
+  payAmounts_[0] = (S_T - strike_) * payoffType_ > 0.0 ? 1.0 : 0.0;
+}
+
+// This product has only one fixing.
+inline void DigitalCallPut::eval(size_t idx, Vector const& spots, double contValue)
+{
+  // the continuation value is not used
+  ORF_ASSERT(idx == 0, "DigitalCallPut: wrong fixing time index!");
+  double S_T = spots[idx];
+  payAmounts_[idx] = (S_T - strike_) * payoffType_ > 0.0 ? 1.0 : 0.0;
+}
+
+inline void DigitalCallPut::evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values)
+{
+  // the continuation values are not used
+  ORF_ASSERT(idx == 0, "DigitalCallPut: wrong fixing time index!");
+  for (size_t i = 0; i < spotLevels.size(); ++i)
+    values[i] = (spotLevels[i] - strike_) * payoffType_ > 0.0 ? 1.0 : 0.0;
+}
+
+inline bool DigitalCallPut::asymptoticValue(double t, double S, double df, double fwd, double& value) const
+{
+  value = (fwd - strike_) * payoffType_ > 0.0 ? df : 0.0;
+  return true;
+}
+
+END_NAMESPACE(orf)
+
+#endif // ORF_DIGITALCALLPUT_HPP
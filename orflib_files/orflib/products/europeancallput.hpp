@@ -31,6 +31,14 @@ public:
   */
   virtual void eval(size_t idx, Vector const& spots, double contValue) override;
 
+  /** Evaluates the product at fixing time index idx on all the nodes of a PDE grid
+  */
+  virtual void evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values) override;
+
+  /** The discounted payoff at the forward
+  */
+  virtual bool asymptoticValue(double t, double S, double df, double fwd, double& value) const override;
+
 protected:
   int payoffType_;     // 1: call; -1 put
   double strike_;
@@ -82,6 +90,23 @@ inline void EuropeanCallPut::eval(size_t idx, Vector const& spots, double contVa
     payAmounts_[idx] = S_T >= strike_ ? 0.0 : strike_ - S_T;
 }
 
+inline void EuropeanCallPut::evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values)
+{
+  // the continuation values are not used
+  ORF_ASSERT(idx == 0, "EuropeanCallPut: wrong fixing time index!");
+  for (size_t i = 0; i < spotLevels.size(); ++i) {
+    double payoff = (spotLevels[i] - strike_) * payoffType_;
+    values[i] = payoff > 0.0 ? payoff : 0.0;
+  }
+}
+
+inline bool EuropeanCallPut::asymptoticValue(double t, double S, double df, double fwd, double& value) const
+{
+  double payoff = (fwd - strike_) * payoffType_;
+  value = payoff > 0.0 ? df * payoff : 0.0;
+  return true;
+}
+
 END_NAMESPACE(orf)
 
 #endif // ORF_EUROPEANCALLPUT_HPP
@@ -10,6 +10,9 @@
 #include <orflib/exception.hpp>
 #include <orflib/sptr.hpp>
 #include <orflib/math/matrix.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 BEGIN_NAMESPACE(orf)
 
@@ -48,6 +51,72 @@ public:
   */
   virtual void eval(size_t idx, Vector const& spots, double contValue) = 0;
 
+  /** Evaluates the product at fixing time index idx on all the nodes of a 1-d PDE grid at once.
+      On input, values holds the continuation values at the spot levels spotLevels;
+      on output, it holds the values of the product at the nodes. The payment amounts are not updated.
+      The default implementation calls eval(idx, spots, contValue) node by node;
+      single asset products override it with a loop free of virtual calls.
+  */
+  virtual void evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values);
+
+  /** Same as evalOnGrid, for two asset products on the nodes of a 2-d PDE grid.
+      The values matrix has one row per level of the first asset and one column per level of the second.
+      The default implementation calls eval(idx, spots, contValue) node by node.
+  */
+  virtual void evalOnGrid2D(size_t idx, Vector const& spotLevels1, Vector const& spotLevels2, Matrix& values);
+
+  /** Same as evalOnGrid, for products on any number of assets on the nodes of an N-d PDE grid,
+      with one vector of spot levels per asset. The values hold one element per node, with the index
+      of the first asset running fastest, as in the column-major layout of the 2-d values.
+      The default implementation calls eval(idx, spots, contValue) node by node.
+  */
+  virtual void evalOnGridND(size_t idx, std::vector<Vector> const& spotLevels, Vector& values);
+
+  /** Returns the bounds that the early exercise rights of the holder and of the issuer (exercise, conversion,
+      calls) impose on the value at fixing time index idx, at the spot levels of a 1-d PDE grid, for the solvers
+      that impose them inside the implicit step. The value must satisfy lower <= value <= upper, both vectors
+      being resized as spotLevels, with -inf or +inf where there is no bound.
+      Returns false if the product has no exercise right at this index, as in the default implementation.
+  */
+  virtual bool exerciseBounds(size_t /*idx*/, Vector const& /*spotLevels*/, Vector& /*lower*/, Vector& /*upper*/) const
+  {
+    return false;
+  }
+
+  /** Returns in value the asymptotic value of the product at time t for a spot S far from the strikes,
+      for the Dirichlet and Neumann boundary conditions of the 1-d PDE solver, e.g. the discounted intrinsic
+      value. df is the discount factor and fwd the forward of S from t to the last payment time.
+      Returns false if the product does not provide it, as in the default implementation.
+  */
+  virtual bool asymptoticValue(double /*t*/, double /*S*/, double /*df*/, double /*fwd*/, double& /*value*/) const
+  {
+    return false;
+  }
+
+  /** Evaluates the cash part of the product at fixing time index idx on all the nodes of a 1-d PDE grid,
+      for the two-layer (Tsiveriotis-Fernandes) PDE of products that pay either cash or shares,
+      where the cash part carries the credit spread of the issuer.
+      On input, values holds the values after evalOnGrid and cash the continuation values of the cash part;
+      on output, cash holds the cash part of the values at the nodes, e.g. zero where the holder converts.
+      Returns false if the product does not split its value, as in the default implementation.
+  */
+  virtual bool evalCashOnGrid(size_t /*idx*/, Vector const& /*spotLevels*/, Vector const& /*values*/, Vector& /*cash*/) const
+  {
+    return false;
+  }
+
+  /** Same as eval(pricePath), with the dynamics of the path between the fixings: the initial spots
+      and the variances of the log-returns between consecutive fixing times.
+      The stepVariances matrix has one row per fixing time and one column per asset;
+      the first row covers the period from time 0 to the first fixing.
+      Products that monitor the path between fixings (e.g. barriers with Brownian bridge correction)
+      override it; the default implementation ignores the dynamics.
+  */
+  virtual void evalWithDynamics(Matrix const& pricePath, Vector const& /*spots*/, Matrix const& /*stepVariances*/)
+  {
+    eval(pricePath);
+  }
+
   /** Sets up the time steps, to be used in a numerical method.
   The timesteps are returned in the std::vector<double> timesteps,
   and for each timestep, the corresponding index in the fixingTimes() array
@@ -59,6 +128,22 @@ public:
                          std::vector<double>& timesteps,
                          std::vector<ptrdiff_t>& stepindex) const;
 
+  /** Returns the times where the payoff or the exercise rights change, e.g. the expiration and the
+      boundaries of exercise windows, around which adaptiveTimeSteps() concentrates the steps.
+      The default implementation returns none, meaning that all the fixings are required.
+  */
+  virtual std::vector<double> criticalTimes() const { return std::vector<double>(); }
+
+  /** Same as timeSteps, for products with dense fixings that need not all be visited, e.g. the daily
+      exercise dates of American options: about nsteps time steps are picked among the fixing times,
+      graded towards the critical times, where both fixings around each critical time are kept.
+      If the product has no critical times, or nsteps is not less than the number of fixings,
+      it returns the time steps of timeSteps().
+  */
+  void adaptiveTimeSteps(size_t nsteps,
+                         std::vector<double>& timesteps,
+                         std::vector<ptrdiff_t>& stepindex) const;
+
 protected:
   std::string payccy_;
   Vector fixTimes_;       // the fixing (observation) times
@@ -95,6 +180,54 @@ Vector const& Product::payAmounts() const
   return payAmounts_;
 }
 
+inline
+void Product::evalOnGrid(size_t idx, Vector const& spotLevels, Vector& values)
+{
+  Vector spots(1);
+  for (size_t i = 0; i < spotLevels.size(); ++i) {
+    spots[0] = spotLevels[i];
+    eval(idx, spots, values[i]);
+    values[i] = payAmounts_[idx];
+  }
+}
+
+inline
+void Product::evalOnGrid2D(size_t idx, Vector const& spotLevels1, Vector const& spotLevels2, Matrix& values)
+{
+  Vector spots(2);
+  for (size_t j = 0; j < spotLevels2.size(); ++j) {
+    spots[1] = spotLevels2[j];
+    for (size_t i = 0; i < spotLevels1.size(); ++i) {
+      spots[0] = spotLevels1[i];
+      eval(idx, spots, values(i, j));
+      values(i, j) = payAmounts_[idx];
+    }
+  }
+}
+
+inline
+void Product::evalOnGridND(size_t idx, std::vector<Vector> const& spotLevels, Vector& values)
+{
+  size_t nDims = spotLevels.size();
+  Vector spots(nDims);
+  std::vector<size_t> node(nDims, 0);
+  for (size_t k = 0; k < nDims; ++k)
+    spots[k] = spotLevels[k][0];
+  for (size_t p = 0; p < values.size(); ++p) {
+    eval(idx, spots, values[p]);
+    values[p] = payAmounts_[idx];
+    // the next node, the first index running fastest
+    for (size_t k = 0; k < nDims; ++k) {
+      if (++node[k] < spotLevels[k].size()) {
+        spots[k] = spotLevels[k][node[k]];
+        break;
+      }
+      node[k] = 0;
+      spots[k] = spotLevels[k][0];
+    }
+  }
+}
+
 inline
 void Product::timeSteps(size_t nsteps,
                         std::vector<double>& timesteps,
@@ -141,6 +274,63 @@ void Product::timeSteps(size_t nsteps,
   stepindex.push_back(idxtemp.back());
 }
 
+inline
+void Product::adaptiveTimeSteps(size_t nsteps,
+                                std::vector<double>& timesteps,
+                                std::vector<ptrdiff_t>& stepindex) const
+{
+  std::vector<double> crit = criticalTimes();
+  size_t nfix = fixTimes().size();
+  nsteps = std::max(nsteps, size_t(1));
+  if (crit.empty() || nsteps + 1 >= nfix) {
+    timeSteps(nsteps, timesteps, stepindex);
+    return;
+  }
+
+  // the step density grows as 1/sqrt of the distance to the critical times,
+  // as for the square root grading of the steps after the payoff kink
+  Vector const& fix = fixTimes();
+  double T = fix[nfix - 1];
+  double delta = T / double(nsteps * nsteps);
+  auto density = [&crit, T, delta](double t) {
+    double d = 1.0;
+    for (double c : crit)
+      d += 0.5 * std::sqrt(T / (std::abs(t - c) + delta));
+    return d;
+  };
+
+  // pick a fixing each time the cumulative density crosses a multiple of its total / nsteps
+  std::vector<double> cumDensity(nfix, 0.0);
+  for (size_t i = 1; i < nfix; ++i)
+    cumDensity[i] = cumDensity[i - 1] + density(0.5 * (fix[i - 1] + fix[i])) * (fix[i] - fix[i - 1]);
+  double scale = nsteps / cumDensity.back();
+  std::vector<bool> keep(nfix, false);
+  keep[0] = keep[nfix - 1] = true;
+  for (size_t i = 1; i < nfix; ++i)
+    keep[i] = keep[i] || std::floor(cumDensity[i] * scale) != std::floor(cumDensity[i - 1] * scale);
+  // keep the fixings on both sides of each critical time, where the rights switch
+  for (double c : crit) {
+    size_t i = std::lower_bound(fix.begin(), fix.end(), c) - fix.begin();
+    if (i < nfix)
+      keep[i] = true;
+    if (i > 0)
+      keep[i - 1] = true;
+  }
+
+  timesteps.clear();
+  stepindex.clear();
+  if (fix[0] > 0.0) {
+    timesteps.push_back(0.0);
+    stepindex.push_back(-1);
+  }
+  for (size_t i = 0; i < nfix; ++i) {
+    if (keep[i]) {
+      timesteps.push_back(fix[i]);
+      stepindex.push_back(i);
+    }
+  }
+}
+
 END_NAMESPACE(orf)
 
 #endif // ORF_PRODUCT_HPP
@@ -0,0 +1,122 @@
+/**
+@file  spreadcallput.hpp
+@brief The payoff of a European or American Call/Put option on the spread of two assets
+*/
+
+#ifndef ORF_SPREADCALLPUT_HPP
+#define ORF_SPREADCALLPUT_HPP
+
+#include <orflib/products/product.hpp>
+
+BEGIN_NAMESPACE(orf)
+
+/** The spread call/put class, paying max(payoffType * (S1 - S2 - strike), 0).
+    With American exercise, the option can be exercised on each day up to expiration,
+    as for AmericanCallPut. The strike can be zero (exchange option) or negative.
+*/
+class SpreadCallPut : public Product
+{
+public:
+  /** Initializing ctor */
+  SpreadCallPut(int payoffType, double strike, double timeToExp, bool american = false);
+
+  /** The number of assets this product depends on */
+  virtual size_t nAssets() const override { return 2; }
+
+  /** Evaluates the product given the passed-in path, at the last fixing time only;
+      the early exercise of American options is ignored.
+      The "pricePath" matrix must have as many rows as the number of fixing times
+      and one column per asset
+  */
+  virtual void eval(Matrix const& pricePath) override;
+
+  /** Evaluates the product at fixing time index idx
+  */
+  virtual void eval(size_t idx, Vector const& spots, double contValue) override;
+
+  /** Evaluates the product at fixing time index idx on all the nodes of a 2-d PDE grid
+  */
+  virtual void evalOnGrid2D(size_t idx, Vector const& spotLevels1, Vector const& spotLevels2,
+                            Matrix& values) override;
+
+protected:
+  /** Returns the payoff for the spots s1 and s2 */
+  double payoff(double s1, double s2) const
+  {
+    double payoff = (s1 - s2 - strike_) * payoffType_;
+    return payoff > 0.0 ? payoff : 0.0;
+  }
+
+  int payoffType_;     // 1: call; -1 put
+  double strike_;
+  double timeToExp_;
+  bool american_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+inline
+SpreadCallPut::SpreadCallPut(int payoffType, double strike, double timeToExp, bool american)
+: payoffType_(payoffType), strike_(strike), timeToExp_(timeToExp), american_(american)
+{
+  ORF_ASSERT(payoffType == 1 || payoffType == -1, "SpreadCallPut: the payoff type must be 1 (call) or -1 (put)!");
+  ORF_ASSERT(timeToExp > 0.0, "SpreadCallPut: the time to expiration must be positive!");
+
+  if (american_) {
+    // one fixing per day between 0 and timeToExp, as for AmericanCallPut
+    size_t nfixings = static_cast<size_t>(timeToExp * DAYS_PER_YEAR) + 1;
+    fixTimes_.resize(nfixings);
+    for (size_t i = 0; i < nfixings - 1; ++i)
+      fixTimes_[i] = i / DAYS_PER_YEAR;
+    fixTimes_[nfixings - 1] = timeToExp_;
+  }
+  else {
+    fixTimes_.resize(1);
+    fixTimes_[0] = timeToExp_;
+  }
+
+  payTimes_ = fixTimes_;
+  payAmounts_.resize(payTimes_.size());
+}
+
+inline void SpreadCallPut::eval(Matrix const& pricePath)
+{
+  size_t last = pricePath.n_rows - 1;
+  payAmounts_.zeros();
+  payAmounts_[payAmounts_.size() - 1] = payoff(pricePath(last, 0), pricePath(last, 1));
+}
+
+inline void SpreadCallPut::eval(size_t idx, Vector const& spots, double contValue)
+{
+  double intrinsicValue = payoff(spots[0], spots[1]);
+  if (idx == payAmounts_.size() - 1)  // this is the last index
+    payAmounts_[idx] = intrinsicValue;
+  else {  // check the exercise condition, possible only for American options
+    ORF_ASSERT(american_, "SpreadCallPut: wrong fixing time index!");
+    payAmounts_[idx] = contValue >= intrinsicValue ? contValue : intrinsicValue;
+    for (size_t j = idx + 1; j < payAmounts_.size(); ++j)
+      payAmounts_[j] = 0.0;
+  }
+}
+
+inline void SpreadCallPut::evalOnGrid2D(size_t idx, Vector const& spotLevels1, Vector const& spotLevels2,
+                                        Matrix& values)
+{
+  bool last = idx == payAmounts_.size() - 1;
+  ORF_ASSERT(last || american_, "SpreadCallPut: wrong fixing time index!");
+  for (size_t j = 0; j < spotLevels2.size(); ++j) {
+    double s2 = spotLevels2[j];
+    double* vals = values.colptr(j);
+    for (size_t i = 0; i < spotLevels1.size(); ++i) {
+      double intrinsicValue = payoff(spotLevels1[i], s2);
+      // at expiration the payoff, otherwise the larger of the continuation and the exercise values
+      if (last || vals[i] < intrinsicValue)
+        vals[i] = intrinsicValue;
+    }
+  }
+}
+
+END_NAMESPACE(orf)
+
+#endif // ORF_SPREADCALLPUT_HPP
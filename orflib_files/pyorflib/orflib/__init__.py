@@ -1,3 +1,4 @@
+import numpy as np
 import orflib.pyorflib
 
 ###################
@@ -453,6 +454,7 @@ def mktList():
     dictionary
         YieldCurves : list with names of yield curves
         Volatilities : list with names of volatility term structures   
+        LocalVolatilities : list with names of local volatility surfaces
     """
     return pyorflib.mktList()
 
@@ -628,6 +630,48 @@ def fwdVol(volname, tmat1, tmat2):
     """
     return pyorflib.fwdVol(volname, tmat1, tmat2)
 
+def lvCreate(lvname, times, spots, vols):
+    """Creates a new local volatility surface.
+
+    Parameters
+    ----------
+    lvname : str
+        name of the local volatility surface
+    times : list(double) or 1D numpy array
+        increasing times in years; the vols of each time hold from the previous time
+    spots : list(double) or 1D numpy array
+        increasing spots; the vols are interpolated linearly in log spot between them, and flat beyond them
+    vols : 2D numpy array
+        local volatilities, with one row per time and one column per spot
+
+    Returns
+    -------
+    str
+        name of the newly created local volatility surface
+    """
+    return pyorflib.lvCreate(lvname, times, spots, np.atleast_2d(np.asarray(vols, dtype=float)))
+
+
+def localVol(lvname, time, spot):
+    """Local volatility from a local volatility surface.
+
+    Parameters
+    ----------
+    lvname : str
+        name of the local volatility surface
+    time : double
+        time in years
+    spot : double
+        spot price
+
+    Returns
+    -------
+    double
+        the local volatility at time and spot
+    """
+    return pyorflib.localVol(lvname, time, spot)
+
+
 def capFloorletBS(payofftype, ycname, strikerate, timetoreset, tenor, fwdratevol):
     """Present value of a caplet or floorlet on a fowrward rate in the Black-Scholes model.
 
@@ -684,7 +728,7 @@ def cdsPV(ycname, credspread, cdsrate, recov, timetomat, payfreq):
 ###################
 # function group 3
 
-def euroBSMC(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, mcparams, npaths):
+def euroBSMC(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, mcparams, npaths, quantiles = None):
     """Price and standard error of a European option in the Black-Scholes model using Monte Carlo.
 
     Parameters
@@ -701,26 +745,87 @@ def euroBSMC(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatil
         discount yield curve name
     divyield : double    
         asset dividend yield, p.a. and c.c.
-    volatility : double
-        asset return volatility
+    volatility : double or str
+        asset return volatility, or the name of a volatility term structure
     mcparams : dictionary
         URNGTYPE : 'MINSTDRAND', 'MT19937', 'RANLUX3', 'RANLUX4'
         PATHGENTYPE : 'EULER'
         CONTROLVARTYPE : 'ANTITHETIC', 'NONE'
+        IMPSAMPLING : bool, optional; if True, the mean of the terminal normal deviate is shifted
+            to minimize the variance, as found on pilot runs
+        NPILOTPATHS : int, optional; number of pilot paths per candidate shift, default 1000
+        SAMPLINGTYPE : 'PLAIN', 'STRATIFIED', 'LATINHYPERCUBE', optional; stratification of the
+            normal deviates, the first one per asset or all of them, over blocks of NSTRATA paths
+        NSTRATA : int, optional; number of strata, default 100; npaths must be a multiple of it
     npaths : int
         number of Monte Carlo paths
+    quantiles : list(double) or 1D numpy array, optional
+        probability levels of the quantiles of the path PVs, e.g. for VaR or PFE;
+        not available with importance sampling or stratified sampling
     
     Returns
     -------
     dictionary
         Mean : Monte Carlo mean price
         StdErr : Monte Carlo standard error
+        Quantiles : the quantiles of the path PVs, only if quantiles are passed in
+        MeanShift : the shift of the terminal normal deviate, only with importance sampling
+        VarRedFactor : the variance reduction factor relative to plain Monte Carlo,
+            only with importance sampling
     """
-    return pyorflib.euroBSMC(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, mcparams, npaths)
+    return pyorflib.euroBSMC(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, mcparams, npaths, quantiles)
+
+
+def digiBSMC(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, mcparams, npaths, quantiles = None):
+    """Price and standard error of a European digital option in the Black-Scholes model using Monte Carlo.
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put; pays one unit of cash if in the money at expiration
+    strike : double
+        strike price
+    timetoexp : double
+        time to expiration in years
+    spot : double
+        asset spot price
+    discountcrv : str
+        discount yield curve name
+    divyield : double    
+        asset dividend yield, p.a. and c.c.
+    volatility : double or str
+        asset return volatility, or the name of a volatility term structure
+    mcparams : dictionary
+        URNGTYPE : 'MINSTDRAND', 'MT19937', 'RANLUX3', 'RANLUX4'
+        PATHGENTYPE : 'EULER'
+        CONTROLVARTYPE : 'ANTITHETIC', 'NONE'
+        IMPSAMPLING : bool, optional; if True, the mean of the terminal normal deviate is shifted
+            to minimize the variance, as found on pilot runs
+        NPILOTPATHS : int, optional; number of pilot paths per candidate shift, default 1000
+        SAMPLINGTYPE : 'PLAIN', 'STRATIFIED', 'LATINHYPERCUBE', optional; stratification of the
+            normal deviates, the first one per asset or all of them, over blocks of NSTRATA paths
+        NSTRATA : int, optional; number of strata, default 100; npaths must be a multiple of it
+    npaths : int
+        number of Monte Carlo paths
+    quantiles : list(double) or 1D numpy array, optional
+        probability levels of the quantiles of the path PVs, e.g. for VaR or PFE;
+        not available with importance sampling or stratified sampling
+    
+    Returns
+    -------
+    dictionary
+        Mean : Monte Carlo mean price
+        StdErr : Monte Carlo standard error
+        Quantiles : the quantiles of the path PVs, only if quantiles are passed in
+        MeanShift : the shift of the terminal normal deviate, only with importance sampling
+        VarRedFactor : the variance reduction factor relative to plain Monte Carlo,
+            only with importance sampling
+    """
+    return pyorflib.digiBSMC(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, mcparams, npaths, quantiles)
 
 
 def asianBasketBSMC(payofftype, strike, fixtimes, assetquantities, spots, discountcrv, divyields, 
-                    volatilities, correlmat, mcparams, npaths):
+                    volatilities, correlmat, mcparams, npaths, quantiles = None):
     """Price and standard error of an Asian basket option in the Black-Scholes model using Monte Carlo.
 
     Parameters
@@ -739,30 +844,90 @@ def asianBasketBSMC(payofftype, strike, fixtimes, assetquantities, spots, discou
         discount yield curve name
     divyields : list(double) or 1D numpy array
         asset dividend yields, p.a. and c.c.
-    volatilities : list(double) or 1D numpy array
-        asset return volatilities
+    volatilities : list(double) or list(str)
+        asset return volatilities, or the names of volatility term structures
     correlmat : 2D numpy array
         asset correlation matrix
     mcparams : dictionary
         URNGTYPE : 'MINSTDRAND', 'MT19937', 'RANLUX3', 'RANLUX4'
         PATHGENTYPE : 'EULER'
         CONTROLVARTYPE : 'ANTITHETIC', 'NONE'
+        SAMPLINGTYPE : 'PLAIN', 'STRATIFIED', 'LATINHYPERCUBE', optional; stratification of the
+            normal deviates, the first one per asset or all of them, over blocks of NSTRATA paths
+        NSTRATA : int, optional; number of strata, default 100; npaths must be a multiple of it
     npaths : int
         number of Monte Carlo paths
+    quantiles : list(double) or 1D numpy array, optional
+        probability levels of the quantiles of the path PVs, e.g. for VaR or PFE;
+        not available with importance sampling or stratified sampling
     
     Returns
     -------
     dictionary
         Mean : Monte Carlo mean price
         StdErr : Monte Carlo standard error
+        Quantiles : the quantiles of the path PVs, only if quantiles are passed in
     """
     return pyorflib.asianBasketBSMC(payofftype, strike, fixtimes, assetquantities, spots, discountcrv, divyields, 
-                                   volatilities, correlmat, mcparams, npaths)
+                                   volatilities, correlmat, mcparams, npaths, quantiles)
+
+
+def barrierBSMC(payofftype, strike, timetoexp, barriertype, barrier, nfixings, bridgecorrection,
+                spot, discountcrv, divyield, volatility, mcparams, npaths, quantiles = None):
+    """Price and standard error of a European barrier option in the Black-Scholes model using Monte Carlo.
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    strike : double
+        strike price
+    timetoexp : double
+        time to expiration in years
+    barriertype : {'UPOUT', 'UPIN', 'DOWNOUT', 'DOWNIN'}
+        barrier direction and knock type
+    barrier : double
+        barrier level
+    nfixings : int
+        number of equally spaced barrier monitoring times up to expiration
+    bridgecorrection : bool
+        if True, the Brownian bridge crossing probability between fixings is applied,
+        i.e. the barrier is monitored continuously
+    spot : double
+        asset spot price
+    discountcrv : str
+        discount yield curve name
+    divyield : double    
+        asset dividend yield, p.a. and c.c.
+    volatility : double or str
+        asset return volatility, or the name of a volatility term structure
+    mcparams : dictionary
+        URNGTYPE : 'MINSTDRAND', 'MT19937', 'RANLUX3', 'RANLUX4', 'SOBOL'
+        PATHGENTYPE : 'EULER'
+        SAMPLINGTYPE : 'PLAIN', 'STRATIFIED', 'LATINHYPERCUBE', optional; stratification of the
+            normal deviates, the first one per asset or all of them, over blocks of NSTRATA paths
+        NSTRATA : int, optional; number of strata, default 100; npaths must be a multiple of it
+    npaths : int
+        number of Monte Carlo paths
+    quantiles : list(double) or 1D numpy array, optional
+        probability levels of the quantiles of the path PVs, e.g. for VaR or PFE;
+        not available with importance sampling or stratified sampling
+    
+    Returns
+    -------
+    dictionary
+        Mean : Monte Carlo mean price
+        StdErr : Monte Carlo standard error
+        Quantiles : the quantiles of the path PVs, only if quantiles are passed in
+    """
+    return pyorflib.barrierBSMC(payofftype, strike, timetoexp, barriertype, barrier, nfixings, bridgecorrection,
+                                spot, discountcrv, divyield, volatility, mcparams, npaths, quantiles)
 
 ###################
 # function group 4
 
-def euroBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, pdeparams, allresults=False):
+def euroBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, pdeparams, allresults=False,
+              storeevery=1, spotwindow=None, tangents=False):
     """Price of a European option in the Black-Scholes model using finite difference PDE.
 
     Parameters
@@ -786,25 +951,49 @@ def euroBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volati
         NSPOTNODES : (int) number of spot nodes
         NSTDDEVS : (double) number of standard deviations for the spot range
         THETA : (double) scheme implicitness
+        CONCENTRATIONSPOTS : (list(double)) optional; spots around which the nodes are concentrated,
+            e.g. the strikes; if missing, the nodes are equally spaced
+        CONCENTRATIONWIDTH : (double) optional; width of the concentration regions as a fraction of the
+            spot range in log space, default 0.1; smaller values concentrate more
+        RANNACHERSTEPS : (int) optional; number of steps after each payoff event solved as two fully
+            implicit half steps, default 0
+        BOUNDARYCONDITION : 'LINEAR', 'DIRICHLET', 'NEUMANN', optional, default 'LINEAR'; the values on the
+            edge nodes are extrapolated linearly, or set from the asymptotic values of the product (discounted
+            intrinsic value, bond floor), or from their slopes; the asymptotic conditions allow smaller NSTDDEVS
     allresults : bool
-        FALSE for price only; TRUE for the full grid of results
+        FALSE for price only; TRUE for the grid of results
+    storeevery : int
+        with allresults, keep the values of every storeevery-th time step; the first and last are always kept
+    spotwindow : list(double)
+        with allresults, keep only the spots in [spotwindow[0], spotwindow[1]]; None for all spots
+    tangents : bool
+        if True, also solve for the derivatives of the values in the volatility and in the rate,
+        as extra layers on the same grid; needs EXERCISEMETHOD 'EXPLICIT'
     
     Returns
     -------
     dictionary
         Price : PDE price
+        Delta : first derivative of the price in the spot, from the grid values around the spot
+        Gamma : second derivative of the price in the spot, from the grid values around the spot
+        Theta : derivative of the price in time, from the prices at the first time steps
+        Vega : derivative of the price in the volatility, from the tangent layers
+        Rho : derivative of the price in a parallel shift of the discount curve, from the tangent layers
         Times : 1D array with times
         Spots : 1D array with spots
         Values : 2D array with option values
 
     Notes
     -----
-    The keys `Times`, `Spots` and `Values` are available only if `allresults`==True.
+    The keys `Times`, `Spots` and `Values` are available only if `allresults`==True,
+    the keys `Vega` and `Rho` only if `tangents`==True.
     """
-    return pyorflib.euroBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, pdeparams, allresults)
+    return pyorflib.euroBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, pdeparams, allresults,
+                              storeevery, spotwindow, tangents)
 
 
-def amerBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, pdeparams, allresults=False):
+def amerBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, pdeparams, allresults=False,
+              storeevery=1, spotwindow=None, tangents=False):
     """Price of an American option in the Black-Scholes model using finite difference PDE.
 
     Parameters
@@ -828,26 +1017,448 @@ def amerBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volati
         NSPOTNODES : (int) number of spot nodes
         NSTDDEVS : (double) number of standard deviations for the spot range
         THETA : (double) scheme implicitness
+        CONCENTRATIONSPOTS : (list(double)) optional; spots around which the nodes are concentrated,
+            e.g. the strikes; if missing, the nodes are equally spaced
+        CONCENTRATIONWIDTH : (double) optional; width of the concentration regions as a fraction of the
+            spot range in log space, default 0.1; smaller values concentrate more
+        RANNACHERSTEPS : (int) optional; number of steps after each payoff event solved as two fully
+            implicit half steps, default 0
+        EXERCISEMETHOD : 'EXPLICIT', 'BRENNANSCHWARTZ', 'PENALTY', optional, default 'EXPLICIT'; how the
+            early exercise is imposed: after each step, or inside the implicit solve, where it holds
+            continuously between the exercise days
+        ADAPTIVETIMESTEPS : (bool) optional, default False; if True, about NTIMESTEPS steps are picked among
+            the daily exercise dates, concentrated around the expiration and the exercise window boundaries;
+            best with EXERCISEMETHOD other than 'EXPLICIT'
+        BOUNDARYCONDITION : 'LINEAR', 'DIRICHLET', 'NEUMANN', optional, default 'LINEAR'; the values on the
+            edge nodes are extrapolated linearly, or set from the asymptotic values of the product (discounted
+            intrinsic value, bond floor), or from their slopes; the asymptotic conditions allow smaller NSTDDEVS
     allresults : bool
-        FALSE for price only; TRUE for the full grid of results
+        FALSE for price only; TRUE for the grid of results
+    storeevery : int
+        with allresults, keep the values of every storeevery-th time step; the first and last are always kept
+    spotwindow : list(double)
+        with allresults, keep only the spots in [spotwindow[0], spotwindow[1]]; None for all spots
+    tangents : bool
+        if True, also solve for the derivatives of the values in the volatility and in the rate,
+        as extra layers on the same grid; needs EXERCISEMETHOD 'EXPLICIT'
     
     Returns
     -------
     dictionary
         Price : PDE price
+        Delta : first derivative of the price in the spot, from the grid values around the spot
+        Gamma : second derivative of the price in the spot, from the grid values around the spot
+        Theta : derivative of the price in time, from the prices at the first time steps
+        Vega : derivative of the price in the volatility, from the tangent layers
+        Rho : derivative of the price in a parallel shift of the discount curve, from the tangent layers
         Times : 1D array with times
         Spots : 1D array with spots
         Values : 2D array with option values
 
     Notes
     -----
-    The keys `Times`, `Spots` and `Values` are available only if `allresults`==True.
+    The keys `Times`, `Spots` and `Values` are available only if `allresults`==True,
+    the keys `Vega` and `Rho` only if `tangents`==True.
     """
-    return pyorflib.amerBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, pdeparams, allresults)
+    return pyorflib.amerBSPDE(payofftype, strike, timetoexp, spot, discountcrv, divyield, volatility, pdeparams, allresults,
+                              storeevery, spotwindow, tangents)
 
 ###################
 # function group 5
 
+
+def bsPDEBatch(payofftypes, strikes, timestoexp, americans, spots, discountcrv, divyields, volatilities,
+               pdeparams, nthreads=0):
+    """Prices of a batch of European and American options in the Black-Scholes model using finite difference PDE.
+    The options are priced concurrently on a pool of threads.
+
+    Parameters
+    ----------
+    payofftypes : int or list(int)
+        1 for call, -1 for put
+    strikes : double or list(double)
+        strike prices
+    timestoexp : double or list(double)
+        times to expiration in years
+    americans : bool or list(bool)
+        True for American exercise, False for European
+    spots : double or list(double)
+        asset spot prices
+    discountcrv : str
+        discount yield curve name
+    divyields : double or list(double)
+        asset dividend yields, p.a. and c.c.
+    volatilities : double or list(double)
+        asset return volatilities
+    pdeparams : dictionary
+        NTIMESTEPS : (int) number of time steps
+        NSPOTNODES : (int) number of spot nodes
+        NSTDDEVS : (double) number of standard deviations for the spot range
+        THETA : (double) scheme implicitness
+        CONCENTRATIONSPOTS : (list(double)) optional; spots around which the nodes are concentrated,
+            e.g. the strikes; if missing, the nodes are equally spaced
+        CONCENTRATIONWIDTH : (double) optional; width of the concentration regions as a fraction of the
+            spot range in log space, default 0.1; smaller values concentrate more
+        RANNACHERSTEPS : (int) optional; number of steps after each payoff event solved as two fully
+            implicit half steps, default 0
+        EXERCISEMETHOD : 'EXPLICIT', 'BRENNANSCHWARTZ', 'PENALTY', optional, default 'EXPLICIT'; how the
+            early exercise is imposed: after each step, or inside the implicit solve, where it holds
+            continuously between the exercise days
+        ADAPTIVETIMESTEPS : (bool) optional, default False; if True, about NTIMESTEPS steps are picked among
+            the daily exercise dates, concentrated around the expiration and the exercise window boundaries;
+            best with EXERCISEMETHOD other than 'EXPLICIT'
+        BOUNDARYCONDITION : 'LINEAR', 'DIRICHLET', 'NEUMANN', optional, default 'LINEAR'; the values on the
+            edge nodes are extrapolated linearly, or set from the asymptotic values of the product (discounted
+            intrinsic value, bond floor), or from their slopes; the asymptotic conditions allow smaller NSTDDEVS
+    nthreads : int
+        number of threads; 0 for the number of hardware threads
+
+    Returns
+    -------
+    dictionary
+        Prices : 1D array with the PDE prices, in the order of the inputs
+
+    Notes
+    -----
+    The list inputs are broadcast against each other, so scalars apply to all options.
+    """
+    inputs = np.broadcast_arrays(np.atleast_1d(payofftypes), np.atleast_1d(strikes), np.atleast_1d(timestoexp),
+                                 np.atleast_1d(americans), np.atleast_1d(spots), np.atleast_1d(divyields),
+                                 np.atleast_1d(volatilities))
+    ptypes, ks, texps, amers, s0s, divs, vols = [np.asarray(x, dtype=float).ravel() for x in inputs]
+    return pyorflib.bsPDEBatch(ptypes, ks, texps, amers, s0s, discountcrv, divs, vols, pdeparams, nthreads)
+
+
+def bsPDELadder(payofftypes, strikes, timetoexp, american, spot, discountcrv, divyield, volatility, pdeparams):
+    """Prices of a ladder of options on the same underlying and expiration in the Black-Scholes model
+    using finite difference PDE.
+    All options are solved as layers of a single PDE on a shared grid.
+
+    Parameters
+    ----------
+    payofftypes : int or list(int)
+        1 for call, -1 for put
+    strikes : double or list(double)
+        strike prices
+    timetoexp : double
+        time to expiration in years
+    american : bool
+        True for American exercise, False for European
+    spot : double
+        asset spot price
+    discountcrv : str
+        discount yield curve name
+    divyield : double
+        asset dividend yield, p.a. and c.c.
+    volatility : double
+        asset return volatility
+    pdeparams : dictionary
+        NTIMESTEPS : (int) number of time steps
+        NSPOTNODES : (int) number of spot nodes
+        NSTDDEVS : (double) number of standard deviations for the spot range
+        THETA : (double) scheme implicitness
+        CONCENTRATIONSPOTS : (list(double)) optional; spots around which the nodes are concentrated,
+            e.g. the strikes; if missing, the nodes are equally spaced
+        CONCENTRATIONWIDTH : (double) optional; width of the concentration regions as a fraction of the
+            spot range in log space, default 0.1; smaller values concentrate more
+        RANNACHERSTEPS : (int) optional; number of steps after each payoff event solved as two fully
+            implicit half steps, default 0
+        EXERCISEMETHOD : 'EXPLICIT', 'BRENNANSCHWARTZ', 'PENALTY', optional, default 'EXPLICIT'; how the
+            early exercise is imposed: after each step, or inside the implicit solve, where it holds
+            continuously between the exercise days
+        ADAPTIVETIMESTEPS : (bool) optional, default False; if True, about NTIMESTEPS steps are picked among
+            the daily exercise dates, concentrated around the expiration and the exercise window boundaries;
+            best with EXERCISEMETHOD other than 'EXPLICIT'
+
+        BOUNDARYCONDITION : 'LINEAR', 'DIRICHLET', 'NEUMANN', optional, default 'LINEAR'; the values on the
+            edge nodes are extrapolated linearly, or set from the asymptotic values of the product (discounted
+            intrinsic value, bond floor), or from their slopes; the asymptotic conditions allow smaller NSTDDEVS
+    Returns
+    -------
+    dictionary
+        Prices : 1D array with the PDE prices, in the order of the strikes
+
+    Notes
+    -----
+    The payoff types are broadcast against the strikes.
+    """
+    ptypes, ks = np.broadcast_arrays(np.atleast_1d(payofftypes), np.atleast_1d(strikes))
+    ptypes, ks = [np.asarray(x, dtype=float).ravel() for x in (ptypes, ks)]
+    return pyorflib.bsPDELadder(ptypes, ks, timetoexp, american, spot, discountcrv, divyield, volatility, pdeparams)
+
+
+def bsPDEForward(spot, discountcrv, divyield, volatility, strikes, maturities, pdeparams):
+    """Prices of European calls and puts for a grid of strikes and maturities in the Black-Scholes model,
+    using one solve of the forward (Dupire) PDE in the strike.
+
+    Parameters
+    ----------
+    spot : double
+        asset spot price
+    discountcrv : str
+        discount yield curve name
+    divyield : double
+        asset dividend yield, p.a. and c.c.
+    volatility : double
+        asset return volatility
+    strikes : double or list(double)
+        strike prices; must lie within the grid
+    maturities : double or list(double)
+        times to expiration in years, positive and increasing
+    pdeparams : dictionary
+        NTIMESTEPS : (int) number of time steps up to the last maturity
+        NSPOTNODES : (int) number of strike nodes
+        NSTDDEVS : (double) number of standard deviations for the strike range
+        THETA : (double) scheme implicitness
+        CONCENTRATIONSPOTS : (list(double)) optional; strikes around which the nodes are concentrated,
+            e.g. the spot; if missing, the nodes are equally spaced
+        CONCENTRATIONWIDTH : (double) optional; width of the concentration regions as a fraction of the
+            strike range in log space, default 0.1; smaller values concentrate more
+        RANNACHERSTEPS : (int) optional; number of fully implicit half step pairs at the start, default 0
+
+    Returns
+    -------
+    dictionary
+        CallPrices : 2D array with the call prices, one row per strike and one column per maturity
+        PutPrices : 2D array with the put prices, from the call prices by put-call parity
+    """
+    ks = np.asarray(np.atleast_1d(strikes), dtype=float).ravel()
+    ts = np.asarray(np.atleast_1d(maturities), dtype=float).ravel()
+    return pyorflib.bsPDEForward(spot, discountcrv, divyield, volatility, ks, ts, pdeparams)
+
+
+def lvPDE(payofftype, strike, timetoexp, american, spot, discountcrv, divyield, localvol, pdeparams):
+    """Price of a European or American option in the local volatility model using finite difference PDE.
+    The local vols are tabulated once on the nodes of the grid for all time steps.
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    strike : double
+        strike price
+    timetoexp : double
+        time to expiration in years
+    american : bool
+        True for American exercise, False for European
+    spot : double
+        asset spot price
+    discountcrv : str
+        discount yield curve name
+    divyield : double
+        asset dividend yield, p.a. and c.c.
+    localvol : str
+        local volatility surface name; its value at the spot and the expiration sets the spot range
+    pdeparams : dictionary
+        the parameters of the grid, with the same keys as for amerBSPDE
+
+    Returns
+    -------
+    dictionary
+        Price : PDE price
+        Delta : first derivative of the price in the spot
+        Gamma : second derivative of the price in the spot
+        Theta : first derivative of the price in time
+    """
+    return pyorflib.lvPDE(payofftype, strike, timetoexp, american, spot, discountcrv, divyield, localvol, pdeparams)
+
+
+def bsPDESpots(payofftype, strike, timetoexp, american, spot, spots, discountcrv, divyield, volatility, pdeparams,
+               greeks=False):
+    """Prices of a European or American option in the Black-Scholes model at several spots,
+    e.g. a spot ladder for scenarios, using finite difference PDE.
+    All prices come from a single solve on a grid around spot, interpolated by cubic splines.
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    strike : double
+        strike price
+    timetoexp : double
+        time to expiration in years
+    american : bool
+        True for American exercise, False for European
+    spot : double
+        asset spot price, the center of the grid
+    spots : double or list(double)
+        the spots for the prices; must lie within the grid
+    discountcrv : str
+        discount yield curve name
+    divyield : double
+        asset dividend yield, p.a. and c.c.
+    volatility : double
+        asset return volatility
+    pdeparams : dictionary
+        the parameters of the grid, with the same keys as for amerBSPDE
+    greeks : bool
+        if True, also return delta, gamma and theta at the spots
+
+    Returns
+    -------
+    dictionary
+        Prices : 1D array with the PDE prices, in the order of the spots
+        Deltas : 1D array with the deltas, if greeks is True
+        Gammas : 1D array with the gammas, if greeks is True
+        Thetas : 1D array with the thetas, if greeks is True
+    """
+    spts = np.asarray(np.atleast_1d(spots), dtype=float).ravel()
+    return pyorflib.bsPDESpots(payofftype, strike, timetoexp, american, spot, spts, discountcrv, divyield, volatility,
+                               pdeparams, greeks)
+
+
+def bsPDERichardson(payofftype, strike, timetoexp, american, spot, discountcrv, divyield, volatility, pdeparams,
+                    nlevels=2, nthreads=0):
+    """Price of a European or American option in the Black-Scholes model using finite difference PDE,
+    extrapolated from successively refined grids.
+    Each grid level doubles the time steps and the spot intervals of the previous one, and the levels are
+    solved concurrently.
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    strike : double
+        strike price
+    timetoexp : double
+        time to expiration in years
+    american : bool
+        True for American exercise, False for European
+    spot : double
+        asset spot price
+    discountcrv : str
+        discount yield curve name
+    divyield : double
+        asset dividend yield, p.a. and c.c.
+    volatility : double
+        asset return volatility
+    pdeparams : dictionary
+        the parameters of the coarsest grid, with the same keys as for euroBSPDE
+    nlevels : {2, 3}
+        number of grid levels
+    nthreads : int
+        number of threads; 0 for the number of hardware threads
+
+    Returns
+    -------
+    dictionary
+        Price : extrapolated PDE price
+        ErrorEstimate : size of the last extrapolation correction
+        LevelPrices : 1D array with the prices on each grid, from the coarsest
+
+    Notes
+    -----
+    The extrapolation works best with RANNACHERSTEPS > 0 and the nodes concentrated around the strike.
+    For American options the time steps are not refined below one day.
+    """
+    return pyorflib.bsPDERichardson(payofftype, strike, timetoexp, american, spot, discountcrv, divyield, volatility,
+                                    pdeparams, nlevels, nthreads)
+
+
+def spreadBSPDE(payofftype, strike, timetoexp, american, spots, discountcrv, divyields, volatilities, correlation,
+                pdeparams, nthreads=0):
+    """Price of a European or American option on the spread of two assets, paying
+    max(payofftype * (S1 - S2 - strike), 0), in the Black-Scholes model using a 2D finite difference PDE.
+    The PDE is solved with an alternating direction implicit scheme, with the line solves on nthreads threads.
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    strike : double
+        strike of the spread, can be zero or negative
+    timetoexp : double
+        time to expiration in years
+    american : bool
+        True for daily exercise up to expiration, False for European
+    spots : list(double) or 1D numpy array
+        the spot prices of the two assets
+    discountcrv : str
+        discount yield curve name
+    divyields : list(double) or 1D numpy array
+        the dividend yields of the two assets, p.a. and c.c.
+    volatilities : list(double) or 1D numpy array
+        the return volatilities of the two assets
+    correlation : double
+        the correlation of the asset returns
+    pdeparams : dictionary
+        NTIMESTEPS : (int) number of time steps
+        NSPOTNODES : (int or list(int)) number of spot nodes, for both assets or for each one
+        NSTDDEVS : (double or list(double)) number of standard deviations for the spot ranges
+        THETA : (double) scheme implicitness
+        ADISCHEME : 'DOUGLAS', 'CRAIGSNEYD', optional, default 'CRAIGSNEYD'; Craig-Sneyd is second
+            order in time with THETA = 0.5, Douglas only for zero correlation
+        CONCENTRATIONSPOTS : (list(list(double))) optional; for each asset, the spots around which the nodes
+            are concentrated; an empty list leaves the nodes of that asset equally spaced
+        CONCENTRATIONWIDTH : (double or list(double)) optional; width of the concentration regions as a
+            fraction of the spot range in log space, default 0.1
+        RANNACHERSTEPS : (int) optional; number of steps after each payoff event solved as two fully
+            implicit half steps, default 0
+    nthreads : int
+        number of threads; 0 for the number of hardware threads
+
+    Returns
+    -------
+    dictionary
+        Price : PDE price
+    """
+    return pyorflib.spreadBSPDE(payofftype, strike, timetoexp, american, spots, discountcrv, divyields,
+                                volatilities, correlation, pdeparams, nthreads)
+
+
+def basketBSPDE(payofftype, strike, timetoexp, american, spots, discountcrv, divyields, volatilities, correlations,
+                quantities, pdeparams, sparselevel=None, nthreads=0):
+    """Price of a European or American option on a basket of assets, paying
+    max(payofftype * (sum_k quantities[k] * S_k - strike), 0), in the Black-Scholes model using an N-d
+    finite difference PDE, with one dimension per asset.
+    The PDE is solved with an alternating direction implicit scheme, on one full grid, or by the sparse grid
+    combination of many small anisotropic grids, which grow far slower with the number of assets.
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    strike : double
+        strike of the basket
+    timetoexp : double
+        time to expiration in years
+    american : bool
+        True for daily exercise up to expiration, False for European
+    spots : list(double) or 1D numpy array
+        the spot prices of the assets
+    discountcrv : str
+        discount yield curve name
+    divyields : list(double) or 1D numpy array
+        the dividend yields of the assets, p.a. and c.c.
+    volatilities : list(double) or 1D numpy array
+        the return volatilities of the assets
+    correlations : 2D numpy array
+        the correlation matrix of the asset returns
+    quantities : list(double) or 1D numpy array
+        the quantity of each asset in the basket, can be negative
+    pdeparams : dictionary
+        as for spreadBSPDE, with NSPOTNODES, NSTDDEVS and CONCENTRATIONSPOTS for each asset;
+        with sparse grids, NSPOTNODES are the nodes of the coarsest level, preferably 15 or more
+    sparselevel : int
+        optional; None for one full grid, otherwise the level of the sparse grid combination, at least
+        the number of assets minus one; the grids of level l have (NSPOTNODES + 1) * 2^l - 1 nodes per axis
+    nthreads : int
+        number of threads, for the line solves of the full grid or for the sparse grids;
+        0 for the number of hardware threads
+
+    Returns
+    -------
+    dictionary
+        Price : PDE price
+        GridLevels : 2D numpy array, sparse grids only; the levels of each grid, one row per grid
+        GridPrices : 1D numpy array, sparse grids only; the price on each grid
+        Coefficients : 1D numpy array, sparse grids only; the combination coefficient of each grid
+        Nodes : int, sparse grids only; the total number of nodes of the grids
+        FullGridNodes : int, sparse grids only; the number of nodes of the full grid of the same level
+    """
+    return pyorflib.basketBSPDE(payofftype, strike, timetoexp, american, spots, discountcrv, divyields,
+                                volatilities, correlations, quantities, pdeparams, sparselevel, nthreads)
+
 def ptRisk(ptwghts, assetrets, assetvols, correlmat):
     """Mean and standard deviation of portfolio return.
 
@@ -989,7 +1600,7 @@ def meanVarFront(assetrets, assetvols, correlmat, lambdamax, nsteps):
 def cbBSPDE(facevalue, maturity, convratio, convstart, convend, 
             callstrike, callstart, callend, 
             spot, discountcrv, divyield, volatility, 
-            pdeparams, allresults=False):
+            pdeparams, allresults=False, storeevery=1, spotwindow=None, tangents=False, creditspread=None):
     """Price of a Convertible Bond in the Black-Scholes model using finite difference PDE.
 
     Parameters
@@ -1023,22 +1634,97 @@ def cbBSPDE(facevalue, maturity, convratio, convstart, convend,
         NSPOTNODES : (int) number of spot nodes
         NSTDDEVS : (double) number of standard deviations for the spot range
         THETA : (double) scheme implicitness
+        CONCENTRATIONSPOTS : (list(double)) optional; spots around which the nodes are concentrated,
+            e.g. the strikes; if missing, the nodes are equally spaced
+        CONCENTRATIONWIDTH : (double) optional; width of the concentration regions as a fraction of the
+            spot range in log space, default 0.1; smaller values concentrate more
+        RANNACHERSTEPS : (int) optional; number of steps after each payoff event solved as two fully
+            implicit half steps, default 0
+        EXERCISEMETHOD : 'EXPLICIT', 'BRENNANSCHWARTZ', 'PENALTY', optional, default 'EXPLICIT'; how the
+            early exercise is imposed: after each step, or inside the implicit solve, where it holds
+            continuously between the exercise days
+        ADAPTIVETIMESTEPS : (bool) optional, default False; if True, about NTIMESTEPS steps are picked among
+            the daily exercise dates, concentrated around the expiration and the exercise window boundaries;
+            best with EXERCISEMETHOD other than 'EXPLICIT'
+        BOUNDARYCONDITION : 'LINEAR', 'DIRICHLET', 'NEUMANN', optional, default 'LINEAR'; the values on the
+            edge nodes are extrapolated linearly, or set from the asymptotic values of the product (discounted
+            intrinsic value, bond floor), or from their slopes; the asymptotic conditions allow smaller NSTDDEVS
     allresults : bool
-        FALSE for price only; TRUE for the full grid of results
+        FALSE for price only; TRUE for the grid of results
+    storeevery : int
+        with allresults, keep the values of every storeevery-th time step; the first and last are always kept
+    spotwindow : list(double)
+        with allresults, keep only the spots in [spotwindow[0], spotwindow[1]]; None for all spots
+    tangents : bool
+        if True, also solve for the derivatives of the values in the volatility and in the rate,
+        as extra layers on the same grid; needs EXERCISEMETHOD 'EXPLICIT'
+    creditspread : double
+        if not None, the credit spread of the issuer, p.a. and c.c.; the bond is solved in the two-layer
+        formulation of Tsiveriotis and Fernandes, with the cash part (face value, call strike) discounted
+        at the risk-free rate plus the spread and the equity part at the risk-free rate, both in one solve;
+        needs EXERCISEMETHOD 'EXPLICIT', BOUNDARYCONDITION 'LINEAR' and no tangents
     
     Returns
     -------
     dictionary
         Price : PDE price
+        Delta : first derivative of the price in the spot, from the grid values around the spot
+        Gamma : second derivative of the price in the spot, from the grid values around the spot
+        Theta : derivative of the price in time, from the prices at the first time steps
+        Vega : derivative of the price in the volatility, from the tangent layers
+        Rho : derivative of the price in a parallel shift of the discount curve, from the tangent layers
+        CashPart : the part of the price paid in cash, discounted with the credit spread
         Times : 1D array with times
         Spots : 1D array with spots
         Values : 2D array with option values
 
     Notes
     -----
-    The keys `Times`, `Spots` and `Values` are available only if `allresults`==True.
+    The keys `Times`, `Spots` and `Values` are available only if `allresults`==True,
+    the keys `Vega` and `Rho` only if `tangents`==True, the key `CashPart` only if `creditspread` is not None.
     """
     return pyorflib.cbBSPDE(facevalue, maturity, convratio, convstart, convend, 
                             callstrike, callstart, callend, 
                             spot, discountcrv, divyield, volatility, 
-                            pdeparams, allresults)
\ No newline at end of file
+                            pdeparams, allresults, storeevery, spotwindow, tangents, creditspread)
+
+
+def cbBSPDEParareal(facevalue, maturity, convratio, convstart, convend, 
+                    callstrike, callstart, callend, 
+                    spot, discountcrv, divyield, volatility, 
+                    pdeparams, ncoarsesteps, nslices=None, nthreads=None, tolerance=1.0e-6):
+    """Price of a Convertible Bond in the Black-Scholes model using the parallel in time (Parareal) PDE solver.
+
+    The time steps of pdeparams are split in slices solved in parallel, with a coarse solver on about
+    ncoarsesteps steps propagating the values across the slices; the iterations stop when the values at the
+    slice boundaries change by less than tolerance. Meant for long dated bonds with daily conversion.
+
+    Parameters
+    ----------
+    facevalue, maturity, convratio, convstart, convend, callstrike, callstart, callend,
+    spot, discountcrv, divyield, volatility, pdeparams :
+        as for cbBSPDE
+    ncoarsesteps : int
+        number of time steps of the coarse solver, picked among the steps of pdeparams
+    nslices : int
+        number of time slices; None for the number of threads
+    nthreads : int
+        number of threads for the fine solves; None for the hardware threads
+    tolerance : double
+        the iterations stop when the values at the slice boundaries change by less than this
+
+    Returns
+    -------
+    dictionary
+        Price : PDE price
+        Delta : first derivative of the price in the spot, from the grid values around the spot
+        Gamma : second derivative of the price in the spot, from the grid values around the spot
+        Theta : derivative of the price in time, from the prices at the first time steps
+        Slices : number of time slices
+        Iterations : number of Parareal iterations
+        Corrections : 1D array with the largest change of the values at the slice boundaries, per iteration
+    """
+    return pyorflib.cbBSPDEParareal(facevalue, maturity, convratio, convstart, convend, 
+                                    callstrike, callstart, callend, 
+                                    spot, discountcrv, divyield, volatility, 
+                                    pdeparams, ncoarsesteps, nslices, nthreads, tolerance)
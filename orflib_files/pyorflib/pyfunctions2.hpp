@@ -13,11 +13,13 @@ PY_BEGIN;
 
   std::vector<std::string> ycnames = orf::market().yieldCurves().list();
   std::vector<std::string> volnames = orf::market().volatilities().list();
+  std::vector<std::string> lvnames = orf::market().localVolatilities().list();
 
   // return market contents as a Python dictionary
   PyObject* ret = PyDict_New();
   int ok = PyDict_SetItem(ret, asPyScalar("YieldCurves"), asPyList(ycnames));
   ok = PyDict_SetItem(ret, asPyScalar("Volatilities"), asPyList(volnames));
+  ok = PyDict_SetItem(ret, asPyScalar("LocalVolatilities"), asPyList(lvnames));
   return ret;
 PY_END;
 }
@@ -248,6 +250,54 @@ PY_BEGIN;
 PY_END;
 }
 
+static
+PyObject*  pyOrfLVCreate(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyLVName(NULL);
+  PyObject* pyTimes(NULL);
+  PyObject* pySpots(NULL);
+  PyObject* pyVols(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "OOOO", &pyLVName, &pyTimes, &pySpots, &pyVols))
+    return NULL;
+
+  std::string name = asString(pyLVName);
+  orf::Vector times = asVector(pyTimes);
+  orf::Vector spots = asVector(pySpots);
+  orf::Matrix vols = asMatrix(pyVols);
+
+  std::pair<std::string, unsigned long> pr =
+    orf::market().localVolatilities().set(name, std::make_shared<orf::LocalVolSurface>(times, spots, vols));
+
+  std::string tag = pr.first;
+  return asPyScalar(tag);
+PY_END;
+}
+
+static
+PyObject*  pyOrfLocalVol(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyLVName(NULL);
+  PyObject* pyTime(NULL);
+  PyObject* pySpot(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "OOO", &pyLVName, &pyTime, &pySpot))
+    return NULL;
+
+  std::string name = asString(pyLVName);
+  double t = asDouble(pyTime);
+  double spot = asDouble(pySpot);
+
+  orf::SPtrLocalVolSurface splv = orf::market().localVolatilities().get(name);
+  ORF_ASSERT(splv, "error: local volatility surface " + name + " not found");
+
+  double lvol = splv->localVol(t, spot);
+  return asPyScalar(lvol);
+PY_END;
+}
+
 static
 PyObject*  pyOrfCapFloorletBS(PyObject* pyDummy, PyObject* pyArgs)
 {
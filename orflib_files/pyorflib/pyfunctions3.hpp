@@ -6,11 +6,33 @@
 
 #include <orflib/defines.hpp>
 #include <orflib/products/europeancallput.hpp>
+#include <orflib/products/digitalcallput.hpp>
 #include <orflib/products/asianbasketcallput.hpp>
+#include <orflib/products/barriercallput.hpp>
 #include <orflib/pricers/bsmcpricer.hpp>
 #include <orflib/pricers/multiassetbsmcpricer.hpp>
 #include <orflib/math/stats/meanvarcalculator.hpp>
+#include <orflib/math/stats/quantilecalculator.hpp>
+#include <orflib/math/stats/compositecalculator.hpp>
 #include <orflib/math/random/rng.hpp>
+#include <memory>
+
+/** Creates a quantile calculator if quantile probabilities are passed in, otherwise returns null.
+    The quantiles are those of the path PVs, so neither importance sampling nor stratification is allowed.
+*/
+static
+std::unique_ptr<orf::QuantileCalculator<double *>> asQuantileCalculator(PyObject* pyQuantiles, size_t nvars,
+                                                                        orf::McParams const& mcparams)
+{
+  std::unique_ptr<orf::QuantileCalculator<double *>> qc;
+  if (pyQuantiles == NULL || pyQuantiles == Py_None)
+    return qc;
+  ORF_ASSERT(!mcparams.impSampling, "error: quantiles are not available with importance sampling");
+  ORF_ASSERT(mcparams.samplingType == orf::McParams::SamplingType::PLAIN,
+    "error: quantiles are not available with stratified sampling");
+  qc.reset(new orf::QuantileCalculator<double *>(nvars, asVector(pyQuantiles)));
+  return qc;
+}
 
 
 static
@@ -27,9 +49,10 @@ PY_BEGIN;
   PyObject* pyVolatility(NULL);
   PyObject* pyMcParams(NULL);
   PyObject* pyNPaths(NULL);
+  PyObject* pyQuantiles(NULL);
 
-  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOO", &pyPayoffType, &pyStrike, &pyTimeToExp, 
-    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyMcParams, &pyNPaths))
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOO|O", &pyPayoffType, &pyStrike, &pyTimeToExp, 
+    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyMcParams, &pyNPaths, &pyQuantiles))
     return NULL;
 
   int payoffType = asInt(pyPayoffType);
@@ -42,7 +65,7 @@ PY_BEGIN;
   ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
 
   double divYield = asDouble(pyDivYield);
-  double vol = asDouble(pyVolatility);
+  orf::SPtrVolatilityTermStructure spvol = asVolTermStructure(pyVolatility);
  
   // read the MC parameters
   orf::McParams mcparams = asMcParams(pyMcParams);
@@ -52,11 +75,91 @@ PY_BEGIN;
   // create the product
   orf::SPtrProduct spprod(new orf::EuropeanCallPut(payoffType, strike, timeToExp));
   // create the pricer
-  orf::BsMcPricer bsmcpricer(spprod, spyc, divYield, vol, spot, mcparams);
-  // create the statistics calculator
+  orf::BsMcPricer bsmcpricer(spprod, spyc, divYield, spvol, spot, mcparams);
+  // create the statistics calculators; the quantiles are optional
+  orf::MeanVarCalculator<double *> sc(bsmcpricer.nVariables());
+  std::unique_ptr<orf::QuantileCalculator<double *>> qc = asQuantileCalculator(pyQuantiles, bsmcpricer.nVariables(), mcparams);
+  // run the simulation
+  if (qc) {
+    orf::CompositeCalculator<double *> cc({ &sc, qc.get() });
+    bsmcpricer.simulate(cc, npaths);
+  }
+  else
+    bsmcpricer.simulate(sc, npaths);
+  // collect results
+  orf::Matrix const& results = sc.results();
+  // read out results
+  size_t nsamples = sc.nSamples();
+  double mean = results(0, 0);
+  double stderror = results(1, 0);
+  stderror = std::sqrt(stderror / nsamples);
+
+  // write mean and standard error into a Python dictionary
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("Mean"), asPyScalar(mean));
+  PyDict_SetItem(ret, asPyScalar("StdErr"), asPyScalar(stderror));
+  if (qc)
+    PyDict_SetItem(ret, asPyScalar("Quantiles"), asNumpy(orf::Vector(qc->results().col(0))));
+  if (mcparams.impSampling) {
+    PyDict_SetItem(ret, asPyScalar("MeanShift"), asPyScalar(bsmcpricer.meanShift()));
+    PyDict_SetItem(ret, asPyScalar("VarRedFactor"), asPyScalar(bsmcpricer.varianceReductionFactor()));
+  }
+  return ret;
+
+PY_END;
+}
+
+static
+PyObject*  pyOrfDigiBSMC(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+  PyObject* pyMcParams(NULL);
+  PyObject* pyNPaths(NULL);
+  PyObject* pyQuantiles(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOO|O", &pyPayoffType, &pyStrike, &pyTimeToExp, 
+    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyMcParams, &pyNPaths, &pyQuantiles))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  double spot = asDouble(pySpot);
+  double strike = asDouble(pyStrike);
+  double timeToExp = asDouble(pyTimeToExp);
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  double divYield = asDouble(pyDivYield);
+  orf::SPtrVolatilityTermStructure spvol = asVolTermStructure(pyVolatility);
+ 
+  // read the MC parameters
+  orf::McParams mcparams = asMcParams(pyMcParams);
+  // read the number of paths
+  unsigned long npaths = asInt(pyNPaths);
+
+  // create the product
+  orf::SPtrProduct spprod(new orf::DigitalCallPut(payoffType, strike, timeToExp));
+  // create the pricer
+  orf::BsMcPricer bsmcpricer(spprod, spyc, divYield, spvol, spot, mcparams);
+  // create the statistics calculators; the quantiles are optional
   orf::MeanVarCalculator<double *> sc(bsmcpricer.nVariables());
+  std::unique_ptr<orf::QuantileCalculator<double *>> qc = asQuantileCalculator(pyQuantiles, bsmcpricer.nVariables(), mcparams);
   // run the simulation
-  bsmcpricer.simulate(sc, npaths);
+  if (qc) {
+    orf::CompositeCalculator<double *> cc({ &sc, qc.get() });
+    bsmcpricer.simulate(cc, npaths);
+  }
+  else
+    bsmcpricer.simulate(sc, npaths);
   // collect results
   orf::Matrix const& results = sc.results();
   // read out results
@@ -69,6 +172,12 @@ PY_BEGIN;
   PyObject* ret = PyDict_New();
   int ok = PyDict_SetItem(ret, asPyScalar("Mean"), asPyScalar(mean));
   PyDict_SetItem(ret, asPyScalar("StdErr"), asPyScalar(stderror));
+  if (qc)
+    PyDict_SetItem(ret, asPyScalar("Quantiles"), asNumpy(orf::Vector(qc->results().col(0))));
+  if (mcparams.impSampling) {
+    PyDict_SetItem(ret, asPyScalar("MeanShift"), asPyScalar(bsmcpricer.meanShift()));
+    PyDict_SetItem(ret, asPyScalar("VarRedFactor"), asPyScalar(bsmcpricer.varianceReductionFactor()));
+  }
   return ret;
 
 PY_END;
@@ -90,10 +199,11 @@ PY_BEGIN;
   PyObject* pyCorrelMatrix(NULL);
   PyObject* pyMcParams(NULL);
   PyObject* pyNPaths(NULL);
+  PyObject* pyQuantiles(NULL);
 
-  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOO", &pyPayoffType, &pyStrike, &pyFixingTimes, 
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOO|O", &pyPayoffType, &pyStrike, &pyFixingTimes, 
     &pyAssetQuantities, &pySpots, &pyDiscountCrv, &pyDivYields, &pyVolatilities, 
-    &pyCorrelMatrix, &pyMcParams, &pyNPaths))
+    &pyCorrelMatrix, &pyMcParams, &pyNPaths, &pyQuantiles))
     return NULL;
 
   int payoffType = asInt(pyPayoffType);
@@ -107,7 +217,7 @@ PY_BEGIN;
   ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
 
   orf::Vector divYields = asVector(pyDivYields);
-  orf::Vector vols = asVector(pyVolatilities);
+  std::vector<orf::SPtrVolatilityTermStructure> vols = asVolTermStructures(pyVolatilities);
   orf::Matrix correlMat = asMatrix(pyCorrelMatrix);
   // read the MC parameters
   orf::McParams mcparams = asMcParams(pyMcParams);
@@ -118,10 +228,16 @@ PY_BEGIN;
   orf::SPtrProduct spprod(new orf::AsianBasketCallPut(payoffType, strike, fixingTimes, assetQuantities));
   // create the pricer
   orf::MultiAssetBsMcPricer bsmcpricer(spprod, spyc, divYields, vols, spots, correlMat, mcparams);
-  // create the statistics calculator
+  // create the statistics calculators; the quantiles are optional
   orf::MeanVarCalculator<double *> sc(bsmcpricer.nVariables());
+  std::unique_ptr<orf::QuantileCalculator<double *>> qc = asQuantileCalculator(pyQuantiles, bsmcpricer.nVariables(), mcparams);
   // run the simulation
-  bsmcpricer.simulate(sc, npaths);
+  if (qc) {
+    orf::CompositeCalculator<double *> cc({ &sc, qc.get() });
+    bsmcpricer.simulate(cc, npaths);
+  }
+  else
+    bsmcpricer.simulate(sc, npaths);
   // collect results
   orf::Matrix const & results = sc.results();
   // read out results
@@ -133,6 +249,101 @@ PY_BEGIN;
   PyObject* ret = PyDict_New();
   int ok = PyDict_SetItem(ret, asPyScalar("Mean"), asPyScalar(mean));
   PyDict_SetItem(ret, asPyScalar("StdErr"), asPyScalar(stderror));
+  if (qc)
+    PyDict_SetItem(ret, asPyScalar("Quantiles"), asNumpy(orf::Vector(qc->results().col(0))));
+  return ret;
+
+PY_END;
+}
+
+static
+PyObject*  pyOrfBarrierBSMC(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyBarrierType(NULL);
+  PyObject* pyBarrier(NULL);
+  PyObject* pyNFixings(NULL);
+  PyObject* pyBridgeCorrection(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+  PyObject* pyMcParams(NULL);
+  PyObject* pyNPaths(NULL);
+  PyObject* pyQuantiles(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOOOO|O", &pyPayoffType, &pyStrike, &pyTimeToExp,
+    &pyBarrierType, &pyBarrier, &pyNFixings, &pyBridgeCorrection,
+    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyMcParams, &pyNPaths, &pyQuantiles))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  double strike = asDouble(pyStrike);
+  double timeToExp = asDouble(pyTimeToExp);
+
+  std::string bartype = trim(asString(pyBarrierType));
+  std::transform(bartype.begin(), bartype.end(), bartype.begin(), ::toupper);
+  orf::BarrierCallPut::BarrierType barrierType;
+  if (bartype == "UPOUT")
+    barrierType = orf::BarrierCallPut::BarrierType::UPOUT;
+  else if (bartype == "UPIN")
+    barrierType = orf::BarrierCallPut::BarrierType::UPIN;
+  else if (bartype == "DOWNOUT")
+    barrierType = orf::BarrierCallPut::BarrierType::DOWNOUT;
+  else if (bartype == "DOWNIN")
+    barrierType = orf::BarrierCallPut::BarrierType::DOWNIN;
+  else
+    ORF_ASSERT(0, "error: invalid barrier type " + bartype);
+
+  double barrier = asDouble(pyBarrier);
+  size_t nfixings = asInt(pyNFixings);
+  bool bridgeCorrection = asBool(pyBridgeCorrection);
+  double spot = asDouble(pySpot);
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  double divYield = asDouble(pyDivYield);
+  orf::SPtrVolatilityTermStructure spvol = asVolTermStructure(pyVolatility);
+
+  // read the MC parameters
+  orf::McParams mcparams = asMcParams(pyMcParams);
+  // read the number of paths
+  unsigned long npaths = asInt(pyNPaths);
+
+  // create the product
+  orf::SPtrProduct spprod(new orf::BarrierCallPut(payoffType, strike, timeToExp,
+    barrierType, barrier, nfixings, bridgeCorrection));
+  // create the pricer
+  orf::BsMcPricer bsmcpricer(spprod, spyc, divYield, spvol, spot, mcparams);
+  // create the statistics calculators; the quantiles are optional
+  orf::MeanVarCalculator<double *> sc(bsmcpricer.nVariables());
+  std::unique_ptr<orf::QuantileCalculator<double *>> qc = asQuantileCalculator(pyQuantiles, bsmcpricer.nVariables(), mcparams);
+  // run the simulation
+  if (qc) {
+    orf::CompositeCalculator<double *> cc({ &sc, qc.get() });
+    bsmcpricer.simulate(cc, npaths);
+  }
+  else
+    bsmcpricer.simulate(sc, npaths);
+  // collect results
+  orf::Matrix const& results = sc.results();
+  // read out results
+  double mean = results(0, 0);
+  double stderror = results(1, 0);
+  stderror = std::sqrt(stderror / sc.nSamples());
+
+  // write mean and standard error into a Python dictionary
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("Mean"), asPyScalar(mean));
+  PyDict_SetItem(ret, asPyScalar("StdErr"), asPyScalar(stderror));
+  if (qc)
+    PyDict_SetItem(ret, asPyScalar("Quantiles"), asNumpy(orf::Vector(qc->results().col(0))));
   return ret;
 
 PY_END;
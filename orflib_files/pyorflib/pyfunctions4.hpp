@@ -8,10 +8,47 @@
 #include <orflib/products/europeancallput.hpp>
 #include <orflib/products/americancallput.hpp>
 #include <orflib/methods/pde/pde1dsolver.hpp>
+#include <orflib/methods/pde/pde1dbatch.hpp>
+#include <orflib/methods/pde/pde1drichardson.hpp>
+#include <orflib/methods/pde/pde1dparareal.hpp>
+#include <orflib/methods/pde/pde2dsolver.hpp>
+#include <orflib/methods/pde/pdeforwardsolver.hpp>
+#include <orflib/methods/pde/pdesparsegrid.hpp>
+#include <orflib/products/spreadcallput.hpp>
+#include <orflib/products/basketcallput.hpp>
 #include <orflib/products/convertiblebond.hpp> 
 
 using namespace std;
 
+/** Creates the results sink for the optional storage frequency and spot window arguments.
+    Returns a null pointer if not all results are requested. */
+static
+std::shared_ptr<orf::Pde1DMemorySink> asPdeResultsSink(bool allresults, PyObject* pyStoreEvery, PyObject* pySpotWindow)
+{
+  if (!allresults)
+    return std::shared_ptr<orf::Pde1DMemorySink>();
+  size_t storeEvery = 1;
+  if (pyStoreEvery != NULL && pyStoreEvery != Py_None)
+    storeEvery = (size_t) asInt(pyStoreEvery);
+  double sMin = 0.0, sMax = std::numeric_limits<double>::infinity();
+  if (pySpotWindow != NULL && pySpotWindow != Py_None) {
+    std::vector<double> window = asDblVec(pySpotWindow);
+    ORF_ASSERT(window.size() == 2, "error: the spot window must have two elements, the lowest and the highest spot");
+    sMin = window[0];
+    sMax = window[1];
+  }
+  return std::make_shared<orf::Pde1DMemorySink>(storeEvery, sMin, sMax);
+}
+
+/** Writes the times, spots and values of the first layer held by the sink */
+static
+void setPdeSinkResults(PyObject* ret, orf::Pde1DMemorySink const& sink)
+{
+  PyDict_SetItem(ret, asPyScalar("Times"), asNumpy(sink.times()));
+  PyDict_SetItem(ret, asPyScalar("Spots"), asNumpy(sink.spots()));
+  PyDict_SetItem(ret, asPyScalar("Values"), asNumpy(sink.layerValues(0)));
+}
+
 static
 PyObject*  pyOrfEuroBSPDE(PyObject* pyDummy, PyObject* pyArgs)
 {
@@ -26,9 +63,13 @@ PY_BEGIN;
   PyObject* pyVolatility(NULL);
   PyObject* pyPdeParams(NULL);
   PyObject* pyAllResults(NULL);
+  PyObject* pyStoreEvery(NULL);
+  PyObject* pySpotWindow(NULL);
+  PyObject* pyTangents(NULL);
 
-  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOO", &pyPayoffType, &pyStrike, &pyTimeToExp, 
-    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyPdeParams, &pyAllResults))
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOO|OOO", &pyPayoffType, &pyStrike, &pyTimeToExp, 
+    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyPdeParams, &pyAllResults,
+    &pyStoreEvery, &pySpotWindow, &pyTangents))
     return NULL;
 
   int payoffType = asInt(pyPayoffType);
@@ -45,32 +86,34 @@ PY_BEGIN;
 
   // read the PDE parameters
   orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
-  // read the allresults flag
+  // read the allresults flag and the storage options
   bool allresults = asBool(pyAllResults);
+  std::shared_ptr<orf::Pde1DMemorySink> spsink = asPdeResultsSink(allresults, pyStoreEvery, pySpotWindow);
 
   // create the product
   orf::SPtrProduct spprod(new orf::EuropeanCallPut(payoffType, strike, timeToExp));
   // create the PDE solver
   orf::Pde1DResults results;
   orf::Pde1DSolver solver(spprod, spyc, spot, divYield, vol, results);
+  solver.setResultsSink(spsink);
+  // the vega and rho layers, on request
+  bool tangents = pyTangents != NULL && pyTangents != Py_None && asBool(pyTangents);
+  solver.setTangentSensitivities(tangents, tangents);
   solver.solve(pdeparams);
 
   // write results
   PyObject* ret = PyDict_New();
   int ok = PyDict_SetItem(ret, asPyScalar("Price"), asPyScalar(results.prices[0]));
-
-  if (allresults) {
-    orf::Vector spots;
-    results.getSpotAxis(0, spots);
-    orf::Matrix values(results.times.size(), results.values.front().size());
-    for (size_t i = 0; i < results.times.size(); ++i)
-      for (size_t j = 0; j < results.values.front().size(); ++j)
-        values(i, j) = results.values[i](j, 0);
-
-    PyDict_SetItem(ret, asPyScalar("Times"), asNumpy(results.times));
-    PyDict_SetItem(ret, asPyScalar("Spots"), asNumpy(spots));
-    PyDict_SetItem(ret, asPyScalar("Values"), asNumpy(values));
+  ok = PyDict_SetItem(ret, asPyScalar("Delta"), asPyScalar(results.deltas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Gamma"), asPyScalar(results.gammas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Theta"), asPyScalar(results.thetas[0]));
+  if (tangents) {
+    ok = PyDict_SetItem(ret, asPyScalar("Vega"), asPyScalar(results.vegas[0]));
+    ok = PyDict_SetItem(ret, asPyScalar("Rho"), asPyScalar(results.rhos[0]));
   }
+
+  if (spsink)
+    setPdeSinkResults(ret, *spsink);
   return ret;
 
 PY_END;
@@ -90,9 +133,13 @@ PY_BEGIN;
   PyObject* pyVolatility(NULL);
   PyObject* pyPdeParams(NULL);
   PyObject* pyAllResults(NULL);
+  PyObject* pyStoreEvery(NULL);
+  PyObject* pySpotWindow(NULL);
+  PyObject* pyTangents(NULL);
 
-  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOO", &pyPayoffType, &pyStrike, &pyTimeToExp, 
-    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyPdeParams, &pyAllResults))
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOO|OOO", &pyPayoffType, &pyStrike, &pyTimeToExp, 
+    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyPdeParams, &pyAllResults,
+    &pyStoreEvery, &pySpotWindow, &pyTangents))
     return NULL;
 
   int payoffType = asInt(pyPayoffType);
@@ -109,33 +156,34 @@ PY_BEGIN;
 
   // read the PDE parameters
   orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
-  // read the allresults flag
+  // read the allresults flag and the storage options
   bool allresults = asBool(pyAllResults);
+  std::shared_ptr<orf::Pde1DMemorySink> spsink = asPdeResultsSink(allresults, pyStoreEvery, pySpotWindow);
 
   // create the product
   orf::SPtrProduct spprod(new orf::AmericanCallPut(payoffType, strike, timeToExp));
   // create the PDE solver
   orf::Pde1DResults results;
-  bool storeAllResults = true;
-  orf::Pde1DSolver solver(spprod, spyc, spot, divYield, vol, results, storeAllResults);
+  orf::Pde1DSolver solver(spprod, spyc, spot, divYield, vol, results);
+  solver.setResultsSink(spsink);
+  // the vega and rho layers, on request
+  bool tangents = pyTangents != NULL && pyTangents != Py_None && asBool(pyTangents);
+  solver.setTangentSensitivities(tangents, tangents);
   solver.solve(pdeparams);
 
   // write results
   PyObject* ret = PyDict_New();
   int ok = PyDict_SetItem(ret, asPyScalar("Price"), asPyScalar(results.prices[0]));
-
-  if (allresults) {
-    orf::Vector spots;
-    results.getSpotAxis(0, spots);
-    orf::Matrix values(results.times.size(), results.values.front().size());
-    for (size_t i = 0; i < results.times.size(); ++i)
-      for (size_t j = 0; j < results.values.front().size(); ++j)
-        values(i, j) = results.values[i](j, 0);
-
-    PyDict_SetItem(ret, asPyScalar("Times"), asNumpy(results.times));
-    PyDict_SetItem(ret, asPyScalar("Spots"), asNumpy(spots));
-    PyDict_SetItem(ret, asPyScalar("Values"), asNumpy(values));
+  ok = PyDict_SetItem(ret, asPyScalar("Delta"), asPyScalar(results.deltas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Gamma"), asPyScalar(results.gammas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Theta"), asPyScalar(results.thetas[0]));
+  if (tangents) {
+    ok = PyDict_SetItem(ret, asPyScalar("Vega"), asPyScalar(results.vegas[0]));
+    ok = PyDict_SetItem(ret, asPyScalar("Rho"), asPyScalar(results.rhos[0]));
   }
+
+  if (spsink)
+    setPdeSinkResults(ret, *spsink);
   return ret;
 
 PY_END;
@@ -162,12 +210,16 @@ PyObject* pyOrfCbBSPDE(PyObject* pyDummy, PyObject* pyArgs)
   
   PyObject* pyPdeParams(NULL);
   PyObject* pyAllResults(NULL);
+  PyObject* pyStoreEvery(NULL);
+  PyObject* pySpotWindow(NULL);
+  PyObject* pyTangents(NULL);
+  PyObject* pyCreditSpread(NULL);
 
-  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOOOOO", 
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOOOOO|OOOO", 
       &pyFaceValue, &pyMaturity, &pyConvRatio, &pyConvStart, &pyConvEnd,
       &pyCallStrike, &pyCallStart, &pyCallEnd,
       &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility,
-      &pyPdeParams, &pyAllResults))
+      &pyPdeParams, &pyAllResults, &pyStoreEvery, &pySpotWindow, &pyTangents, &pyCreditSpread))
     return NULL;
 
   double faceValue = asDouble(pyFaceValue);
@@ -189,33 +241,654 @@ PyObject* pyOrfCbBSPDE(PyObject* pyDummy, PyObject* pyArgs)
 
   orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
   bool allresults = asBool(pyAllResults);
+  std::shared_ptr<orf::Pde1DMemorySink> spsink = asPdeResultsSink(allresults, pyStoreEvery, pySpotWindow);
 
   orf::SPtrProduct spprod(new orf::ConvertibleBond(
       faceValue, maturity, convRatio, convStart, convEnd, 
       callStrike, callStart, callEnd));
 
   orf::Pde1DResults results;
-  orf::Pde1DSolver solver(spprod, spyc, spot, divYield, vol, results, allresults);
+  orf::Pde1DSolver solver(spprod, spyc, spot, divYield, vol, results);
+  solver.setResultsSink(spsink);
+  // the vega and rho layers, on request
+  bool tangents = pyTangents != NULL && pyTangents != Py_None && asBool(pyTangents);
+  solver.setTangentSensitivities(tangents, tangents);
+  // the cash part discounted with the credit spread, in a second layer of the same solve
+  bool credit = pyCreditSpread != NULL && pyCreditSpread != Py_None;
+  if (credit)
+    solver.setCreditSpread(asDouble(pyCreditSpread));
+  solver.solve(pdeparams);
+
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("Price"), asPyScalar(results.prices[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Delta"), asPyScalar(results.deltas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Gamma"), asPyScalar(results.gammas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Theta"), asPyScalar(results.thetas[0]));
+  if (tangents) {
+    ok = PyDict_SetItem(ret, asPyScalar("Vega"), asPyScalar(results.vegas[0]));
+    ok = PyDict_SetItem(ret, asPyScalar("Rho"), asPyScalar(results.rhos[0]));
+  }
+  if (credit)
+    ok = PyDict_SetItem(ret, asPyScalar("CashPart"), asPyScalar(results.cashParts[0]));
+
+  if (spsink)
+    setPdeSinkResults(ret, *spsink);
+  return ret;
+
+  PY_END;
+}
+
+static
+PyObject*  pyOrfCbBSPDEParareal(PyObject* pyDummy, PyObject* pyArgs)
+{
+  PY_BEGIN;
+
+  PyObject* pyFaceValue(NULL);
+  PyObject* pyMaturity(NULL);
+  PyObject* pyConvRatio(NULL);
+  PyObject* pyConvStart(NULL);
+  PyObject* pyConvEnd(NULL);
+  PyObject* pyCallStrike(NULL);
+  PyObject* pyCallStart(NULL);
+  PyObject* pyCallEnd(NULL);
+
+  PyObject* pySpot(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+
+  PyObject* pyPdeParams(NULL);
+  PyObject* pyNCoarseSteps(NULL);
+  PyObject* pyNSlices(NULL);
+  PyObject* pyNThreads(NULL);
+  PyObject* pyTolerance(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOOOOO|OOO",
+      &pyFaceValue, &pyMaturity, &pyConvRatio, &pyConvStart, &pyConvEnd,
+      &pyCallStrike, &pyCallStart, &pyCallEnd,
+      &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility,
+      &pyPdeParams, &pyNCoarseSteps, &pyNSlices, &pyNThreads, &pyTolerance))
+    return NULL;
+
+  double faceValue = asDouble(pyFaceValue);
+  double maturity = asDouble(pyMaturity);
+  double convRatio = asDouble(pyConvRatio);
+  double convStart = asDouble(pyConvStart);
+  double convEnd = asDouble(pyConvEnd);
+  double callStrike = asDouble(pyCallStrike);
+  double callStart = asDouble(pyCallStart);
+  double callEnd = asDouble(pyCallEnd);
+
+  double spot = asDouble(pySpot);
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVolatility);
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
+  size_t nCoarseSteps = (size_t) asInt(pyNCoarseSteps);
+  size_t nSlices = 0, nThreads = 0;
+  if (pyNSlices != NULL && pyNSlices != Py_None)
+    nSlices = (size_t) asInt(pyNSlices);
+  if (pyNThreads != NULL && pyNThreads != Py_None)
+    nThreads = (size_t) asInt(pyNThreads);
+  double tolerance = 1.0e-6;
+  if (pyTolerance != NULL && pyTolerance != Py_None)
+    tolerance = asDouble(pyTolerance);
+
+  // the fine and the coarse solvers each need their own product
+  auto factory = [=]() {
+    return orf::SPtrProduct(new orf::ConvertibleBond(
+        faceValue, maturity, convRatio, convStart, convEnd,
+        callStrike, callStart, callEnd));
+  };
+  orf::Pde1DPararealResults pres = orf::solvePde1DParareal(factory, spyc, spot, divYield, vol, pdeparams,
+                                                           nCoarseSteps, nSlices, nThreads, tolerance);
+
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("Price"), asPyScalar(pres.results.prices[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Delta"), asPyScalar(pres.results.deltas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Gamma"), asPyScalar(pres.results.gammas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Theta"), asPyScalar(pres.results.thetas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Slices"), asPyScalar((int) pres.nSlices));
+  ok = PyDict_SetItem(ret, asPyScalar("Iterations"), asPyScalar((int) pres.nIterations));
+  ok = PyDict_SetItem(ret, asPyScalar("Corrections"), asNumpy(pres.corrections));
+  return ret;
+
+  PY_END;
+}
+
+static
+PyObject*  pyOrfBSPDEBatch(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffTypes(NULL);
+  PyObject* pyStrikes(NULL);
+  PyObject* pyTimesToExp(NULL);
+  PyObject* pyAmericans(NULL);
+  PyObject* pySpots(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYields(NULL);
+  PyObject* pyVolatilities(NULL);
+  PyObject* pyPdeParams(NULL);
+  PyObject* pyNThreads(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOO", &pyPayoffTypes, &pyStrikes, &pyTimesToExp, &pyAmericans,
+    &pySpots, &pyDiscountCrv, &pyDivYields, &pyVolatilities, &pyPdeParams, &pyNThreads))
+    return NULL;
+
+  std::vector<double> payoffTypes = asDblVec(pyPayoffTypes);
+  std::vector<double> strikes = asDblVec(pyStrikes);
+  std::vector<double> timesToExp = asDblVec(pyTimesToExp);
+  std::vector<double> americans = asDblVec(pyAmericans);
+  std::vector<double> spots = asDblVec(pySpots);
+  std::vector<double> divYields = asDblVec(pyDivYields);
+  std::vector<double> vols = asDblVec(pyVolatilities);
+  size_t njobs = strikes.size();
+  ORF_ASSERT(payoffTypes.size() == njobs && timesToExp.size() == njobs && americans.size() == njobs
+    && spots.size() == njobs && divYields.size() == njobs && vols.size() == njobs,
+    "error: all option and market inputs must have the same size");
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  // read the PDE parameters
+  orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
+  // read the number of threads
+  size_t nthreads = (size_t) asInt(pyNThreads);
+
+  // create the jobs, one product each
+  std::vector<orf::Pde1DJob> jobs(njobs);
+  for (size_t i = 0; i < njobs; ++i) {
+    int payoffType = (int) payoffTypes[i];
+    orf::SPtrProduct spprod;
+    if (americans[i] != 0.0)
+      spprod.reset(new orf::AmericanCallPut(payoffType, strikes[i], timesToExp[i]));
+    else
+      spprod.reset(new orf::EuropeanCallPut(payoffType, strikes[i], timesToExp[i]));
+    jobs[i] = orf::Pde1DJob(spprod, spyc, spots[i], divYields[i], vols[i], pdeparams);
+  }
+
+  // solve without holding the GIL
+  std::vector<orf::Pde1DResults> results;
+  PyThreadState* pyState = PyEval_SaveThread();
+  try {
+    results = orf::solvePde1DBatch(jobs, nthreads);
+  }
+  catch (...) {
+    PyEval_RestoreThread(pyState);
+    throw;
+  }
+  PyEval_RestoreThread(pyState);
+
+  // write results
+  orf::Vector prices(njobs);
+  for (size_t i = 0; i < njobs; ++i)
+    prices[i] = results[i].prices[0];
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("Prices"), asNumpy(prices));
+  return ret;
+
+PY_END;
+}
+
+static
+PyObject*  pyOrfBSPDELadder(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffTypes(NULL);
+  PyObject* pyStrikes(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyAmerican(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+  PyObject* pyPdeParams(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOO", &pyPayoffTypes, &pyStrikes, &pyTimeToExp, &pyAmerican,
+    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyPdeParams))
+    return NULL;
+
+  std::vector<double> payoffTypes = asDblVec(pyPayoffTypes);
+  std::vector<double> strikes = asDblVec(pyStrikes);
+  ORF_ASSERT(payoffTypes.size() == strikes.size(), "error: payoff types and strikes must have the same size");
+  double timeToExp = asDouble(pyTimeToExp);
+  bool american = asBool(pyAmerican);
+  double spot = asDouble(pySpot);
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVolatility);
+
+  // read the PDE parameters
+  orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
+
+  // create the products, one per layer
+  std::vector<orf::SPtrProduct> spprods;
+  for (size_t i = 0; i < strikes.size(); ++i) {
+    int payoffType = (int) payoffTypes[i];
+    if (american)
+      spprods.emplace_back(new orf::AmericanCallPut(payoffType, strikes[i], timeToExp));
+    else
+      spprods.emplace_back(new orf::EuropeanCallPut(payoffType, strikes[i], timeToExp));
+  }
+  // create the PDE solver
+  orf::Pde1DResults results;
+  orf::Pde1DSolver solver(spprods, spyc, spot, divYield, vol, results);
+  solver.solve(pdeparams);
+
+  // write results
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("Prices"), asNumpy(results.prices));
+  return ret;
+
+PY_END;
+}
+
+static
+PyObject*  pyOrfBSPDESpots(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyAmerican(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pySpots(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+  PyObject* pyPdeParams(NULL);
+  PyObject* pyGreeks(NULL);
 
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOO|O", &pyPayoffType, &pyStrike, &pyTimeToExp, &pyAmerican,
+    &pySpot, &pySpots, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyPdeParams, &pyGreeks))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  double strike = asDouble(pyStrike);
+  double timeToExp = asDouble(pyTimeToExp);
+  bool american = asBool(pyAmerican);
+  double spot = asDouble(pySpot);
+  std::vector<double> spots = asDblVec(pySpots);
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVolatility);
+
+  // read the PDE parameters
+  orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
+  bool greeks = pyGreeks != NULL && pyGreeks != Py_None && asBool(pyGreeks);
+
+  // create the product
+  orf::SPtrProduct spprod;
+  if (american)
+    spprod.reset(new orf::AmericanCallPut(payoffType, strike, timeToExp));
+  else
+    spprod.reset(new orf::EuropeanCallPut(payoffType, strike, timeToExp));
+  // create the PDE solver, with the grid around spot
+  orf::Pde1DResults results;
+  orf::Pde1DSolver solver(spprod, spyc, spot, divYield, vol, results);
+  solver.setOutputSpots(spots, greeks);
   solver.solve(pdeparams);
 
+  // write results
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("Prices"), asNumpy(orf::Vector(results.spotPrices.col(0))));
+  if (greeks) {
+    ok = PyDict_SetItem(ret, asPyScalar("Deltas"), asNumpy(orf::Vector(results.spotDeltas.col(0))));
+    ok = PyDict_SetItem(ret, asPyScalar("Gammas"), asNumpy(orf::Vector(results.spotGammas.col(0))));
+    ok = PyDict_SetItem(ret, asPyScalar("Thetas"), asNumpy(orf::Vector(results.spotThetas.col(0))));
+  }
+  return ret;
+
+PY_END;
+}
+
+static
+PyObject*  pyOrfLVPDE(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyAmerican(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyLocalVol(NULL);
+  PyObject* pyPdeParams(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOO", &pyPayoffType, &pyStrike, &pyTimeToExp, &pyAmerican,
+    &pySpot, &pyDiscountCrv, &pyDivYield, &pyLocalVol, &pyPdeParams))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  double strike = asDouble(pyStrike);
+  double timeToExp = asDouble(pyTimeToExp);
+  bool american = asBool(pyAmerican);
+  double spot = asDouble(pySpot);
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  double divYield = asDouble(pyDivYield);
+
+  name = asString(pyLocalVol);
+  orf::SPtrLocalVolSurface splv = orf::market().localVolatilities().get(name);
+  ORF_ASSERT(splv, "error: local volatility surface " + name + " not found");
+
+  // read the PDE parameters
+  orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
+
+  // create the product
+  orf::SPtrProduct spprod;
+  if (american)
+    spprod.reset(new orf::AmericanCallPut(payoffType, strike, timeToExp));
+  else
+    spprod.reset(new orf::EuropeanCallPut(payoffType, strike, timeToExp));
+  // create the PDE solver; the range of the grid is set from the local vol at the spot and the expiration
+  orf::Pde1DResults results;
+  orf::Pde1DSolver solver(spprod, spyc, spot, divYield, splv->localVol(timeToExp, spot), results);
+  // a single solve, so the local vols are tabulated on all the hardware threads
+  solver.setLocalVolSurface(splv, 0, 0);
+  solver.solve(pdeparams);
+
+  // write results
   PyObject* ret = PyDict_New();
   int ok = PyDict_SetItem(ret, asPyScalar("Price"), asPyScalar(results.prices[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Delta"), asPyScalar(results.deltas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Gamma"), asPyScalar(results.gammas[0]));
+  ok = PyDict_SetItem(ret, asPyScalar("Theta"), asPyScalar(results.thetas[0]));
+  return ret;
 
-  if (allresults) {
-    orf::Vector spots;
-    results.getSpotAxis(0, spots);
-    orf::Matrix values(results.times.size(), results.values.front().size());
-    
-    for (size_t i = 0; i < results.times.size(); ++i)
-      for (size_t j = 0; j < results.values.front().size(); ++j)
-        values(i, j) = results.values[i](j, 0);
+PY_END;
+}
 
-    PyDict_SetItem(ret, asPyScalar("Times"), asNumpy(results.times));
-    PyDict_SetItem(ret, asPyScalar("Spots"), asNumpy(spots));
-    PyDict_SetItem(ret, asPyScalar("Values"), asNumpy(values));
+static
+PyObject*  pyOrfBSPDEForward(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pySpot(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+  PyObject* pyStrikes(NULL);
+  PyObject* pyMaturities(NULL);
+  PyObject* pyPdeParams(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOO", &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility,
+    &pyStrikes, &pyMaturities, &pyPdeParams))
+    return NULL;
+
+  double spot = asDouble(pySpot);
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVolatility);
+  std::vector<double> strikes = asDblVec(pyStrikes);
+  std::vector<double> maturities = asDblVec(pyMaturities);
+
+  // read the PDE parameters
+  orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
+
+  // solve forward for all strikes and maturities
+  orf::PdeForwardResults results;
+  orf::PdeForwardSolver solver(spyc, spot, divYield, vol, strikes, maturities, results);
+  solver.solve(pdeparams);
+
+  // the put prices by put-call parity
+  orf::Matrix putPrices(results.callPrices);
+  for (size_t j = 0; j < maturities.size(); ++j) {
+    double T = maturities[j];
+    double fwdSpot = spot * std::exp(-divYield * T);
+    double df = spyc->discount(T);
+    for (size_t k = 0; k < strikes.size(); ++k)
+      putPrices(k, j) += strikes[k] * df - fwdSpot;
   }
+
+  // write results
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("CallPrices"), asNumpy(results.callPrices));
+  ok = PyDict_SetItem(ret, asPyScalar("PutPrices"), asNumpy(putPrices));
   return ret;
 
-  PY_END;
-}
\ No newline at end of file
+PY_END;
+}
+
+static
+PyObject*  pyOrfBSPDERichardson(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyAmerican(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+  PyObject* pyPdeParams(NULL);
+  PyObject* pyNLevels(NULL);
+  PyObject* pyNThreads(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOO", &pyPayoffType, &pyStrike, &pyTimeToExp, &pyAmerican,
+    &pySpot, &pyDiscountCrv, &pyDivYield, &pyVolatility, &pyPdeParams, &pyNLevels, &pyNThreads))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  double strike = asDouble(pyStrike);
+  double timeToExp = asDouble(pyTimeToExp);
+  bool american = asBool(pyAmerican);
+  double spot = asDouble(pySpot);
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVolatility);
+
+  // read the PDE parameters of the coarsest grid
+  orf::PdeParams pdeparams = asPdeParams(pyPdeParams);
+  size_t nlevels = (size_t) asInt(pyNLevels);
+  size_t nthreads = (size_t) asInt(pyNThreads);
+
+  // a new product for each grid level
+  auto factory = [=]() {
+    if (american)
+      return orf::SPtrProduct(new orf::AmericanCallPut(payoffType, strike, timeToExp));
+    return orf::SPtrProduct(new orf::EuropeanCallPut(payoffType, strike, timeToExp));
+  };
+
+  // solve without holding the GIL
+  orf::Pde1DRichardsonResults results;
+  PyThreadState* pyState = PyEval_SaveThread();
+  try {
+    results = orf::solvePde1DRichardson(factory, spyc, spot, divYield, vol, pdeparams, nlevels, nthreads);
+  }
+  catch (...) {
+    PyEval_RestoreThread(pyState);
+    throw;
+  }
+  PyEval_RestoreThread(pyState);
+
+  // write results
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("Price"), asPyScalar(results.price));
+  PyDict_SetItem(ret, asPyScalar("ErrorEstimate"), asPyScalar(results.errorEstimate));
+  PyDict_SetItem(ret, asPyScalar("LevelPrices"), asNumpy(results.levelPrices));
+  return ret;
+
+PY_END;
+}
+
+static
+PyObject*  pyOrfSpreadBSPDE(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyAmerican(NULL);
+  PyObject* pySpots(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYields(NULL);
+  PyObject* pyVolatilities(NULL);
+  PyObject* pyCorrelation(NULL);
+  PyObject* pyPdeParams(NULL);
+  PyObject* pyNThreads(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOO", &pyPayoffType, &pyStrike, &pyTimeToExp, &pyAmerican,
+    &pySpots, &pyDiscountCrv, &pyDivYields, &pyVolatilities, &pyCorrelation, &pyPdeParams, &pyNThreads))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  double strike = asDouble(pyStrike);
+  double timeToExp = asDouble(pyTimeToExp);
+  bool american = asBool(pyAmerican);
+  std::vector<double> spots = asDblVec(pySpots);
+  std::vector<double> divYields = asDblVec(pyDivYields);
+  std::vector<double> vols = asDblVec(pyVolatilities);
+  ORF_ASSERT(spots.size() == 2 && divYields.size() == 2 && vols.size() == 2,
+    "error: need two spots, dividend yields and volatilities");
+  double correlation = asDouble(pyCorrelation);
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  // read the PDE parameters, for two dimensions
+  orf::PdeParams pdeparams = asPdeParams(pyPdeParams, 2);
+  size_t nthreads = (size_t) asInt(pyNThreads);
+
+  orf::SPtrProduct spprod(new orf::SpreadCallPut(payoffType, strike, timeToExp, american));
+  orf::Pde2DResults results;
+  orf::Pde2DSolver solver(spprod, spyc, spots, divYields, vols, correlation, results, nthreads);
+
+  // solve without holding the GIL
+  PyThreadState* pyState = PyEval_SaveThread();
+  try {
+    solver.solve(pdeparams);
+  }
+  catch (...) {
+    PyEval_RestoreThread(pyState);
+    throw;
+  }
+  PyEval_RestoreThread(pyState);
+
+  // write results
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("Price"), asPyScalar(results.prices[0]));
+  return ret;
+
+PY_END;
+}
+
+static
+PyObject*  pyOrfBasketBSPDE(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyAmerican(NULL);
+  PyObject* pySpots(NULL);
+  PyObject* pyDiscountCrv(NULL);
+  PyObject* pyDivYields(NULL);
+  PyObject* pyVolatilities(NULL);
+  PyObject* pyCorrelations(NULL);
+  PyObject* pyQuantities(NULL);
+  PyObject* pyPdeParams(NULL);
+  PyObject* pySparseLevel(NULL);
+  PyObject* pyNThreads(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOOOO", &pyPayoffType, &pyStrike, &pyTimeToExp, &pyAmerican,
+    &pySpots, &pyDiscountCrv, &pyDivYields, &pyVolatilities, &pyCorrelations, &pyQuantities,
+    &pyPdeParams, &pySparseLevel, &pyNThreads))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  double strike = asDouble(pyStrike);
+  double timeToExp = asDouble(pyTimeToExp);
+  bool american = asBool(pyAmerican);
+  std::vector<double> spots = asDblVec(pySpots);
+  std::vector<double> divYields = asDblVec(pyDivYields);
+  std::vector<double> vols = asDblVec(pyVolatilities);
+  orf::Matrix correlations = asMatrix(pyCorrelations);
+  orf::Vector quantities = asVector(pyQuantities);
+  size_t nassets = spots.size();
+  ORF_ASSERT(divYields.size() == nassets && vols.size() == nassets && quantities.size() == nassets,
+    "error: need one dividend yield, volatility and quantity per spot");
+
+  std::string name = asString(pyDiscountCrv);
+  orf::SPtrYieldCurve spyc = orf::market().yieldCurves().get(name);
+  ORF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  // read the PDE parameters, one dimension per asset
+  orf::PdeParams pdeparams = asPdeParams(pyPdeParams, nassets);
+  bool sparse = pySparseLevel != Py_None;
+  size_t level = sparse ? (size_t) asInt(pySparseLevel) : 0;
+  size_t nthreads = (size_t) asInt(pyNThreads);
+
+  auto factory = [&]() {
+    return orf::SPtrProduct(new orf::BasketCallPut(payoffType, strike, timeToExp, quantities, american));
+  };
+  orf::PdeNDResults results;
+  orf::PdeSparseGridResults sgresults;
+
+  // solve without holding the GIL
+  PyThreadState* pyState = PyEval_SaveThread();
+  try {
+    if (sparse)
+      sgresults = orf::solvePdeSparseGrid(factory, spyc, spots, divYields, vols, correlations,
+                                          pdeparams, level, nthreads);
+    else {
+      orf::PdeNDSolver solver(factory(), spyc, spots, divYields, vols, correlations, results, nthreads);
+      solver.solve(pdeparams);
+    }
+  }
+  catch (...) {
+    PyEval_RestoreThread(pyState);
+    throw;
+  }
+  PyEval_RestoreThread(pyState);
+
+  // write results
+  PyObject* ret = PyDict_New();
+  if (!sparse) {
+    int ok = PyDict_SetItem(ret, asPyScalar("Price"), asPyScalar(results.prices[0]));
+    return ret;
+  }
+  int ok = PyDict_SetItem(ret, asPyScalar("Price"), asPyScalar(sgresults.price));
+  PyDict_SetItem(ret, asPyScalar("GridLevels"), asNumpy(sgresults.gridLevels));
+  PyDict_SetItem(ret, asPyScalar("GridPrices"), asNumpy(sgresults.gridPrices));
+  PyDict_SetItem(ret, asPyScalar("Coefficients"), asNumpy(sgresults.coefficients));
+  PyDict_SetItem(ret, asPyScalar("Nodes"), asPyScalar((int) sgresults.nNodes));
+  PyDict_SetItem(ret, asPyScalar("FullGridNodes"), asPyScalar((int) sgresults.nFullGridNodes));
+  return ret;
+
+PY_END;
+}
@@ -64,14 +64,26 @@ static PyMethodDef PyOrflibMethods[] =
   { "volCreate", pyOrfVolCreate, METH_VARARGS, "creates a volatility curve." },
   { "spotVol", pyOrfSpotVol, METH_VARARGS, "spot volatility to maturity." },
   { "fwdVol", pyOrfFwdVol, METH_VARARGS, "fwd volatility between the two maturities." },
+  { "lvCreate", pyOrfLVCreate, METH_VARARGS, "creates a local volatility surface." },
+  { "localVol", pyOrfLocalVol, METH_VARARGS, "local volatility at a time and spot." },
   { "capFloorletBS", pyOrfCapFloorletBS, METH_VARARGS, "present value of a caplet/floorlet on fwd rate." },
   { "cdsPV", pyOrfCDSPV, METH_VARARGS, "present value of a CDS." },
 // functions 3
   { "euroBSMC", pyOrfEuroBSMC, METH_VARARGS, "price of a European option in the Black-Scholes model using Monte Carlo." },
+  { "digiBSMC", pyOrfDigiBSMC, METH_VARARGS, "price of a European digital option in the Black-Scholes model using Monte Carlo." },
   { "asianBasketBSMC", pyOrfAsianBasketBSMC, METH_VARARGS, "price of a Asian basket option in the Black-Scholes model using Monte Carlo." },
+  { "barrierBSMC", pyOrfBarrierBSMC, METH_VARARGS, "price of a barrier option in the Black-Scholes model using Monte Carlo." },
   // functions 4
   { "euroBSPDE", pyOrfEuroBSPDE, METH_VARARGS, "price of a European option in the Black-Scholes model using PDE." },
   { "amerBSPDE", pyOrfAmerBSPDE, METH_VARARGS, "price of an American option in the Black-Scholes model using PDE." },
+  { "bsPDEBatch", pyOrfBSPDEBatch, METH_VARARGS, "prices of a batch of European and American options in the Black-Scholes model using PDE, in parallel." },
+  { "spreadBSPDE", pyOrfSpreadBSPDE, METH_VARARGS, "price of a European or American spread option in the Black-Scholes model using 2-d PDE." },
+  { "basketBSPDE", pyOrfBasketBSPDE, METH_VARARGS, "price of a European or American basket option in the Black-Scholes model using N-d PDE, on a full grid or by sparse grid combination." },
+  { "bsPDERichardson", pyOrfBSPDERichardson, METH_VARARGS, "price of a European or American option in the Black-Scholes model using PDE, with Richardson extrapolation." },
+  { "bsPDELadder", pyOrfBSPDELadder, METH_VARARGS, "prices of a ladder of European or American options on the same underlying and expiration in the Black-Scholes model, using one PDE solve." },
+  { "bsPDEForward", pyOrfBSPDEForward, METH_VARARGS, "prices of European calls and puts for a grid of strikes and maturities in the Black-Scholes model, using one forward PDE solve." },
+  { "lvPDE", pyOrfLVPDE, METH_VARARGS, "price of a European or American option in the local volatility model using PDE." },
+  { "bsPDESpots", pyOrfBSPDESpots, METH_VARARGS, "prices of a European or American option at several spots in the Black-Scholes model, using one PDE solve." },
   // functions 5
   { "ptRisk", pyOrfPtRisk, METH_VARARGS, "mean return and standard deviation of a portfolio" },
   { "mvpWghts", pyOrfMvpWghts, METH_VARARGS, "weights of the minimum variance portfolio" },
@@ -80,6 +92,7 @@ static PyMethodDef PyOrflibMethods[] =
   { "meanVarWghts", pyOrfMeanVarWghts, METH_VARARGS, "weights of the efficient portfolio for a given risk aversion lambda" },
   { "meanVarFront", pyOrfMeanVarFront, METH_VARARGS, "computes the mean-variance efficient frontier" },
   { "cbBSPDE", pyOrfCbBSPDE, METH_VARARGS, "price of a Convertible Bond using PDE." },
+  { "cbBSPDEParareal", pyOrfCbBSPDEParareal, METH_VARARGS, "price of a Convertible Bond using the parallel in time (Parareal) PDE solver." },
   {NULL, NULL, 0, NULL}
 };
 
@@ -9,6 +9,7 @@
 #include <orflib/math/matrix.hpp>
 #include <orflib/methods/montecarlo/mcparams.hpp>
 #include <orflib/methods/pde/pdeparams.hpp>
+#include <orflib/market/market.hpp>
 #include "pycpp.hpp"   // NOTE: include the python headers last (before armadillo)
 
 /** utility function for trimming strings */
@@ -63,6 +64,49 @@ static PyObject* asNumpy(orf::Matrix const & mat)
   return asPyArray(dvecvec);
 }
 
+/** Converts a Python volatility argument to a volatility term structure.
+    A number is a constant volatility; a string is the name of a market volatility term structure.
+*/
+static orf::SPtrVolatilityTermStructure asVolTermStructure(PyObject* pyVol)
+{
+  if (isString(pyVol)) {
+    std::string name = asString(pyVol);
+    orf::SPtrVolatilityTermStructure spvol = orf::market().volatilities().get(name);
+    ORF_ASSERT(spvol, "error: volatility " + name + " not found");
+    return spvol;
+  }
+  return std::make_shared<orf::VolatilityTermStructure>(asDouble(pyVol));
+}
+
+/** Converts a Python list of volatility arguments to volatility term structures.
+    The list must contain either numbers (constant volatilities) or strings (market volatility names).
+*/
+static std::vector<orf::SPtrVolatilityTermStructure> asVolTermStructures(PyObject* pyVols)
+{
+  bool byName = false;
+  if (PySequence_Check(pyVols) && PySequence_Size(pyVols) > 0) {
+    PyObject* pyFirst = PySequence_GetItem(pyVols, 0);
+    byName = isString(pyFirst);
+    Py_XDECREF(pyFirst);
+  }
+  std::vector<orf::SPtrVolatilityTermStructure> vts;
+  if (byName) {
+    std::vector<std::string> names = asStrVec(pyVols);
+    for (std::string const& s : names) {
+      std::string name = trim(std::string(s.c_str()));  // drop the numpy padding
+      orf::SPtrVolatilityTermStructure spvol = orf::market().volatilities().get(name);
+      ORF_ASSERT(spvol, "error: volatility " + name + " not found");
+      vts.push_back(spvol);
+    }
+  }
+  else {
+    orf::Vector vols = asVector(pyVols);
+    for (size_t i = 0; i < vols.size(); ++i)
+      vts.push_back(std::make_shared<orf::VolatilityTermStructure>(vols[i]));
+  }
+  return vts;
+}
+
 /** Converts a Python dictionary with name-value pairs to an McParams structure.
 */
 static orf::McParams asMcParams(PyObject* dict)
@@ -102,16 +146,57 @@ static orf::McParams asMcParams(PyObject* dict)
   else
     ORF_ASSERT(0, "asMcParams: invalid value for McParam " + paramname + "!");
 
+  // optional parameters
+  paramname = "IMPSAMPLING";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1)
+    mcparams.impSampling = asBool(PyDict_GetItemString(dict, paramname.c_str()));
+
+  paramname = "NPILOTPATHS";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1)
+    mcparams.nPilotPaths = (unsigned long) asInt(PyDict_GetItemString(dict, paramname.c_str()));
+
+  paramname = "SAMPLINGTYPE";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1) {
+    paramvalue = asString(PyDict_GetItemString(dict, paramname.c_str()));
+    paramvalue = trim(paramvalue);
+    std::transform(paramvalue.begin(), paramvalue.end(), paramvalue.begin(), ::toupper);
+    if (paramvalue == "PLAIN")
+      mcparams.samplingType = orf::McParams::SamplingType::PLAIN;
+    else if (paramvalue == "STRATIFIED")
+      mcparams.samplingType = orf::McParams::SamplingType::STRATIFIED;
+    else if (paramvalue == "LATINHYPERCUBE")
+      mcparams.samplingType = orf::McParams::SamplingType::LATINHYPERCUBE;
+    else
+      ORF_ASSERT(0, "asMcParams: invalid value for McParam " + paramname + "!");
+  }
+
+  paramname = "NSTRATA";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1)
+    mcparams.nStrata = (unsigned long) asInt(PyDict_GetItemString(dict, paramname.c_str()));
+
   return mcparams;
 }
 
+/** Converts a Python number, or a sequence with one number per dimension, to a vector of size nDims.
+*/
+static std::vector<double> asPerDimension(PyObject* pobj, size_t nDims, std::string const& paramname)
+{
+  if (!PySequence_Check(pobj))
+    return std::vector<double>(nDims, asDouble(pobj));
+  std::vector<double> vals = asDblVec(pobj);
+  ORF_ASSERT(vals.size() == nDims, "asPdeParams: " + paramname + " must have one value per dimension");
+  return vals;
+}
+
 /** Converts a Python dictionary with name-value pairs to an PdeParams structure.
+    For more than one dimension, NSPOTNODES, NSTDDEVS and CONCENTRATIONWIDTH take either one value
+    for all dimensions or a list with one value per dimension, and CONCENTRATIONSPOTS a list of lists.
 */
-static orf::PdeParams asPdeParams(PyObject* dict)
+static orf::PdeParams asPdeParams(PyObject* dict, size_t nDims = 1)
 {
   ORF_ASSERT(PyDict_Check(dict) == 1, "asPdeParams: input param must be a dictionary");
 
-  orf::PdeParams pdeparams;
+  orf::PdeParams pdeparams(nDims);
   std::string paramvalue;
 
   std::string paramname = "NTIMESTEPS";
@@ -122,18 +207,92 @@ static orf::PdeParams asPdeParams(PyObject* dict)
   paramname = "NSPOTNODES";
   ORF_ASSERT(PyDict_Contains(dict, asPyScalar(paramname)) == 1,
     "asPdeParams: input dictionary does not contain key NSPOTNODES");
-  pdeparams.nSpotNodes[0] = (size_t) asInt(PyDict_GetItemString(dict, paramname.c_str()));
+  std::vector<double> nspots = asPerDimension(PyDict_GetItemString(dict, paramname.c_str()), nDims, paramname);
+  for (size_t i = 0; i < nDims; ++i)
+    pdeparams.nSpotNodes[i] = (size_t) nspots[i];
 
   paramname = "NSTDDEVS";
   ORF_ASSERT(PyDict_Contains(dict, asPyScalar(paramname)) == 1,
     "asPdeParams: input dictionary does not contain key NSTDDEVS");
-  pdeparams.nStdDevs[0] = asDouble(PyDict_GetItemString(dict, paramname.c_str()));
+  pdeparams.nStdDevs = asPerDimension(PyDict_GetItemString(dict, paramname.c_str()), nDims, paramname);
 
   paramname = "THETA";
   ORF_ASSERT(PyDict_Contains(dict, asPyScalar(paramname)) == 1,
     "asPdeParams: input dictionary does not contain key THETA");
   pdeparams.theta = asDouble(PyDict_GetItemString(dict, paramname.c_str()));
 
+  // optional parameters
+  paramname = "CONCENTRATIONSPOTS";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1) {
+    PyObject* pyspots = PyDict_GetItemString(dict, paramname.c_str());
+    if (nDims == 1)
+      pdeparams.concentrationSpots[0] = asDblVec(pyspots);
+    else {
+      ORF_ASSERT(PySequence_Check(pyspots) && PySequence_Size(pyspots) == (Py_ssize_t) nDims,
+        "asPdeParams: " + paramname + " must have one list of spots per dimension");
+      for (size_t i = 0; i < nDims; ++i) {
+        PyObject* pyitem = PySequence_GetItem(pyspots, i);
+        pdeparams.concentrationSpots[i] = asDblVec(pyitem);
+        Py_XDECREF(pyitem);
+      }
+    }
+  }
+
+  paramname = "CONCENTRATIONWIDTH";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1)
+    pdeparams.concentrationWidths = asPerDimension(PyDict_GetItemString(dict, paramname.c_str()), nDims, paramname);
+
+  paramname = "RANNACHERSTEPS";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1)
+    pdeparams.nRannacherSteps = (size_t) asInt(PyDict_GetItemString(dict, paramname.c_str()));
+
+  paramname = "ADISCHEME";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1) {
+    paramvalue = asString(PyDict_GetItemString(dict, paramname.c_str()));
+    paramvalue = trim(paramvalue);
+    std::transform(paramvalue.begin(), paramvalue.end(), paramvalue.begin(), ::toupper);
+    if (paramvalue == "DOUGLAS")
+      pdeparams.adiScheme = orf::PdeParams::AdiScheme::DOUGLAS;
+    else if (paramvalue == "CRAIGSNEYD")
+      pdeparams.adiScheme = orf::PdeParams::AdiScheme::CRAIG_SNEYD;
+    else
+      ORF_ASSERT(0, "asPdeParams: invalid value for PdeParam " + paramname + "!");
+  }
+
+  paramname = "EXERCISEMETHOD";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1) {
+    paramvalue = asString(PyDict_GetItemString(dict, paramname.c_str()));
+    paramvalue = trim(paramvalue);
+    std::transform(paramvalue.begin(), paramvalue.end(), paramvalue.begin(), ::toupper);
+    if (paramvalue == "EXPLICIT")
+      pdeparams.exerciseMethod = orf::PdeParams::ExerciseMethod::EXPLICIT;
+    else if (paramvalue == "BRENNANSCHWARTZ")
+      pdeparams.exerciseMethod = orf::PdeParams::ExerciseMethod::BRENNAN_SCHWARTZ;
+    else if (paramvalue == "PENALTY")
+      pdeparams.exerciseMethod = orf::PdeParams::ExerciseMethod::PENALTY;
+    else
+      ORF_ASSERT(0, "asPdeParams: invalid value for PdeParam " + paramname + "!");
+  }
+
+  paramname = "ADAPTIVETIMESTEPS";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1)
+    pdeparams.adaptiveTimeSteps = asBool(PyDict_GetItemString(dict, paramname.c_str()));
+
+  paramname = "BOUNDARYCONDITION";
+  if (PyDict_Contains(dict, asPyScalar(paramname)) == 1) {
+    paramvalue = asString(PyDict_GetItemString(dict, paramname.c_str()));
+    paramvalue = trim(paramvalue);
+    std::transform(paramvalue.begin(), paramvalue.end(), paramvalue.begin(), ::toupper);
+    if (paramvalue == "LINEAR")
+      pdeparams.boundaryCondition = orf::PdeParams::BoundaryCondition::LINEAR;
+    else if (paramvalue == "DIRICHLET")
+      pdeparams.boundaryCondition = orf::PdeParams::BoundaryCondition::DIRICHLET;
+    else if (paramvalue == "NEUMANN")
+      pdeparams.boundaryCondition = orf::PdeParams::BoundaryCondition::NEUMANN;
+    else
+      ORF_ASSERT(0, "asPdeParams: invalid value for PdeParam " + paramname + "!");
+  }
+
   return pdeparams;
 }
 